@@ -3,13 +3,16 @@ TEMPLATE = subdirs
 SUBDIRS += \
     fontadb \
     fonta \
-    tools
+    tools \
+    tests
 
 fontadb.subdir = src/fontadb
 fonta.subdir = src/fonta
 tools.subdir = src/tools
+tests.subdir = src/tests
 
 fonta.depends = fontadb
 tools.depends = fontadb
+tests.depends = fontadb
 
 #CONFIG += ordered
@@ -27,5 +27,11 @@ QMAKE_CXXFLAGS *= -O2
 
 DEFINES *= \
     QT_USE_QSTRINGBUILDER \
-    #FONTA_DETAILED_DEBUG \
-    #FONTA_MEASURES
+    #FONTA_DETAILED_DEBUG
+
+# catalogue seed from fontconfig cache, see fontconfigsource.h
+unix:!macx:packagesExist(fontconfig) {
+    CONFIG *= link_pkgconfig
+    PKGCONFIG *= fontconfig
+    DEFINES *= FONTA_FONTCONFIG
+}
@@ -2,9 +2,13 @@
 
 #include "fontadb.h"
 #include "mainwindow.h"
+#include "trace.h"
 
 #include <QApplication>
 #include <QCheckBox>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QHBoxLayout>
 #include <QPushButton>
 #include <QRadioButton>
 #include <QGroupBox>
@@ -15,6 +19,7 @@
 #include <QRect>
 #include <QUrl>
 #include <QDesktopServices>
+#include <limits>
 
 namespace fonta {
 
@@ -53,9 +58,17 @@ void FilterWizard::accept()
 
     declBool(monospaced);
     declBool(cyrillic);
+    declBool(axis);
 
 #undef declBool
 
+    // "wght at least 700": some face or axis value in [700, max]
+    const QString axisTag = field(QStringLiteral("axisTag")).toString();
+    const bool axisAtLeast = field(QStringLiteral("axisBound")).toInt() == 0;
+    const double axisValue = field(QStringLiteral("axisValue")).toDouble();
+    const double axisMin = axisAtLeast ? axisValue : -std::numeric_limits<double>::max();
+    const double axisMax = axisAtLeast ? std::numeric_limits<double>::max() : axisValue;
+
     MainWindow *window = dynamic_cast<MainWindow*>(parent());
     QStringList l;
 
@@ -65,7 +78,7 @@ void FilterWizard::accept()
     bool no_specific_sans = (!grotesque && !geometric && !humanist)
                          || ( grotesque &&  geometric &&  humanist);
 
-    bool no_extra_specific = !cyrillic && !monospaced;
+    bool no_extra_specific = !cyrillic && !monospaced && !axis;
 
     bool all_types = (!serif && !sans && !script && !display && !symbolic)
                   || ( serif &&  sans &&  script &&  display &&  symbolic);
@@ -75,8 +88,8 @@ void FilterWizard::accept()
     bool only_script     = !serif && !sans &&  script && !display && !symbolic;
     bool only_display    = !serif && !sans && !script &&  display && !symbolic;
     bool only_symbolic   = !serif && !sans && !script && !display &&  symbolic;
-    bool only_cyrillic   =  cyrillic && !monospaced && all_types && no_specific_serif && no_specific_sans;
-    bool only_monospaced = !cyrillic &&  monospaced && all_types && no_specific_serif && no_specific_sans;
+    bool only_cyrillic   =  cyrillic && !monospaced && !axis && all_types && no_specific_serif && no_specific_sans;
+    bool only_monospaced = !cyrillic &&  monospaced && !axis && all_types && no_specific_serif && no_specific_sans;
 
     bool not_custom = (no_specific_serif && no_specific_sans && no_extra_specific
                        && (all_types || only_serif || only_sans || only_script || only_display || only_symbolic)
@@ -113,11 +126,18 @@ void FilterWizard::accept()
     if(no_specific_serif) { oldstyle = transitional = modern = slab = true; }
     if(no_specific_sans)  { grotesque = geometric = humanist = true; }
 
+    FONTA_TRACE_SPAN("filter", "FilterWizard::accept");
+
     DB& db = fontaDB();
 
     for (CStringRef f : db.families()) {
         if(monospaced && !db.isMonospaced(f)) { continue; }
         if(cyrillic && !db.isCyrillic(f)) { continue; }
+        if(axis) {
+            // static faces have weight too
+            const bool weight = axisTag == QLatin1String("wght") && db.hasWeight(f, static_cast<int>(qMax(1.0, axisMin)), static_cast<int>(qMin(1000.0, axisMax)));
+            if(!weight && !db.hasAxis(f, axisTag, axisMin, axisMax)) { continue; }
+        }
 
         if(serif) {
             bool ok = false;
@@ -305,14 +325,36 @@ FinishPage::FinishPage(QWidget *parent)
     cyrillicBox = new QCheckBox(tr("Cyrillic support"));
     monospacedBox = new QCheckBox(tr("Monospaced"));
 
+    axisBox = new QCheckBox(tr("Variable axis"));
+    axisTagBox = new QComboBox;
+    axisTagBox->setEditable(true);
+    axisTagBox->addItems({QStringLiteral("wght"), QStringLiteral("wdth"), QStringLiteral("slnt"), QStringLiteral("opsz"), QStringLiteral("ital")});
+    axisBoundBox = new QComboBox;
+    axisBoundBox->addItems({tr("at least"), tr("at most")});
+    axisValueBox = new QDoubleSpinBox;
+    axisValueBox->setRange(-1000, 1000);
+    axisValueBox->setValue(700);
+
     registerField(QStringLiteral("cyrillic"), cyrillicBox);
     registerField(QStringLiteral("monospaced"), monospacedBox);
+    registerField(QStringLiteral("axis"), axisBox);
+    registerField(QStringLiteral("axisTag"), axisTagBox, "currentText");
+    registerField(QStringLiteral("axisBound"), axisBoundBox);
+    registerField(QStringLiteral("axisValue"), axisValueBox, "value");
+
+    QHBoxLayout *axisLayout = new QHBoxLayout;
+    axisLayout->addWidget(axisBox);
+    axisLayout->addWidget(axisTagBox);
+    axisLayout->addWidget(axisBoundBox);
+    axisLayout->addWidget(axisValueBox);
+    axisLayout->addStretch(1);
 
     QVBoxLayout *layout = new QVBoxLayout;
     layout->addWidget(topLabel);
     layout->addStretch(1);
     layout->addWidget(cyrillicBox);
     layout->addWidget(monospacedBox);
+    layout->addLayout(axisLayout);
     layout->addStretch(3);
     setLayout(layout);
 }
@@ -5,6 +5,8 @@
 #include "types.h"
 
 class QCheckBox;
+class QComboBox;
+class QDoubleSpinBox;
 class QPushButton;
 class QLabel;
 class QGridLayout;
@@ -79,6 +81,10 @@ public:
 private:
     QCheckBox* cyrillicBox;
     QCheckBox* monospacedBox;
+    QCheckBox* axisBox;
+    QComboBox* axisTagBox;
+    QComboBox* axisBoundBox;
+    QDoubleSpinBox* axisValueBox;
 };
 
 } // namespace fonta
@@ -21,7 +21,10 @@ SOURCES += \
     widgets/combobox.cpp \
     loremgenerator.cpp \
     launcher.cpp \
-    utils.cpp
+    utils.cpp \
+    fontafile.cpp \
+    journal.cpp \
+    textprovider.cpp
 
 HEADERS += \
     sampler.h \
@@ -38,7 +41,10 @@ HEADERS += \
     loremgenerator.h \
     launcher.h \
     types_fonta.h \
-    utils.h
+    utils.h \
+    fontafile.h \
+    journal.h \
+    textprovider.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,204 @@
+#include "fontafile.h"
+
+#include <QSaveFile>
+#include <QDebug>
+
+namespace fonta {
+
+QDataStream &operator<<(QDataStream &out, const TabData &tab)
+{
+    out << static_cast<i32>(tab.currField);
+    out << tab.sizes;
+    out << tab.fields;
+
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, TabData &tab)
+{
+    i32 currField = 0;
+
+    in >> currField;
+    in >> tab.sizes;
+    in >> tab.fields;
+
+    tab.currField = static_cast<int>(currField);
+
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const FieldData &field)
+{
+    out << field.family;
+    out << field.style;
+    out << field.size;
+    out << field.leading;
+    out << field.tracking;
+    out << field.alignment;
+    out << field.text;
+    out << field.textColor;
+    out << field.backgroundColor;
+
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, FieldData &field)
+{
+    in >> field.family >> field.style >> field.size >> field.leading >> field.tracking
+       >> field.alignment >> field.text >> field.textColor >> field.backgroundColor;
+
+    return in;
+}
+
+bool FontaFile::isBinary(QIODevice &device)
+{
+    const QByteArray head = device.peek(sizeof(u32));
+    if(head.size() != sizeof(u32)) {
+        return false;
+    }
+
+    QDataStream in(head);
+    u32 magic = 0;
+    in >> magic;
+
+    return magic == Magic;
+}
+
+bool FontaFile::write(CStringRef fileName, const QVector<TabData> &tabs, int currTab)
+{
+    // payloads are packed first to know their sizes for the index
+    QVector<QByteArray> payloads;
+    payloads.reserve(tabs.size());
+    for(const TabData &tab : tabs) {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out.setVersion(StreamVersion);
+        out << tab;
+        payloads << bytes;
+    }
+
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Couldn't open" << fileName;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(StreamVersion);
+
+    out << static_cast<u32>(Magic);
+    out << static_cast<u16>(FormatVersion);
+    out << static_cast<i32>(currTab);
+    out << static_cast<u32>(tabs.size());
+
+    u64 offset = 0;
+    for(int i = 0; i<tabs.size(); ++i) {
+        out << tabs[i].name;
+        out << offset;
+        out << static_cast<u32>(payloads[i].size());
+        offset += payloads[i].size();
+    }
+
+    for(const QByteArray &bytes : std::as_const(payloads)) {
+        out.writeRawData(bytes.constData(), bytes.size());
+    }
+
+    if(out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool FontaFileReader::open(CStringRef fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if(!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&m_file);
+    in.setVersion(FontaFile::StreamVersion);
+
+    u32 magic = 0;
+    u16 version = 0;
+    i32 currTab = 0;
+    u32 count = 0;
+
+    in >> magic >> version >> currTab >> count;
+
+    if(magic != FontaFile::Magic || version > FontaFile::FormatVersion || in.status() != QDataStream::Ok) {
+        close();
+        return false;
+    }
+
+    // every entry takes at least a name length, offset and size, so damaged count can't outgrow the file
+    const qint64 minEntrySize = sizeof(u32) + sizeof(u64) + sizeof(u32);
+    if(count > static_cast<u64>((m_file.size() - m_file.pos()) / minEntrySize)) {
+        close();
+        return false;
+    }
+
+    m_index.reserve(static_cast<int>(count));
+    for(u32 i = 0; i<count; ++i) {
+        IndexEntry entry;
+        in >> entry.name >> entry.offset >> entry.size;
+        if(in.status() != QDataStream::Ok) {
+            close();
+            return false;
+        }
+        m_index << entry;
+    }
+
+    m_currTab = qBound(0, static_cast<int>(currTab), qMax(0, m_index.size()-1));
+    m_payloadStart = m_file.pos();
+
+    // payloads must lie within the file, nothing is read for a tab pointing past its end
+    const u64 payloadSize = static_cast<u64>(m_file.size() - m_payloadStart);
+    for(const IndexEntry &entry : std::as_const(m_index)) {
+        if(entry.offset > payloadSize || entry.size > payloadSize - entry.offset) {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void FontaFileReader::close()
+{
+    m_file.close();
+    m_index.clear();
+    m_currTab = 0;
+    m_payloadStart = 0;
+}
+
+bool FontaFileReader::readTab(int i, TabData &tab)
+{
+    if(!isOpen() || i < 0 || i >= m_index.size()) {
+        return false;
+    }
+
+    const IndexEntry &entry = m_index.at(i);
+    if(entry.offset + entry.size > static_cast<u64>(m_file.size() - m_payloadStart)
+    || !m_file.seek(m_payloadStart + entry.offset)) {
+        return false;
+    }
+
+    const QByteArray bytes = m_file.read(entry.size);
+    if(bytes.size() != static_cast<int>(entry.size)) {
+        return false;
+    }
+
+    QDataStream in(bytes);
+    in.setVersion(FontaFile::StreamVersion);
+    in >> tab;
+    tab.name = entry.name;
+
+    return in.status() == QDataStream::Ok;
+}
+
+} // namespace fonta
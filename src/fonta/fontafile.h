@@ -0,0 +1,93 @@
+#ifndef FONTAFILE_H
+#define FONTAFILE_H
+
+#include "types.h"
+#include <QDataStream>
+#include <QFile>
+#include <QList>
+#include <QVector>
+
+namespace fonta {
+
+//! Widget independent state of one workspace tab.
+//! Every field is kept as an opaque blob produced by Field::save(QDataStream &).
+struct TabData {
+    QString name;
+    int currField {0};
+    QList<int> sizes;
+    QVector<QByteArray> fields;
+};
+
+QDataStream &operator<<(QDataStream &out, const TabData &tab);
+QDataStream &operator>>(QDataStream &in,        TabData &tab);
+
+//! Values of one field as they are encoded into TabData::fields blob.
+//! Copying it is cheap, so it is taken on UI thread and encoded elsewhere.
+struct FieldData {
+    QString family;
+    QString style;
+    double size {12.0};
+    float leading {0};
+    i32 tracking {0};
+    i32 alignment {1};
+    QString text;
+    QString textColor;
+    QString backgroundColor;
+};
+
+QDataStream &operator<<(QDataStream &out, const FieldData &field);
+QDataStream &operator>>(QDataStream &in,        FieldData &field);
+
+/*
+ * Binary .fonta layout:
+ *
+ *   u32 magic 'FNTA'
+ *   u16 format version
+ *   i32 current tab
+ *   u32 tabs count
+ *   index: for every tab { QString name, u64 offset, u32 size }
+ *   payloads: TabData records, offsets are relative to the end of index
+ *
+ * Index goes first so any tab can be decoded without touching the others.
+ */
+namespace FontaFile {
+    enum {
+        Magic = 0x464E5441,
+        FormatVersion = 1,
+        StreamVersion = QDataStream::Qt_5_6
+    };
+
+    bool isBinary(QIODevice &device);
+    bool write(CStringRef fileName, const QVector<TabData> &tabs, int currTab);
+}
+
+class FontaFileReader
+{
+public:
+    bool open(CStringRef fileName);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_file.fileName(); }
+
+    int tabsCount() const { return m_index.size(); }
+    int currTab() const { return m_currTab; }
+    CStringRef tabName(int i) const { return m_index.at(i).name; }
+
+    bool readTab(int i, TabData &tab);
+
+private:
+    struct IndexEntry {
+        QString name;
+        u64 offset;
+        u32 size;
+    };
+
+    QFile m_file;
+    QVector<IndexEntry> m_index;
+    int m_currTab {0};
+    qint64 m_payloadStart {0};
+};
+
+} // namespace fonta
+
+#endif // FONTAFILE_H
@@ -0,0 +1,503 @@
+#include "journal.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <chrono>
+
+namespace fonta {
+
+static const u32 SnapshotMagic = 0x464E544A; // 'FNTJ'
+static const int CompactThreshold = 512;     // records between snapshots
+static const int CommitWindowMs = 20;        // time to gather records for one commit
+
+static QString sessionDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/session");
+}
+
+static QString snapshotPath() { return sessionDir() + QStringLiteral("/snapshot.dat"); }
+static QString journalPath() { return sessionDir() + QStringLiteral("/journal.dat"); }
+
+Journal::Journal()
+{
+}
+
+Journal::~Journal()
+{
+    stop();
+}
+
+void Journal::push(Record &&r)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_started) {
+            QDir().mkpath(sessionDir());
+            m_stop = false;
+            m_thread = std::thread(&Journal::run, this);
+            m_started = true;
+        }
+        m_queue.push_back(std::move(r));
+        (void)lock;
+    }
+
+    m_cv.notify_one();
+}
+
+void Journal::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_started) {
+            return;
+        }
+        m_stop = true;
+        (void)lock;
+    }
+
+    m_cv.notify_one();
+    m_thread.join();
+    m_started = false;
+}
+
+void Journal::reset(const QVector<TabData> &tabs, int currTab, CStringRef source, const QVector<int> &sourceTabs)
+{
+    Record r;
+    r.type = Reset;
+    r.a = currTab;
+    r.tabs = tabs;
+    r.source = source;
+    r.sourceTabs = sourceTabs;
+    push(std::move(r));
+}
+
+void Journal::tabState(int tab, const TabData &data, const QVector<FieldData> &fields)
+{
+    Record r;
+    r.type = TabState;
+    r.a = tab;
+    r.tab = data;
+    r.fields = fields;
+    push(std::move(r));
+}
+
+void Journal::fieldState(int tab, int field, const FieldData &data)
+{
+    Record r;
+    r.type = FieldState;
+    r.a = tab;
+    r.b = field;
+    r.fields << data;
+    push(std::move(r));
+}
+
+void Journal::tabClosed(int tab)
+{
+    Record r;
+    r.type = TabClosed;
+    r.a = tab;
+    push(std::move(r));
+}
+
+void Journal::tabMoved(int from, int to)
+{
+    Record r;
+    r.type = TabMoved;
+    r.a = from;
+    r.b = to;
+    push(std::move(r));
+}
+
+void Journal::currentTab(int tab)
+{
+    Record r;
+    r.type = CurrentTab;
+    r.a = tab;
+    push(std::move(r));
+}
+
+void Journal::discard()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        (void)lock;
+    }
+
+    stop();
+
+    QFile::remove(journalPath());
+    QFile::remove(snapshotPath());
+}
+
+void Journal::run()
+{
+    Model model;
+    int sinceSnapshot = 0;
+
+    // reopened on every batch until it succeeds, meanwhile every batch goes to snapshot
+    QFile journal(journalPath());
+    bool warned = false;
+    cauto openJournal = [&journal, &warned]{
+        if(journal.isOpen() || journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            return true;
+        }
+        if(!warned) {
+            qWarning() << "Couldn't open journal" << journal.fileName() << journal.errorString();
+            warned = true;
+        }
+        return false;
+    };
+    openJournal();
+
+    for(;;) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]{ return m_stop || !m_queue.isEmpty(); });
+
+        if(!m_stop) {
+            // group commit: let more records come in before touching the disk
+            m_cv.wait_for(lock, std::chrono::milliseconds(CommitWindowMs), [this]{ return m_stop; });
+        }
+
+        if(m_queue.isEmpty() && m_stop) {
+            break;
+        }
+
+        QVector<Record> batch;
+        batch.swap(m_queue);
+        lock.unlock();
+
+        QByteArray buffer;
+        bool compact = false;
+
+        for(Record &r : batch) {
+            prepare(r);
+            apply(model, r);
+
+            if(r.type == Reset) {
+                // everything before reset is superseded by snapshot
+                buffer.clear();
+                compact = true;
+                continue;
+            }
+
+            ++sinceSnapshot;
+            buffer += frame(++model.seq, r);
+        }
+
+        const bool opened = openJournal();
+
+        if((compact || sinceSnapshot >= CompactThreshold || !opened) && writeSnapshot(model)) {
+            if(opened) {
+                journal.resize(0);
+            }
+            sinceSnapshot = 0;
+        } else if(!opened) {
+            qWarning() << "Session is not saved: neither journal nor snapshot could be written";
+        } else if(compact) {
+            // records before reset must never be replayed together with the ones after it,
+            // so the log starts over from full state which replaces whatever snapshot holds
+            Record full;
+            full.type = Reset;
+            full.a = model.currTab;
+            full.tabs = model.tabs;
+
+            journal.resize(0);
+            journal.write(frame(++model.seq, full));
+            journal.flush();
+            sinceSnapshot = 0;
+        } else if(!buffer.isEmpty()) {
+            journal.write(buffer);
+            journal.flush();
+        }
+    }
+
+    journal.close();
+}
+
+static QByteArray encodeField(const FieldData &field)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(FontaFile::StreamVersion);
+    out << field;
+
+    return bytes;
+}
+
+void Journal::prepare(Record &r)
+{
+    switch(r.type) {
+        case Reset: {
+            if(r.source.isEmpty()) {
+                break;
+            }
+
+            FontaFileReader reader;
+            const bool opened = reader.open(r.source);
+
+            for(int i = 0; i<r.sourceTabs.size() && i<r.tabs.size(); ++i) {
+                if(r.sourceTabs[i] < 0) {
+                    continue;
+                }
+
+                // tab could be renamed before it was loaded
+                const QString name = r.tabs[i].name;
+                if(!opened || !reader.readTab(r.sourceTabs[i], r.tabs[i])) {
+                    qWarning() << "Couldn't read tab" << r.sourceTabs[i] << "of" << r.source;
+                }
+                r.tabs[i].name = name;
+            }
+        } break;
+        case TabState: {
+            r.tab.fields.clear();
+            r.tab.fields.reserve(r.fields.size());
+            for(const FieldData &field : std::as_const(r.fields)) {
+                r.tab.fields << encodeField(field);
+            }
+        } break;
+        case FieldState: {
+            if(!r.fields.isEmpty()) {
+                r.bytes = encodeField(r.fields.first());
+            }
+        } break;
+        default: break;
+    }
+
+    r.fields.clear();
+    r.source.clear();
+    r.sourceTabs.clear();
+}
+
+QByteArray Journal::frame(u64 seq, const Record &r)
+{
+    QByteArray body;
+    QDataStream bodyStream(&body, QIODevice::WriteOnly);
+    bodyStream.setVersion(FontaFile::StreamVersion);
+    bodyStream << seq;
+    body += encode(r);
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(FontaFile::StreamVersion);
+    out << static_cast<u32>(body.size());
+    out.writeRawData(body.constData(), body.size());
+    out << qChecksum(body.constData(), body.size());
+
+    return bytes;
+}
+
+QByteArray Journal::encode(const Record &r)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(FontaFile::StreamVersion);
+
+    out << static_cast<u8>(r.type);
+
+    switch(r.type) {
+        case Reset: {
+            out << r.a << static_cast<u32>(r.tabs.size());
+            for(const TabData &tab : r.tabs) {
+                out << tab.name << tab;
+            }
+        } break;
+        case TabState:   out << r.a << r.tab.name << r.tab; break;
+        case FieldState: out << r.a << r.b << r.bytes;      break;
+        case TabMoved:   out << r.a << r.b;                 break;
+        case TabClosed:
+        case CurrentTab: out << r.a;                        break;
+        default: break;
+    }
+
+    return bytes;
+}
+
+bool Journal::decode(QDataStream &in, Record &r)
+{
+    u8 type = 0;
+    in >> type;
+    r.type = static_cast<RecordType>(type);
+
+    switch(r.type) {
+        case Reset: {
+            u32 count = 0;
+            in >> r.a >> count;
+            for(u32 i = 0; i<count && in.status() == QDataStream::Ok; ++i) {
+                TabData tab;
+                in >> tab.name >> tab;
+                r.tabs << tab;
+            }
+        } break;
+        case TabState:   in >> r.a >> r.tab.name >> r.tab; break;
+        case FieldState: in >> r.a >> r.b >> r.bytes;      break;
+        case TabMoved:   in >> r.a >> r.b;                 break;
+        case TabClosed:
+        case CurrentTab: in >> r.a;                        break;
+        default: return false;
+    }
+
+    return in.status() == QDataStream::Ok;
+}
+
+void Journal::apply(Model &model, const Record &r)
+{
+    QVector<TabData> &tabs = model.tabs;
+
+    switch(r.type) {
+        case Reset: {
+            tabs = r.tabs;
+            model.currTab = r.a;
+        } break;
+        case TabState: {
+            if(r.a == tabs.size()) {
+                tabs << r.tab;
+            } else if(r.a >= 0 && r.a < tabs.size()) {
+                tabs[r.a] = r.tab;
+            }
+        } break;
+        case FieldState: {
+            if(r.a < 0 || r.a >= tabs.size()) {
+                break;
+            }
+
+            QVector<QByteArray> &fields = tabs[r.a].fields;
+            if(r.b == fields.size()) {
+                fields << r.bytes;
+            } else if(r.b >= 0 && r.b < fields.size()) {
+                fields[r.b] = r.bytes;
+            }
+        } break;
+        case TabClosed: {
+            if(r.a >= 0 && r.a < tabs.size()) {
+                tabs.removeAt(r.a);
+            }
+        } break;
+        case TabMoved: {
+            if(r.a >= 0 && r.a < tabs.size() && r.b >= 0 && r.b < tabs.size()) {
+                tabs.move(r.a, r.b);
+            }
+        } break;
+        case CurrentTab: {
+            model.currTab = r.a;
+        } break;
+    }
+
+    model.currTab = qBound(0, model.currTab, qMax(0, tabs.size()-1));
+}
+
+bool Journal::writeSnapshot(const Model &model)
+{
+    QSaveFile file(snapshotPath());
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(FontaFile::StreamVersion);
+
+    out << SnapshotMagic;
+    out << model.seq;
+    out << static_cast<i32>(model.currTab);
+    out << static_cast<u32>(model.tabs.size());
+    for(const TabData &tab : model.tabs) {
+        out << tab.name << tab;
+    }
+
+    if(out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool Journal::recover(QVector<TabData> &tabs, int &currTab)
+{
+    Model model;
+
+    QFile snapshot(snapshotPath());
+    if(snapshot.open(QIODevice::ReadOnly)) {
+        QDataStream in(&snapshot);
+        in.setVersion(FontaFile::StreamVersion);
+
+        u32 magic = 0;
+        i32 curr = 0;
+        u32 count = 0;
+        in >> magic >> model.seq >> curr >> count;
+
+        if(magic == SnapshotMagic) {
+            for(u32 i = 0; i<count && in.status() == QDataStream::Ok; ++i) {
+                TabData tab;
+                in >> tab.name >> tab;
+                model.tabs << tab;
+            }
+            model.currTab = curr;
+        }
+
+        if(magic != SnapshotMagic || in.status() != QDataStream::Ok) {
+            model = Model();
+        }
+    }
+
+    QFile journal(journalPath());
+    if(journal.open(QIODevice::ReadOnly)) {
+        QDataStream in(&journal);
+        in.setVersion(FontaFile::StreamVersion);
+
+        // replay stops at first truncated or damaged record: it was the one being written at crash
+        while(!in.atEnd()) {
+            u32 size = 0;
+            in >> size;
+
+            if(in.status() != QDataStream::Ok || size > journal.size()) {
+                break;
+            }
+
+            QByteArray body(size, Qt::Uninitialized);
+            if(in.readRawData(body.data(), size) != static_cast<int>(size)) {
+                break;
+            }
+
+            u16 checksum = 0;
+            in >> checksum;
+            if(in.status() != QDataStream::Ok || checksum != qChecksum(body.constData(), body.size())) {
+                break;
+            }
+
+            QDataStream bodyStream(body);
+            bodyStream.setVersion(FontaFile::StreamVersion);
+
+            u64 seq = 0;
+            bodyStream >> seq;
+
+            Record r;
+            if(!decode(bodyStream, r)) {
+                break;
+            }
+
+            // records already folded into snapshot; full state is written only when snapshot
+            // couldn't be, so it supersedes snapshot whatever its number
+            if(seq <= model.seq && r.type != Reset) {
+                continue;
+            }
+
+            apply(model, r);
+            model.seq = seq;
+        }
+    }
+
+    if(model.tabs.isEmpty()) {
+        return false;
+    }
+
+    tabs = model.tabs;
+    currTab = model.currTab;
+
+    return true;
+}
+
+} // namespace fonta
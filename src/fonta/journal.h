@@ -0,0 +1,98 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "types.h"
+#include "fontafile.h"
+
+#include <QVector>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace fonta {
+
+/*
+ * Append-only log of workspace mutations.
+ *
+ * UI thread only enqueues records, everything else (encoding, disk writes,
+ * snapshots) is done by the writer thread. Records collected while the
+ * previous batch was being written are committed with a single write+flush.
+ * Writer keeps its own copy of workspace state by applying every record,
+ * so compaction into a snapshot never touches the UI thread.
+ *
+ * Journal files are removed on clean exit, so their presence at startup
+ * means that previous session has crashed and can be recovered.
+ */
+class Journal
+{
+public:
+    Journal();
+    ~Journal();
+
+    static bool recover(QVector<TabData> &tabs, int &currTab);
+
+    //! sourceTabs[i] >= 0 means that tabs[i] is not decoded yet and is read
+    //! by writer from that tab of source file (only its name is taken from tabs[i])
+    void reset(const QVector<TabData> &tabs, int currTab,
+               CStringRef source = QString(), const QVector<int> &sourceTabs = QVector<int>());
+    void tabState(int tab, const TabData &data, const QVector<FieldData> &fields);
+    void fieldState(int tab, int field, const FieldData &data);
+    void tabClosed(int tab);
+    void tabMoved(int from, int to);
+    void currentTab(int tab);
+
+    void discard();
+
+private:
+    enum RecordType : u8 {
+        Reset = 0,
+        TabState,
+        FieldState,
+        TabClosed,
+        TabMoved,
+        CurrentTab,
+    };
+
+    struct Record {
+        RecordType type;
+        i32 a {0};
+        i32 b {0};
+        TabData tab;
+        QByteArray bytes;
+        QVector<TabData> tabs;
+
+        // UI side data which writer turns into the fields above
+        QVector<FieldData> fields;
+        QString source;
+        QVector<int> sourceTabs;
+    };
+
+    struct Model {
+        QVector<TabData> tabs;
+        int currTab {0};
+        u64 seq {0};
+    };
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    QVector<Record> m_queue;
+    bool m_stop {false};
+    bool m_started {false};
+
+    void push(Record &&r);
+    void stop();
+    void run();
+
+    static void prepare(Record &r);
+    static void apply(Model &model, const Record &r);
+    //! length, sequence number, record and checksum as they go to journal file
+    static QByteArray frame(u64 seq, const Record &r);
+    static QByteArray encode(const Record &r);
+    static bool decode(QDataStream &in, Record &r);
+    static bool writeSnapshot(const Model &model);
+};
+
+} // namespace fonta
+
+#endif // JOURNAL_H
@@ -7,7 +7,8 @@
 #include <QLayout>
 #include <QLabel>
 #include <QDialog>
-#include <QTimer>
+#include <QTimerEvent>
+#include <QtMath>
 
 namespace fonta {
 
@@ -15,6 +16,14 @@ class LoadDialog : public QDialog
 {
 public:
     LoadDialog();
+
+protected:
+    void timerEvent(QTimerEvent *e) override;
+
+private:
+    QLabel *m_label;
+    QProgressBar *m_bar;
+    int m_timerId;
 };
 
 LoadDialog::LoadDialog()
@@ -23,19 +32,57 @@ LoadDialog::LoadDialog()
 
     QVBoxLayout *mainLayout = new QVBoxLayout;
 
-    QLabel *lbl = new QLabel(tr("Loading..."));
+    m_label = new QLabel(tr("Loading..."));
 
-    lbl->setMinimumHeight(60);
-    lbl->setMinimumWidth(120);
-    lbl->setWindowFlags(Qt::Widget);
-    lbl->setAlignment(Qt::AlignCenter);
+    m_label->setMinimumHeight(60);
+    m_label->setMinimumWidth(220);
+    m_label->setWindowFlags(Qt::Widget);
+    m_label->setAlignment(Qt::AlignCenter);
 
-    lbl->setStyleSheet(QStringLiteral("QLabel { background-color: rgb(250, 250, 250); }"));
+    m_label->setStyleSheet(QStringLiteral("QLabel { background-color: rgb(250, 250, 250); }"));
 
-    mainLayout->addWidget(lbl);
+    m_bar = new QProgressBar;
+    m_bar->setRange(0, 1000);
+    m_bar->setTextVisible(false);
+    m_bar->setMaximumHeight(6);
+    m_bar->hide();
+
+    mainLayout->addWidget(m_label);
+    mainLayout->addWidget(m_bar);
     mainLayout->setContentsMargins(0, 0, 0, 0);
+    mainLayout->setSpacing(0);
 
     setLayout(mainLayout);
+
+    // progress is sampled, readers never signal per file
+    m_timerId = startTimer(100);
+}
+
+void LoadDialog::timerEvent(QTimerEvent *e)
+{
+    if(e->timerId() != m_timerId) {
+        QDialog::timerEvent(e);
+        return;
+    }
+
+    const ScanProgress &progress = fontaDB().scanProgress();
+    if(!progress.isStarted()) {
+        return;
+    }
+
+    const double fraction = progress.fraction();
+    m_bar->show();
+    m_bar->setValue(qRound(fraction*1000));
+
+    QString text = tr("Loading fonts... %1%").arg(qFloor(fraction*100));
+
+    const qint64 eta = progress.etaMs();
+    if(eta >= 0) {
+        const int sec = static_cast<int>((eta + 999) / 1000);
+        text += '\n' + (sec < 60 ? tr("%1 s left").arg(sec) : tr("%1 min %2 s left").arg(sec/60).arg(sec%60));
+    }
+
+    m_label->setText(text);
 }
 
 Launcher::Launcher(CStringRef fileToOpen, QObject *parent)
@@ -45,12 +92,16 @@ Launcher::Launcher(CStringRef fileToOpen, QObject *parent)
 
 void Launcher::start()
 {
-    // At first call dialog with fonts load progress bar
-    LoadDialog d;
-    QObject::connect(&fontaDB(), &DB::loadFinished, &d, &QDialog::accept, Qt::QueuedConnection);
-    QTimer::singleShot(200, &fontaDB(), &DB::load);
-
-    d.exec();
+    // with catalogue snapshot window is shown at once, it is validated in background
+    DB &db = fontaDB();
+    db.load();
+
+    // first start: dialog with fonts load progress bar
+    if(!db.isLoaded()) {
+        LoadDialog d;
+        QObject::connect(&db, &DB::loadFinished, &d, &QDialog::accept);
+        d.exec();
+    }
 
     MainWindow *w = new MainWindow(m_fileToOpen);
     connect(qApp, &QApplication::aboutToQuit, [=](){ w->deleteLater(); });
@@ -6,6 +6,7 @@
 #include <ctime>
 
 #include "launcher.h"
+#include "trace.h"
 
 struct Args {
     QString file;
@@ -19,6 +20,8 @@ static Args getArgs(QApplication &app)
 {
     Args args;
     QCommandLineParser parser;
+    // handled by trace::setup()
+    parser.addOption(QCommandLineOption(QStringLiteral("trace"), QStringLiteral("Write Chrome trace to file on exit."), QStringLiteral("file")));
     parser.process(app);
 
     cauto list = parser.positionalArguments();
@@ -40,6 +43,7 @@ int main(int argc, char *argv[])
     a.setWindowIcon(QIcon(QStringLiteral(":/pic/logo.png")));
 
     cauto args = getArgs(a);
+    trace::setup(a.arguments());
 
     Launcher launcher(args.file);
     QTimer::singleShot(0, &launcher, &Launcher::start); // execute launcher after a.exec() when all signal/slots mechanism and gui thread become working
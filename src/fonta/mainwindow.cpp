@@ -9,6 +9,7 @@
 #include "utils.h"
 #include "sampler.h"
 #include "filterwizard.h"
+#include "trace.h"
 
 #include <QTextStream>
 #include <QJsonObject>
@@ -20,6 +21,7 @@
 #include <QMessageBox>
 #include <QTranslator>
 #include <QLibraryInfo>
+#include <QTimer>
 
 #include <QDebug>
 
@@ -87,8 +89,19 @@ MainWindow::MainWindow(CStringRef fileToOpen, QWidget *parent)
     QString lang = langVariant.isNull() ? QLocale::system().name().left(2) : langVariant.toString();
     setLanguage(lang);
 
+    m_journalTimer.setSingleShot(true);
+    m_journalTimer.setInterval(500);
+    connect(&m_journalTimer, &QTimer::timeout, this, &MainWindow::flushJournal);
+
+    // opening a file resets journal, so crashed session is offered before that
     if(fileToOpen.isEmpty()) {
-        addTab();
+        if(!recoverSession()) {
+            addTab();
+        }
+        resetJournal();
+    } else if(recoverSession(tr("Previous session was not closed properly. "
+                                "Restore it instead of opening %1?").arg(QFileInfo(fileToOpen).fileName()))) {
+        resetJournal();
     } else {
         openFile(fileToOpen);
     }
@@ -96,10 +109,16 @@ MainWindow::MainWindow(CStringRef fileToOpen, QWidget *parent)
     updateFilterBox(ui->filterBox);
     connect(ui->filterBox, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &MainWindow::currentFilterBoxIndexChanged);
     currentFilterBoxIndexChanged(0);
+
+    // catalogue snapshot could be outdated, background rescan reports changes
+    connect(&fontaDB(), &DB::catalogueChanged, this, &MainWindow::applyCatalogueDelta);
 }
 
 MainWindow::~MainWindow()
 {
+    // clean exit: there is nothing to recover next time
+    m_journal.discard();
+
     saveGeometry();
     delete ui;
 }
@@ -218,6 +237,9 @@ void MainWindow::changeAddTabButtonGeometry()
 
 void MainWindow::onTabsMove(int from, int to)
 {
+    flushJournal();
+    m_journal.tabMoved(from, to);
+
     WorkArea* toMove = m_workAreas.at(from);
     m_workAreas.removeAt(from);
     m_workAreas.insert(to, toMove);
@@ -278,8 +300,7 @@ void MainWindow::uninstallFont(const QString &fontName)
     int ret = callQuestionDialog(dialogMessage);
 
     if (ret == QMessageBox::Ok) {
-        fontaDB().uninstall(fontName);
-        currentFilterBoxIndexChanged(ui->filterBox->currentIndex()); // force fonts list update
+        fontaDB().uninstall(fontName); // fonts list is updated by DB::catalogueChanged
         return;
     }
 }
@@ -310,6 +331,10 @@ void MainWindow::addTab(InitType initType)
 
     m_workAreas.push_back(m_currWorkArea);
 
+    WorkArea *area = m_currWorkArea;
+    connect(area, &QSplitter::splitterMoved, this, [this, area](){ journalTab(area); });
+    journalTab(area);
+
     m_currField = m_currWorkArea->currField();
 
     makeFieldsConnected();
@@ -346,6 +371,10 @@ void MainWindow::closeTabPrompted(int i)
 
 void MainWindow::closeTab(int id)
 {
+    flushJournal();
+    m_journal.tabClosed(id);
+
+    m_pendingTabs.remove(m_workAreas[id]);
     delete m_workAreas[id];
     m_workAreas.removeAt(id);
     ui->tabWidget->removeTab(id);
@@ -405,12 +434,16 @@ void MainWindow::cloneCurrTab()
     m_currWorkArea->setCurrField((*m_currWorkArea)[0]);
     m_currField = m_currWorkArea->currField();
     m_currField->setFocus();
+
+    journalTab(m_currWorkArea);
 }
 
 void MainWindow::renameTab(int id)
 {
-    RenameTabEdit* edit = new RenameTabEdit(ui->tabWidget, m_workAreas[id], ui->tabWidget->tabBar());
+    WorkArea *area = m_workAreas[id];
+    RenameTabEdit* edit = new RenameTabEdit(ui->tabWidget, area, ui->tabWidget->tabBar());
     connect(edit, &RenameTabEdit::applied, this, &MainWindow::changeAddTabButtonGeometry);
+    connect(edit, &RenameTabEdit::applied, this, [this, area](){ journalTab(area); });
     edit->show();
 }
 
@@ -419,6 +452,8 @@ void MainWindow::makeFieldConnected(Field* field) {
     connect(field, &Field::contentBecameUserDefined, this, &MainWindow::resetFillActions);
     connect(field, &Field::contentBecameUserDefined, this, &MainWindow::disableContextGroup);
     connect(field, &Field::swapRequested, this, &MainWindow::swapFonts);
+    connect(field, &Field::modified, this, &MainWindow::journalField);
+    connect(field, &QTextEdit::textChanged, this, &MainWindow::journalField);
 }
 
 void MainWindow::makeFieldsConnected() {
@@ -435,6 +470,7 @@ void MainWindow::on_addFieldButton_clicked()
     makeFieldConnected(field);
 
     updateAddRemoveButtons();
+    journalTab(m_currWorkArea);
 }
 
 void MainWindow::on_removeFieldButton_clicked()
@@ -446,6 +482,7 @@ void MainWindow::on_removeFieldButton_clicked()
 
     m_currWorkArea->popField();
     updateAddRemoveButtons();
+    journalTab(m_currWorkArea);
 }
 
 void MainWindow::on_currentFieldChanged()
@@ -579,6 +616,86 @@ void MainWindow::on_sizeBox_activated(const QString &arg1)
     m_currField->setFontSize(val);
 }
 
+static QListWidgetItem *newFontItem(CStringRef family)
+{
+    QListWidgetItem* item = new QListWidgetItem(family);
+
+#ifdef FONTA_DETAILED_DEBUG
+    FullFontInfo info = fontaDB().getFullFontInfo(family);
+    QString detail;
+    QTextStream ss(&detail);
+
+    QString pad("      ");
+    ss << "Qt:\n";
+    if(info.qtInfo.cyrillic) ss << pad << "Cyrillic\n";
+    if(info.qtInfo.symbolic) ss << pad << "Symbolic\n";
+    if(info.qtInfo.monospaced) ss << pad << "Monospaced\n";
+
+    if(info.TTFExists) {
+        ss << "TTF:\n";
+        ss << pad << "Family:     " << FamilyClass::toString(info.traits.familyClass) << "\n";
+        ss << pad << "Family Sub: " << info.traits.familySubClass << "\n";
+        ss << pad << "Panose: " << info.traits.panose.getNumberAsString() << "\n";
+        if(info.traits.cyrillic) ss << pad << "Cyrillic\n";
+        ss << pad << "Scripts:";
+        for(int script = 0; script<Script::count; ++script) {
+            if(info.traits.supports(static_cast<Script::type>(script))) {
+                ss << ' ' << Script::toString(static_cast<Script::type>(script));
+            }
+        }
+        ss << "\n";
+        ss << pad << "Files: " << info.files.join(' ') << "\n";
+        if(!info.linkedFonts.isEmpty()) {
+            ss << pad << "Linked fonts: " << info.linkedFonts.join(' ');
+        }
+    } else {
+        qWarning() << family << qPrintable("doesn't have TTF");
+    }
+
+    if(detail.endsWith('\n') ) {
+        detail.truncate(detail.size()-1);
+    }
+
+    item->setToolTip(detail);
+#endif
+
+    return item;
+}
+
+using FontFilter = bool (DB::*)(CStringRef) const;
+
+// predicate of filter box mode and its Predicate bit, 0 for every font
+static QPair<FontFilter, u64> filterPredicate(int mode)
+{
+    switch(mode) {
+        default:
+        case FilterMode::All:        return {&DB::isAnyFont, 0};
+        case FilterMode::Cyrillic:   return {&DB::isCyrillic, Predicate::Cyrillic};
+        case FilterMode::Serif:      return {&DB::isSerif, Predicate::Serif};
+        case FilterMode::SansSerif:  return {&DB::isSansSerif, Predicate::SansSerif};
+        case FilterMode::Monospace:  return {&DB::isMonospaced, Predicate::Monospaced};
+        case FilterMode::Script:     return {&DB::isScript, Predicate::Script};
+        case FilterMode::Decorative: return {&DB::isDecorative, Predicate::Decorative};
+        case FilterMode::Symbolic:   return {&DB::isSymbolic, Predicate::Symbolic};
+        case FilterMode::Greek:      return {&DB::isGreek, Predicate::Greek};
+        case FilterMode::Armenian:   return {&DB::isArmenian, Predicate::Armenian};
+        case FilterMode::Hebrew:     return {&DB::isHebrew, Predicate::Hebrew};
+        case FilterMode::Arabic:     return {&DB::isArabic, Predicate::Arabic};
+        case FilterMode::Devanagari: return {&DB::isDevanagari, Predicate::Devanagari};
+        case FilterMode::Thai:       return {&DB::isThai, Predicate::Thai};
+        case FilterMode::Georgian:   return {&DB::isGeorgian, Predicate::Georgian};
+        case FilterMode::Chinese:    return {&DB::isChinese, Predicate::Chinese};
+        case FilterMode::Japanese:   return {&DB::isJapanese, Predicate::Japanese};
+        case FilterMode::Korean:     return {&DB::isKorean, Predicate::Korean};
+        case FilterMode::Light:      return {&DB::isLight, Predicate::Light};
+        case FilterMode::Bold:       return {&DB::isBold, Predicate::Bold};
+        case FilterMode::Condensed:  return {&DB::isCondensed, Predicate::Condensed};
+        case FilterMode::Expanded:   return {&DB::isExpanded, Predicate::Expanded};
+        case FilterMode::Italic:     return {&DB::isItalic, Predicate::Italic};
+        case FilterMode::Variable:   return {&DB::isVariable, Predicate::Variable};
+    }
+}
+
 void MainWindow::currentFilterBoxIndexChanged(int index)
 {
     if(ui->filterBox->currentText() == tr("Custom")) {
@@ -590,6 +707,8 @@ void MainWindow::currentFilterBoxIndexChanged(int index)
         }
     }
 
+    FONTA_TRACE_SPAN("filter", "MainWindow::filterBox");
+
     // preserve family
     QString currFamily;
     if(m_currField) {
@@ -598,18 +717,7 @@ void MainWindow::currentFilterBoxIndexChanged(int index)
 
     ui->fontsList->clear();
 
-    bool (DB::*goodFont)(CStringRef) const;
-    switch(index) {
-        default:
-        case FilterMode::All:        goodFont = &DB::isAnyFont; break;
-        case FilterMode::Cyrillic:   goodFont = &DB::isCyrillic; break;
-        case FilterMode::Serif:      goodFont = &DB::isSerif; break;
-        case FilterMode::SansSerif:  goodFont = &DB::isSansSerif; break;
-        case FilterMode::Monospace:  goodFont = &DB::isMonospaced; break;
-        case FilterMode::Script:     goodFont = &DB::isScript; break;
-        case FilterMode::Decorative: goodFont = &DB::isDecorative; break;
-        case FilterMode::Symbolic:   goodFont = &DB::isSymbolic; break;
-    }
+    const FontFilter goodFont = filterPredicate(index).first;
 
     for (CStringRef family : fontaDB().families()) {
 
@@ -617,48 +725,81 @@ void MainWindow::currentFilterBoxIndexChanged(int index)
             continue;
         }
 
-        QListWidgetItem* item = new QListWidgetItem(family);
+        ui->fontsList->addItem(newFontItem(family));
+    }
+
+    ui->statusBar->showMessage(tr("%1 fonts").arg(ui->fontsList->count()));
 
-#ifdef FONTA_DETAILED_DEBUG
-        FullFontInfo info = fontaDB().getFullFontInfo(family);
-        QString detail;
-        QTextStream ss(&detail);
-
-        QString pad("      ");
-        ss << "Qt:\n";
-        if(info.qtInfo.cyrillic) ss << pad << "Cyrillic\n";
-        if(info.qtInfo.symbolic) ss << pad << "Symbolic\n";
-        if(info.qtInfo.monospaced) ss << pad << "Monospaced\n";
-
-        if(info.TTFExists) {
-            ss << "TTF:\n";
-            ss << pad << "Family:     " << FamilyClass::toString(info.fontaTFF->familyClass) << "\n";
-            ss << pad << "Family Sub: " << info.fontaTFF->familySubClass << "\n";
-            ss << pad << "Panose: " << info.fontaTFF->panose.getNumberAsString() << "\n";
-            if(info.fontaTFF->cyrillic) ss << pad << "Cyrillic\n";
-            ss << pad << "Files: " << info.fontaTFF->files.toList().join(' ') << "\n";
-            if(!info.fontaTFF->linkedFonts.isEmpty()) {
-                ss << pad << "Linked fonts: " << info.fontaTFF->linkedFonts.toList().join(' ');
+    if(m_currField) {
+        m_currField->setFontFamily(currFamily);
+    }
+}
+
+void MainWindow::applyCatalogueDelta(const CatalogueDelta &delta)
+{
+    FONTA_TRACE_SPAN("filter", "MainWindow::applyCatalogueDelta");
+
+    QListWidget *list = ui->fontsList;
+
+    // items are in DB::familyLess() order, like families() they came from
+    cauto row = [list](CStringRef family) {
+        int lo = 0;
+        int hi = list->count();
+        while(lo < hi) {
+            const int mid = lo + (hi - lo)/2;
+            if(DB::familyLess(list->item(mid)->text(), family)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
             }
-        } else {
-            qWarning() << family << qPrintable("doesn't have TTF");
         }
+        return lo;
+    };
 
-        if(detail.endsWith('\n') ) {
-            detail.truncate(detail.size()-1);
+    cauto remove = [&](CStringRef family) {
+        const int r = row(family);
+        if(r < list->count() && list->item(r)->text() == family) {
+            delete list->takeItem(r);
         }
+    };
 
-        item->setToolTip(detail);
-#endif
+    cauto insert = [&](CStringRef family) {
+        const int r = row(family);
+        if(r == list->count() || list->item(r)->text() != family) {
+            list->insertItem(r, newFontItem(family));
+        }
+    };
 
-        ui->fontsList->addItem(item);
+    // selection and scroll position survive, only touched rows change
+    for(CStringRef family : delta.removed) {
+        remove(family);
     }
 
-    ui->statusBar->showMessage(tr("%1 fonts").arg(ui->fontsList->count()));
+    // custom list is wizard's result, it is not known what else would pass
+    if(ui->filterBox->currentText() != tr("Custom")) {
+        const auto filter = filterPredicate(ui->filterBox->currentIndex());
 
-    if(m_currField) {
-        m_currField->setFontFamily(currFamily);
+        for(CStringRef family : delta.added) {
+            if((fontaDB().*filter.first)(family)) {
+                insert(family);
+            }
+        }
+
+        for(int i = 0; i<delta.changed.size(); ++i) {
+            if(!(delta.changedPredicates.at(i) & filter.second)) {
+                continue;
+            }
+
+            CStringRef family = delta.changed.at(i);
+            if((fontaDB().*filter.first)(family)) {
+                insert(family);
+            } else {
+                remove(family);
+            }
+        }
     }
+
+    ui->statusBar->showMessage(tr("%1 fonts").arg(list->count()));
 }
 
 void MainWindow::on_styleBox_activated(CStringRef style)
@@ -692,7 +833,27 @@ void MainWindow::on_trackingBox_activated(CStringRef arg1)
     m_currField->setTracking(val);
 }
 
-void MainWindow::save(CStringRef fileName) const
+void MainWindow::save(CStringRef fileName)
+{
+    loadPendingTabs();
+
+    // json is kept as interchange format, native one is binary
+    if(fileName.endsWith(QLatin1String(".json"), Qt::CaseInsensitive)) {
+        saveJson(fileName);
+        return;
+    }
+
+    QVector<TabData> tabs(m_workAreas.size());
+    for(int i = 0; i<m_workAreas.size(); ++i) {
+        m_workAreas[i]->save(tabs[i]);
+    }
+
+    if(!FontaFile::write(fileName, tabs, m_currWorkArea->id())) {
+        qWarning("Couldn't write save file.");
+    }
+}
+
+void MainWindow::saveJson(CStringRef fileName) const
 {
     QJsonObject json;
 
@@ -728,7 +889,7 @@ void MainWindow::on_actionSave_as_triggered()
     QString saveFilePath = m_settings.value(QStringLiteral("OpenSaveFilePath"), QDir::homePath()).toString();
 
     QString filename =
-            QFileDialog::getSaveFileName(this, tr("Save Fonta"), saveFilePath, tr("Fonta files (*.fonta)"));
+            QFileDialog::getSaveFileName(this, tr("Save Fonta"), saveFilePath, tr("Fonta files (*.fonta);;JSON files (*.json)"));
 
     if(!filename.isNull()) {
         save(filename);
@@ -750,8 +911,28 @@ void MainWindow::load(CStringRef fileName)
 
     clearWorkAreas();
 
-    QByteArray saveData = loadFile.readAll();
-    QJsonDocument loadDoc(QJsonDocument::fromJson(saveData));
+    if(FontaFile::isBinary(loadFile)) {
+        loadFile.close();
+        loadBinary(fileName);
+    } else {
+        loadJson(loadFile.readAll());
+    }
+
+    if(m_workAreas.isEmpty()) {
+        addTab();
+    }
+
+    m_currField = m_currWorkArea->currField();
+    if(m_currField) {
+        m_currField->setFocus();
+    }
+
+    resetJournal();
+}
+
+void MainWindow::loadJson(const QByteArray &data)
+{
+    QJsonDocument loadDoc(QJsonDocument::fromJson(data));
     QJsonObject json = loadDoc.object();
 
     const QJsonArray workAreas = json[QLatin1String("workAreas")].toArray();
@@ -765,9 +946,79 @@ void MainWindow::load(CStringRef fileName)
 
     int workAreaId = json[QLatin1String("currWorkArea")].toInt(0);
     ui->tabWidget->setCurrentIndex(workAreaId);
+}
 
-    m_currField = m_currWorkArea->currField();
-    m_currField->setFocus();
+void MainWindow::loadBinary(CStringRef fileName)
+{
+    if(!m_reader.open(fileName)) {
+        qWarning("Couldn't read save file.");
+        return;
+    }
+
+    // only index is read here: tabs are created empty and filled later
+    for(int i = 0; i<m_reader.tabsCount(); ++i) {
+        addTab(InitType::Empty);
+        m_currWorkArea->rename(m_reader.tabName(i));
+        ui->tabWidget->setTabText(m_currWorkArea->id(), m_currWorkArea->name());
+        m_pendingTabs[m_currWorkArea] = i;
+    }
+
+    if(m_workAreas.isEmpty()) {
+        m_reader.close();
+        return;
+    }
+
+    // active tab goes first, the rest is streamed in from the event loop
+    const int workAreaId = m_reader.currTab();
+    ensureTabLoaded(m_workAreas[workAreaId]);
+    ui->tabWidget->setCurrentIndex(workAreaId);
+    setCurrWorkArea(workAreaId);
+
+    QTimer::singleShot(0, this, &MainWindow::loadNextPendingTab);
+}
+
+void MainWindow::ensureTabLoaded(WorkArea *area)
+{
+    auto it = m_pendingTabs.find(area);
+    if(it == m_pendingTabs.end()) {
+        return;
+    }
+
+    TabData tab;
+    if(m_reader.readTab(it.value(), tab)) {
+        area->load(tab);
+        for(auto *field : std::as_const(*area)) {
+            makeFieldConnected(field);
+        }
+    } else {
+        qWarning("Couldn't read tab from save file.");
+    }
+
+    m_pendingTabs.erase(it);
+    if(m_pendingTabs.isEmpty()) {
+        m_reader.close();
+    }
+}
+
+void MainWindow::loadPendingTabs()
+{
+    while(!m_pendingTabs.isEmpty()) {
+        ensureTabLoaded(m_pendingTabs.begin().key());
+    }
+}
+
+void MainWindow::loadNextPendingTab()
+{
+    for(auto *area : std::as_const(m_workAreas)) {
+        if(m_pendingTabs.contains(area)) {
+            ensureTabLoaded(area);
+            break;
+        }
+    }
+
+    if(!m_pendingTabs.isEmpty()) {
+        QTimer::singleShot(0, this, &MainWindow::loadNextPendingTab);
+    }
 }
 
 void MainWindow::openFile(CStringRef filename)
@@ -786,7 +1037,7 @@ void MainWindow::on_actionOpen_triggered()
     QString saveFilePath = m_settings.value(QStringLiteral("OpenSaveFilePath"), QDir::homePath()).toString();
 
     QString filename =
-            QFileDialog::getOpenFileName(this, tr("Open Fonta"), saveFilePath, tr("Fonta files (*.fonta)"));
+            QFileDialog::getOpenFileName(this, tr("Open Fonta"), saveFilePath, tr("Fonta files (*.fonta);;JSON files (*.json)"));
 
     if(!filename.isNull()) {
         openFile(filename);
@@ -817,6 +1068,9 @@ void MainWindow::resetCurrFile()
 
 void MainWindow::clearWorkAreas()
 {
+    m_pendingTabs.clear();
+    m_reader.close();
+
     int prevSize = m_workAreas.size();
     for(int i = 0; i<prevSize; ++i) {
         QWidget* w = ui->tabWidget->widget(0);
@@ -831,6 +1085,7 @@ void MainWindow::on_actionNew_triggered()
     resetCurrFile();
     clearWorkAreas();
     addTab();
+    resetJournal();
 }
 
 void MainWindow::updateAddRemoveButtons()
@@ -846,6 +1101,8 @@ void MainWindow::setCurrWorkArea(int id)
     }
 
     m_currWorkArea = m_workAreas[id];
+    ensureTabLoaded(m_currWorkArea);
+
     if(m_currWorkArea->fieldCount()) {
         m_currField = m_currWorkArea->currField();
         m_currField->setFocus();
@@ -860,6 +1117,9 @@ void MainWindow::on_tabWidget_currentChanged(int index)
 
     setCurrWorkArea(index);
     updateAddRemoveButtons();
+
+    flushJournal();
+    m_journal.currentTab(index);
 }
 
 
@@ -1090,4 +1350,111 @@ void MainWindow::on_actionRussian_triggered()
     setLanguage(QStringLiteral("ru"));
 }
 
+void MainWindow::journalTab(WorkArea *area)
+{
+    m_dirtyTabs.insert(area);
+    if(!m_journalTimer.isActive()) {
+        m_journalTimer.start();
+    }
+}
+
+void MainWindow::journalField()
+{
+    Field *field = qobject_cast<Field *>(sender());
+    if(!field) {
+        return;
+    }
+
+    m_dirtyFields.insert(field);
+    if(!m_journalTimer.isActive()) {
+        m_journalTimer.start();
+    }
+}
+
+void MainWindow::flushJournal()
+{
+    m_journalTimer.stop();
+
+    // dirty sets may keep pointers to already deleted widgets,
+    // so they are only compared with alive ones and never dereferenced
+    for(int i = 0; i<m_workAreas.size(); ++i) {
+        WorkArea *area = m_workAreas[i];
+        if(m_pendingTabs.contains(area)) {
+            continue;
+        }
+
+        // only values are copied here, journal encodes them on its own thread
+        if(m_dirtyTabs.contains(area)) {
+            TabData tab;
+            QVector<FieldData> fields;
+            area->save(tab, fields);
+            m_journal.tabState(i, tab, fields);
+            continue; // tab state already covers its fields
+        }
+
+        for(Field *field : std::as_const(*area)) {
+            if(m_dirtyFields.contains(field)) {
+                m_journal.fieldState(i, field->id(), field->data());
+            }
+        }
+    }
+
+    m_dirtyTabs.clear();
+    m_dirtyFields.clear();
+}
+
+void MainWindow::resetJournal()
+{
+    m_journalTimer.stop();
+    m_dirtyTabs.clear();
+    m_dirtyFields.clear();
+
+    // tabs not loaded yet are only referred to, writer reads them from the file itself
+    QVector<TabData> tabs(m_workAreas.size());
+    QVector<int> sourceTabs(m_workAreas.size(), -1);
+    for(int i = 0; i<m_workAreas.size(); ++i) {
+        WorkArea *area = m_workAreas[i];
+
+        auto it = m_pendingTabs.constFind(area);
+        if(it != m_pendingTabs.constEnd()) {
+            tabs[i].name = area->name();
+            sourceTabs[i] = it.value();
+        } else {
+            area->save(tabs[i]);
+        }
+    }
+
+    m_journal.reset(tabs, qMax(0, m_workAreas.indexOf(m_currWorkArea)),
+                    m_pendingTabs.isEmpty() ? QString() : m_reader.fileName(), sourceTabs);
+}
+
+bool MainWindow::recoverSession(CStringRef question)
+{
+    QVector<TabData> tabs;
+    int currTab = 0;
+
+    if(!Journal::recover(tabs, currTab)) {
+        return false;
+    }
+
+    if(!question.isEmpty()
+    && QMessageBox::question(this, tr("Fonta"), question) != QMessageBox::Yes) {
+        return false;
+    }
+
+    for(const TabData &tab : std::as_const(tabs)) {
+        addTab(InitType::Empty);
+        m_currWorkArea->load(tab);
+        makeFieldsConnected();
+        ui->tabWidget->setTabText(m_currWorkArea->id(), m_currWorkArea->name());
+    }
+
+    ui->tabWidget->setCurrentIndex(currTab);
+    setCurrWorkArea(currTab);
+
+    ui->statusBar->showMessage(tr("Previous session has been restored"));
+
+    return true;
+}
+
 } // namespace fonta
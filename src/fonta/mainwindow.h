@@ -2,8 +2,13 @@
 #define FONTAWINDOW_H
 
 #include "fontadb.h"
+#include "fontafile.h"
+#include "journal.h"
 #include <QMainWindow>
 #include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
 #include <QSettings>
 #include <QVersionNumber>
 #include "types_fonta.h"
@@ -49,6 +54,7 @@ private slots:
     void onTrackingBoxEdited();
     void on_trackingBox_activated(const QString &arg1);
     void currentFilterBoxIndexChanged(int index);
+    void applyCatalogueDelta(const CatalogueDelta &delta);
     void on_styleBox_activated(const QString &arg1);
 
     void showTabsContextMenu(const QPoint &point);
@@ -101,6 +107,11 @@ private slots:
 
     void on_actionRussian_triggered();
 
+    void loadNextPendingTab();
+
+    void journalField();
+    void flushJournal();
+
 protected:
     void resizeEvent(QResizeEvent* event);
 
@@ -127,8 +138,26 @@ private:
     void saveGeometry();
     void loadGeometry();
 
-    void save(CStringRef fileName) const;
+    void save(CStringRef fileName);
+    void saveJson(CStringRef fileName) const;
     void load(CStringRef fileName);
+    void loadJson(const QByteArray &data);
+    void loadBinary(CStringRef fileName);
+
+    // tabs of binary file which are not decoded yet (mapped to their index in file)
+    FontaFileReader m_reader;
+    QHash<WorkArea*, int> m_pendingTabs;
+    void ensureTabLoaded(WorkArea *area);
+    void loadPendingTabs();
+
+    // workspace changes are coalesced here and then passed to journal
+    Journal m_journal;
+    QTimer m_journalTimer;
+    QSet<WorkArea*> m_dirtyTabs;
+    QSet<Field*> m_dirtyFields;
+    void journalTab(WorkArea *area);
+    void resetJournal();
+    bool recoverSession(CStringRef question = QString());
 
     void openFile(CStringRef fileName);
 
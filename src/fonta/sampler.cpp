@@ -2,17 +2,7 @@
 
 #include "widgets/workarea.h"
 
-#include <cstdlib>
 #include <QVector>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
-#include <QUrl>
-#include <QXmlStreamReader>
-
-#ifdef FONTA_MEASURES
-#include <QElapsedTimer>
-#include <QDebug>
-#endif
 
 #include "fontadb.h"
 
@@ -30,9 +20,19 @@ Sampler *Sampler::instance() {
 
 Sampler::Sampler()
 {
-    // try to fetch rss news
-    fetchNews(textsEng, QStringLiteral("http://feeds.bbci.co.uk/news/world/rss.xml"), QStringLiteral("description"));
-    fetchNews(textsRus, QStringLiteral("http://tass.ru/rss/v2.xml"), QStringLiteral("title"));
+    // providers are asked in order, builtin texts are always the last resort
+    if(RssTextProvider::enabled()) {
+        m_providers << new RssTextProvider;
+    }
+
+    CorpusTextProvider *corpus = new CorpusTextProvider;
+    if(corpus->isEmpty()) {
+        delete corpus;
+    } else {
+        m_providers << corpus;
+    }
+
+    m_providers << new BuiltinTextProvider;
 
     for(const Sample& p : preSamples) {
         if(Family::exists(p.family1) && Family::exists(p.family2)) {
@@ -41,6 +41,11 @@ Sampler::Sampler()
     }
 }
 
+Sampler::~Sampler()
+{
+    qDeleteAll(m_providers);
+}
+
 const QStringList Sampler::names = {
     QStringLiteral("Severin"),
     QStringLiteral("Alois"),
@@ -62,78 +67,14 @@ const QStringList Sampler::names = {
     QStringLiteral("Melissa"),
 };
 
-QStringList Sampler::textsEng = {
-    QStringLiteral("Before 1960 95% of soft drinks sold in the U.S. are furnished in reusable bottles."),
-    QStringLiteral("Ernest Hemmingway commits suicide with shotgun."),
-    QStringLiteral("American U-2 spy plane, piloted by Francis Gary Powers, shot down over Russia"),
-    QStringLiteral("Kennedy was assassinated in Dallas, Texas, on November 22, 1963"),
-    QStringLiteral("Donald Trump promises to dissolve his Trump Foundation charity, which is still under investigation."),
-    QStringLiteral("Senator Leila de Lima says the charges are an attempt to silence her criticism of the drug war."),
-    QStringLiteral("Councillors unhappy about absence of sausage stalls at German Earth Day festival."),
-    QStringLiteral("A pay ruling triggers a passionate backlash about the rights of hospitality and retails workers."),
-    QStringLiteral("A Canadian hospital will study the effects cannabis oil on a severe form of epilepsy"),
-    QStringLiteral("A distribution company says many of the 251 Freedom handsets it paid for have not been delivered."),
-    QStringLiteral("Organiser says the ironic event is a protest against fake news."),
-    QStringLiteral("More fruit and veg might prevent nearly eight million premature deaths each year, researchers say."),
-    QStringLiteral("The advance marks the first time troops enter an urban district in latest phase of campaign."),
-    /*QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),*/
-};
-
-QStringList Sampler::textsRus = {
-    QStringLiteral("Шифровальщица попросту забыла ряд ключевых множителей и тэгов"),
-    QStringLiteral("Широкая электрификация южных губерний даст мощный толчок подъёму сельского хозяйства"),
-    QStringLiteral("Подъём с затонувшего эсминца легкобьющейся древнегреческой амфоры сопряжён с техническими трудностями"),
-    QStringLiteral("Лыжник Червоткин завоевал первое золото для сборной России на Военных играх - 2017"),
-    QStringLiteral("Советник президента США опровергла данные о запрете ей давать телеинтервью"),
-    QStringLiteral("Полиция Филиппин арестовала сенатора, критиковавшую президента"),
-    QStringLiteral("Дождь, порывистый ветер и до 5 градусов тепла ожидаются в Московском регионе"),
-    QStringLiteral("\"Прогресс МС-05\" пристыковался к МКС в автоматическом режиме"),
-    QStringLiteral("Рок-музыкант признал свою вину в проносе пистолета на борт самолета"),
-    /*QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),
-    QStringLiteral(""),*/
-};
-
 bool Family::exists(type t)
 {
-    const QStringList &fontNames = familyMap[t];
-    const QStringList &families = fontaDB().families();
-
-    for(CStringRef name : fontNames) {
-        if(families.contains(name)) {
-            return true;
-        }
-    }
-
-    return false;
+    return !fontaDB().resolveFamily(familyMap[t]).isNull();
 }
 
 QString Family::name(type t)
 {
-    const QStringList &fontNames = familyMap[t];
-    const QStringList &families = fontaDB().families();
-
-    for(CStringRef name : fontNames) {
-        if(families.contains(name)) {
-            return name;
-        }
-    }
-
-    return QString::null;
+    return fontaDB().resolveFamily(familyMap[t]);
 }
 
 const QMap<Family::type, QStringList> Family::familyMap = {
@@ -199,148 +140,10 @@ const QVector<Sample> Sampler::preSamples = {
     { Family::Coolvetica, 18, Family::ArialNarrow, 12 },
 };
 
-struct NewsData {
-    QStringList *list;
-    QString tag;
-
-    NewsData()
-        : list(nullptr)
-    {}
-    NewsData(QStringList *list, const QString &tag)
-        : list(list)
-        , tag(tag)
-#ifdef FONTA_MEASURES
-        , timer(new QElapsedTimer)
-#endif
-    {}
-
-#ifdef FONTA_MEASURES
-    QElapsedTimer *timer {nullptr};
-#endif
-};
-
-QNetworkAccessManager *network;
-static QHash<QNetworkReply *, NewsData> newsMap;
-
-void Sampler::fetchNews(QStringList &list, CStringRef url, CStringRef tag)
-{
-    if(newsMap.isEmpty()) {
-        network = new QNetworkAccessManager;
-    }
-
-    QNetworkReply *reply = network->get(QNetworkRequest(url));
-
-    NewsData d(&list, tag);
-    newsMap[reply] = d;
-
-#ifdef FONTA_MEASURES
-    d.timer->start();
-#endif
-
-    QObject::connect(reply, SIGNAL(finished()), this, SLOT(fetchNewsSlot()));
-}
-
-void cleanupNetwork(QNetworkReply *reply)
-{
-    reply->deleteLater();
-#ifdef FONTA_MEASURES
-    delete newsMap[reply].timer;
-#endif
-    newsMap.remove(reply);
-    if(newsMap.isEmpty()) {
-        delete network;
-    }
-}
-
-void Sampler::fetchNewsSlot()
-{
-    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
-    NewsData &d = newsMap[reply];
-
-    if(reply->error() != QNetworkReply::NoError) {
-#ifdef FONTA_MEASURES
-        qDebug() << d.timer->elapsed() << "ms: timeout to load news";
-#endif
-        cleanupNetwork(reply);
-        return;
-    } else {
-#ifdef FONTA_MEASURES
-        qDebug() << d.timer->elapsed() << "ms to load news";
-#endif
-    }
-
-    QStringList &list = *d.list;
-    CStringRef tag = d.tag;
-
-    QStringList tmpList;
-
-#ifdef FONTA_MEASURES
-    d.timer->start();
-#endif
-
-    QXmlStreamReader r(reply->readAll());
-    while(r.readNextStartElement());
-    while(!r.atEnd()) {
-        r.readNext();
-        if(r.name() ==
-    QStringLiteral("item")) {
-            while(!r.atEnd()) {
-                r.readNext();
-                if(r.name() == tag) {
-                    tmpList << r.readElementText();
-                    break;
-                }
-            }
-        }
-    }
-
-    if(tmpList.count()) {
-        list.clear();
-        list << tmpList;
-    }
-
-#ifdef FONTA_MEASURES
-    qDebug() << d.timer->elapsed() << "ms to process news rss-xml";
-#endif
-
-    cleanupNetwork(reply);
-}
-
 QVector<Sample> Sampler::samples;
 QSet<int> Sampler::namesPool;
-QSet<int> Sampler::textsEngPool;
-QSet<int> Sampler::textsRusPool;
 QSet<int> Sampler::samplesPool;
 
-static int getPoolsValue(QSet<int>& pool, int length)
-{
-    int r = rand()%length;
-
-    if(!pool.contains(r)) {
-        pool.insert(r);
-        return r;
-    } else {
-        int i = r+1;
-        while(i != r){
-            if(i >= length) {
-                i = 0;
-                continue;
-            }
-
-            if(pool.contains(i)) {
-                ++i;
-            } else {
-                pool.insert(i);
-                return i;
-            }
-        }
-
-        pool.clear();
-        pool.insert(r);
-        return r;
-    }
-}
-
 static const QString engPangram("The quick brown fox jumps over the lazy dog. 1234567890");
 static const QString rusPangram("Съешь же ещё этих мягких французских булок да выпей чаю. The quick brown fox jumps over the lazy dog. 1234567890");
 
@@ -366,13 +169,12 @@ CStringRef Sampler::getName()
     return names.at(i);
 }
 
-CStringRef Sampler::getEngText(ContentMode mode)
+QString Sampler::getEngText(ContentMode mode, const TextQuery &query)
 {
     switch(mode) {
         default:
         case ContentMode::News: {
-            int i = getPoolsValue(textsEngPool, textsEng.length());
-            return textsEng.at(i);
+            return news(LanguageContext::Eng, query);
         } break;
         case ContentMode::Pangram: {
             return engPangram;
@@ -386,13 +188,12 @@ CStringRef Sampler::getEngText(ContentMode mode)
     }
 }
 
-CStringRef Sampler::getRusText(ContentMode mode)
+QString Sampler::getRusText(ContentMode mode, const TextQuery &query)
 {
     switch(mode) {
         default:
         case ContentMode::News: {
-            int i = getPoolsValue(textsRusPool, textsRus.length());
-            return textsRus.at(i);
+            return news(LanguageContext::Rus, query);
         } break;
         case ContentMode::Pangram: {
             return rusPangram;
@@ -406,6 +207,26 @@ CStringRef Sampler::getRusText(ContentMode mode)
     }
 }
 
+QString Sampler::news(LanguageContext language, const TextQuery &query)
+{
+    QString text;
+
+    for(TextProvider *provider : std::as_const(m_providers)) {
+        if(provider->sentence(language, query, text)) {
+            return text;
+        }
+    }
+
+    // nothing fits, so any sentence is better than empty field
+    for(TextProvider *provider : std::as_const(m_providers)) {
+        if(provider->sentence(language, TextQuery(), text)) {
+            return text;
+        }
+    }
+
+    return text;
+}
+
 void Sampler::loadSample(WorkArea& area)
 {
     int i = getPoolsValue(samplesPool, samples.length());
@@ -2,6 +2,7 @@
 #define SAMPLER_H
 
 #include "types_fonta.h"
+#include "textprovider.h"
 #include <QObject>
 #include <QSet>
 #include <QStringList>
@@ -67,30 +68,26 @@ public:
     static Sampler *instance();
 
     CStringRef getName();
-    CStringRef getEngText(ContentMode mode);
-    CStringRef getRusText(ContentMode mode);
+    QString getEngText(ContentMode mode, const TextQuery &query = TextQuery());
+    QString getRusText(ContentMode mode, const TextQuery &query = TextQuery());
     void loadSample(WorkArea& area);
 
-private slots:
-    void fetchNewsSlot();
-
 private:
     Sampler();
+    ~Sampler();
     Sampler(const Sampler &) = delete;
     void operator=(const Sampler &) = delete;
     static Sampler *mInstance;
 
-    void fetchNews(QStringList &list, CStringRef url, CStringRef tag);
+    QVector<TextProvider *> m_providers;
+
+    QString news(LanguageContext language, const TextQuery &query);
 
     static const QStringList names;
-    static QStringList textsEng;
-    static QStringList textsRus;
     static const QVector<Sample> preSamples;
     static QVector<Sample> samples;
 
     static QSet<int> namesPool;
-    static QSet<int> textsEngPool;
-    static QSet<int> textsRusPool;
     static QSet<int> samplesPool;
 };
 
@@ -0,0 +1,581 @@
+#include "textprovider.h"
+
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QFontMetrics>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QUrl>
+#include <random>
+
+#include "trace.h"
+
+namespace fonta {
+
+int getPoolsValue(QSet<int>& pool, int length)
+{
+    int r = rand()%length;
+
+    if(!pool.contains(r)) {
+        pool.insert(r);
+        return r;
+    } else {
+        int i = r+1;
+        while(i != r){
+            if(i >= length) {
+                i = 0;
+                continue;
+            }
+
+            if(pool.contains(i)) {
+                ++i;
+            } else {
+                pool.insert(i);
+                return i;
+            }
+        }
+
+        pool.clear();
+        pool.insert(r);
+        return r;
+    }
+}
+
+static bool pickFromList(const QStringList &list, QSet<int> &pool, const TextQuery &query, QString &out)
+{
+    if(list.isEmpty()) {
+        return false;
+    }
+
+    for(int tries = 0; tries<list.length(); ++tries) {
+        CStringRef text = list.at(getPoolsValue(pool, list.length()));
+        if(query.accepts(text)) {
+            out = text;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TextQuery::accepts(CStringRef text) const
+{
+    if(text.length() < minLength || text.length() > maxLength) {
+        return false;
+    }
+
+    if(!covers) {
+        return true;
+    }
+
+    for(const QChar &c : text) {
+        if(!c.isSpace() && !covers(c)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TextQuery TextQuery::forFont(const QFont &font)
+{
+    TextQuery query;
+
+    QFontMetrics metrics(font);
+    query.covers = [metrics](QChar c) {
+        return metrics.inFont(c);
+    };
+
+    return query;
+}
+
+// Builtin
+
+const QStringList BuiltinTextProvider::textsEng = {
+    QStringLiteral("Before 1960 95% of soft drinks sold in the U.S. are furnished in reusable bottles."),
+    QStringLiteral("Ernest Hemmingway commits suicide with shotgun."),
+    QStringLiteral("American U-2 spy plane, piloted by Francis Gary Powers, shot down over Russia"),
+    QStringLiteral("Kennedy was assassinated in Dallas, Texas, on November 22, 1963"),
+    QStringLiteral("Donald Trump promises to dissolve his Trump Foundation charity, which is still under investigation."),
+    QStringLiteral("Senator Leila de Lima says the charges are an attempt to silence her criticism of the drug war."),
+    QStringLiteral("Councillors unhappy about absence of sausage stalls at German Earth Day festival."),
+    QStringLiteral("A pay ruling triggers a passionate backlash about the rights of hospitality and retails workers."),
+    QStringLiteral("A Canadian hospital will study the effects cannabis oil on a severe form of epilepsy"),
+    QStringLiteral("A distribution company says many of the 251 Freedom handsets it paid for have not been delivered."),
+    QStringLiteral("Organiser says the ironic event is a protest against fake news."),
+    QStringLiteral("More fruit and veg might prevent nearly eight million premature deaths each year, researchers say."),
+    QStringLiteral("The advance marks the first time troops enter an urban district in latest phase of campaign."),
+    /*QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),*/
+};
+
+const QStringList BuiltinTextProvider::textsRus = {
+    QStringLiteral("Шифровальщица попросту забыла ряд ключевых множителей и тэгов"),
+    QStringLiteral("Широкая электрификация южных губерний даст мощный толчок подъёму сельского хозяйства"),
+    QStringLiteral("Подъём с затонувшего эсминца легкобьющейся древнегреческой амфоры сопряжён с техническими трудностями"),
+    QStringLiteral("Лыжник Червоткин завоевал первое золото для сборной России на Военных играх - 2017"),
+    QStringLiteral("Советник президента США опровергла данные о запрете ей давать телеинтервью"),
+    QStringLiteral("Полиция Филиппин арестовала сенатора, критиковавшую президента"),
+    QStringLiteral("Дождь, порывистый ветер и до 5 градусов тепла ожидаются в Московском регионе"),
+    QStringLiteral("\"Прогресс МС-05\" пристыковался к МКС в автоматическом режиме"),
+    QStringLiteral("Рок-музыкант признал свою вину в проносе пистолета на борт самолета"),
+    /*QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),
+    QStringLiteral(""),*/
+};
+
+bool BuiltinTextProvider::sentence(LanguageContext language, const TextQuery &query, QString &out)
+{
+    if(language == LanguageContext::Rus) {
+        return pickFromList(textsRus, m_rusPool, query, out);
+    } else {
+        return pickFromList(textsEng, m_engPool, query, out);
+    }
+}
+
+// Corpus
+
+static const int CorpusTries = 64;
+static const u32 MinSentenceBytes = 16;
+static const u32 MaxSentenceBytes = 1024;
+
+static QStringList corpusDirs()
+{
+    QStringList dirs;
+
+    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
+    const QString custom = fontaReg.value(QStringLiteral("CorpusPath")).toString();
+    if(!custom.isEmpty()) {
+        dirs << custom;
+    }
+
+    dirs << QCoreApplication::applicationDirPath() + QStringLiteral("/corpus");
+    dirs << QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/corpus");
+
+    return dirs;
+}
+
+static QString findCorpus(CStringRef fileName)
+{
+    for(CStringRef dir : corpusDirs()) {
+        const QString path = dir + '/' + fileName;
+        if(QFileInfo::exists(path)) {
+            return path;
+        }
+    }
+
+    return QString::null;
+}
+
+CorpusTextProvider::CorpusTextProvider()
+{
+    open(m_eng, findCorpus(QStringLiteral("en.txt")));
+    open(m_rus, findCorpus(QStringLiteral("ru.txt")));
+}
+
+CorpusTextProvider::~CorpusTextProvider()
+{
+    for(Corpus *corpus : {&m_eng, &m_rus}) {
+        corpus->cancel = true;
+        if(corpus->indexer.joinable()) {
+            corpus->indexer.join();
+        }
+        if(corpus->data) {
+            corpus->file.unmap(const_cast<uchar *>(corpus->data));
+        }
+    }
+}
+
+bool CorpusTextProvider::isEmpty() const
+{
+    return !m_eng.data && !m_rus.data;
+}
+
+void CorpusTextProvider::open(Corpus &corpus, CStringRef fileName)
+{
+    if(fileName.isEmpty()) {
+        return;
+    }
+
+    corpus.file.setFileName(fileName);
+    if(!corpus.file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    corpus.size = corpus.file.size();
+    corpus.data = corpus.file.map(0, corpus.size);
+    if(!corpus.data) {
+        corpus.file.close();
+        return;
+    }
+
+    corpus.indexer = std::thread(&CorpusTextProvider::index, &corpus);
+}
+
+static inline bool isBlank(uchar c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void CorpusTextProvider::index(Corpus *corpus)
+{
+    // UTF-8 never has ASCII bytes inside multibyte sequences,
+    // so boundaries could be found without decoding
+    const uchar *data = corpus->data;
+    const u64 size = corpus->size;
+
+    std::vector<Span> &sentences = corpus->sentences;
+    sentences.reserve(size / 128);
+
+    u64 start = 0;
+    for(u64 i = 0; i<size; ++i) {
+        // every MiB, whatever byte is there
+        if((i & 0xFFFFF) == 0 && corpus->cancel) {
+            return;
+        }
+
+        const uchar c = data[i];
+
+        bool boundary = c == '\n';
+        if(c == '.' || c == '!' || c == '?') {
+            boundary = i+1 == size || isBlank(data[i+1]);
+        }
+
+        if(!boundary) {
+            continue;
+        }
+
+        while(start < i && isBlank(data[start])) {
+            ++start;
+        }
+
+        const u64 end = c == '\n' ? i : i+1;
+        if(end > start) {
+            const u64 length = end - start;
+            if(length >= MinSentenceBytes && length <= MaxSentenceBytes) {
+                sentences.push_back({start, static_cast<u32>(length)});
+            }
+        }
+
+        start = i+1;
+    }
+
+    sentences.shrink_to_fit();
+    corpus->ready = true;
+}
+
+bool CorpusTextProvider::sentence(LanguageContext language, const TextQuery &query, QString &out)
+{
+    const Corpus &corpus = language == LanguageContext::Rus ? m_rus : m_eng;
+
+    // index is immutable once ready
+    if(!corpus.ready || corpus.sentences.empty()) {
+        return false;
+    }
+
+    static std::mt19937 random(std::random_device{}());
+    std::uniform_int_distribution<size_t> pick(0, corpus.sentences.size()-1);
+
+    for(int tries = 0; tries<CorpusTries; ++tries) {
+        const Span &span = corpus.sentences[pick(random)];
+        const QString text = QString::fromUtf8(reinterpret_cast<const char *>(corpus.data + span.offset), span.length).simplified();
+
+        if(query.accepts(text)) {
+            out = text;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Rss
+
+static const u32 RssCacheMagic = 0x464E5452; // 'FNTR'
+static const int RssCacheVersion = 1;
+static const int RssDefaultTtl = 60*60;      // seconds
+
+static QString feedUrl(CStringRef key, const char *var, CStringRef fallback)
+{
+    const QString env = QString::fromLocal8Bit(qgetenv(var));
+    if(!env.isEmpty()) {
+        return env;
+    }
+
+    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
+    return fontaReg.value(key, fallback).toString();
+}
+
+RssTextProvider::RssTextProvider(QObject *parent)
+    : QObject(parent)
+{
+    m_eng.name = QStringLiteral("eng");
+    m_eng.url = feedUrl(QStringLiteral("RssEngUrl"), "FONTA_RSS_ENG", QStringLiteral("http://feeds.bbci.co.uk/news/world/rss.xml"));
+    m_eng.tag = QStringLiteral("description");
+
+    m_rus.name = QStringLiteral("rus");
+    m_rus.url = feedUrl(QStringLiteral("RssRusUrl"), "FONTA_RSS_RUS", QStringLiteral("http://tass.ru/rss/v2.xml"));
+    m_rus.tag = QStringLiteral("title");
+
+    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
+    const int ttl = fontaReg.value(QStringLiteral("RssTtl"), RssDefaultTtl).toInt();
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+
+    for(Feed *feed : {&m_eng, &m_rus}) {
+        loadCache(*feed);
+
+        if(feed->items.isEmpty() || !feed->fetched.isValid() || feed->fetched.secsTo(now) >= ttl) {
+            fetch(*feed);
+        }
+    }
+}
+
+RssTextProvider::~RssTextProvider()
+{
+    delete m_network;
+}
+
+bool RssTextProvider::enabled()
+{
+    if(!qgetenv("FONTA_OFFLINE").isEmpty()) {
+        return false;
+    }
+
+    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
+    return fontaReg.value(QStringLiteral("RssNews"), true).toBool();
+}
+
+bool RssTextProvider::sentence(LanguageContext language, const TextQuery &query, QString &out)
+{
+    if(language == LanguageContext::Rus) {
+        return pickFromList(m_rus.items, m_rusPool, query, out);
+    } else {
+        return pickFromList(m_eng.items, m_engPool, query, out);
+    }
+}
+
+void RssTextProvider::fetch(Feed &feed)
+{
+    if(!m_network) {
+        m_network = new QNetworkAccessManager;
+    }
+
+    QNetworkRequest request{QUrl(feed.url)};
+
+    // revalidate only what we really have
+    if(!feed.items.isEmpty()) {
+        if(!feed.etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", feed.etag.toLatin1());
+        }
+        if(!feed.lastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", feed.lastModified.toLatin1());
+        }
+    }
+
+    feed.xml.clear();
+    feed.fresh.clear();
+    feed.text.clear();
+    feed.inItem = false;
+    feed.inTag = false;
+
+    feed.started = trace::now();
+
+    QNetworkReply *reply = m_network->get(request);
+    m_replies[reply] = &feed;
+
+    QObject::connect(reply, SIGNAL(readyRead()), this, SLOT(readyReadSlot()));
+    QObject::connect(reply, SIGNAL(finished()), this, SLOT(finishedSlot()));
+}
+
+void RssTextProvider::readyReadSlot()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    Feed *feed = m_replies.value(reply);
+    if(!feed) {
+        return;
+    }
+
+    // 304 has no body worth parsing
+    if(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+        reply->readAll();
+        return;
+    }
+
+    feed->xml.addData(reply->readAll());
+    parse(*feed);
+}
+
+void RssTextProvider::parse(Feed &feed)
+{
+    FONTA_TRACE_SPAN("network", "rss.parse");
+
+    QXmlStreamReader &r = feed.xml;
+
+    while(!r.atEnd()) {
+        r.readNext();
+
+        switch(r.tokenType()) {
+            case QXmlStreamReader::StartElement: {
+                if(r.name() == QStringLiteral("item")) {
+                    feed.inItem = true;
+                } else if(feed.inItem && r.name() == feed.tag) {
+                    feed.inTag = true;
+                    feed.text.clear();
+                }
+            } break;
+            case QXmlStreamReader::Characters: {
+                if(feed.inTag) {
+                    feed.text += r.text();
+                }
+            } break;
+            case QXmlStreamReader::EndElement: {
+                if(feed.inTag && r.name() == feed.tag) {
+                    feed.inTag = false;
+                    const QString text = feed.text.simplified();
+                    if(!text.isEmpty()) {
+                        feed.fresh << text;
+                    }
+                } else if(r.name() == QStringLiteral("item")) {
+                    feed.inItem = false;
+                }
+            } break;
+            default: break;
+        }
+    }
+
+    // PrematureEndOfDocument just means that the rest is not here yet
+}
+
+void RssTextProvider::finishedSlot()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    Feed *feed = m_replies.take(reply);
+    reply->deleteLater();
+
+    if(!feed) {
+        return;
+    }
+
+    if(reply->error() != QNetworkReply::NoError) {
+        trace::complete("network", "rss.failed", feed->started);
+        return;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if(status == 304) {
+        trace::complete("network", "rss.revalidate", feed->started);
+        feed->fetched = QDateTime::currentDateTimeUtc();
+        saveCache(*feed);
+        return;
+    }
+
+    if(status != 200) {
+        return;
+    }
+
+    feed->xml.addData(reply->readAll());
+    parse(*feed);
+
+    trace::complete("network", "rss.fetch", feed->started);
+
+    if(feed->fresh.isEmpty()) {
+        return;
+    }
+
+    feed->items.swap(feed->fresh);
+    feed->fresh.clear();
+    feed->fetched = QDateTime::currentDateTimeUtc();
+    feed->etag = QString::fromLatin1(reply->rawHeader("ETag"));
+    feed->lastModified = QString::fromLatin1(reply->rawHeader("Last-Modified"));
+
+    (feed == &m_rus ? m_rusPool : m_engPool).clear();
+
+    saveCache(*feed);
+}
+
+QString RssTextProvider::cachePath(const Feed &feed)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/rss/") + feed.name + QStringLiteral(".dat");
+}
+
+void RssTextProvider::loadCache(Feed &feed)
+{
+    QFile file(cachePath(feed));
+    if(!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_6);
+
+    u32 magic = 0;
+    i32 version = 0;
+    QString url;
+    in >> magic >> version >> url;
+
+    // cache of another feed is useless
+    if(magic != RssCacheMagic || version != RssCacheVersion || url != feed.url) {
+        return;
+    }
+
+    QDateTime fetched;
+    QString etag;
+    QString lastModified;
+    QStringList items;
+    in >> fetched >> etag >> lastModified >> items;
+
+    if(in.status() != QDataStream::Ok) {
+        return;
+    }
+
+    feed.fetched = fetched;
+    feed.etag = etag;
+    feed.lastModified = lastModified;
+    feed.items = items;
+}
+
+void RssTextProvider::saveCache(const Feed &feed)
+{
+    const QString path = cachePath(feed);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if(!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_6);
+
+    out << RssCacheMagic << static_cast<i32>(RssCacheVersion) << feed.url;
+    out << feed.fetched << feed.etag << feed.lastModified << feed.items;
+
+    if(out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return;
+    }
+
+    file.commit();
+}
+
+} // namespace fonta
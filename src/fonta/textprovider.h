@@ -0,0 +1,162 @@
+#ifndef TEXTPROVIDER_H
+#define TEXTPROVIDER_H
+
+#include "types_fonta.h"
+#include <QObject>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QXmlStreamReader>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
+
+class QFont;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace fonta {
+
+int getPoolsValue(QSet<int>& pool, int length);
+
+//! Requirements for a sample sentence
+struct TextQuery {
+    int minLength {0};
+    int maxLength {std::numeric_limits<int>::max()};
+    std::function<bool(QChar)> covers; // empty means any character is fine
+
+    bool accepts(CStringRef text) const;
+
+    //! sentence of moderate length that could be rendered with the font
+    static TextQuery forFont(const QFont &font);
+};
+
+//! Source of sample sentences for Sampler
+class TextProvider
+{
+public:
+    virtual ~TextProvider() {}
+    virtual bool sentence(LanguageContext language, const TextQuery &query, QString &out) = 0;
+};
+
+//! Few hard-coded sentences. Always available, used as the last resort.
+class BuiltinTextProvider : public TextProvider
+{
+public:
+    bool sentence(LanguageContext language, const TextQuery &query, QString &out) override;
+
+private:
+    static const QStringList textsEng;
+    static const QStringList textsRus;
+
+    QSet<int> m_engPool;
+    QSet<int> m_rusPool;
+};
+
+/*
+ * Local UTF-8 text corpus: corpus/en.txt and corpus/ru.txt looked up in
+ * "CorpusPath" setting, next to executable and in application data dir.
+ * Files are memory-mapped and sentence boundaries are indexed once in
+ * background, so provider works offline and starts instantly.
+ */
+class CorpusTextProvider : public TextProvider
+{
+public:
+    CorpusTextProvider();
+    ~CorpusTextProvider();
+
+    bool isEmpty() const;
+    bool sentence(LanguageContext language, const TextQuery &query, QString &out) override;
+
+private:
+    struct Span {
+        u64 offset;
+        u32 length;
+    };
+
+    struct Corpus {
+        QFile file;
+        const uchar *data {nullptr};
+        qint64 size {0};
+        std::vector<Span> sentences;
+        std::atomic<bool> ready {false};
+        std::atomic<bool> cancel {false};
+        std::thread indexer;
+    };
+
+    Corpus m_eng;
+    Corpus m_rus;
+
+    static void open(Corpus &corpus, CStringRef fileName);
+    static void index(Corpus *corpus);
+};
+
+/*
+ * News fetched from RSS feeds. Optional: disabled by "RssNews" setting or FONTA_OFFLINE variable.
+ *
+ * Parsed items are cached on disk, so they are served right at startup.
+ * Cache younger than "RssTtl" seconds is used as is, older one is revalidated
+ * with ETag/Last-Modified. Replies are parsed as they arrive.
+ * Feed urls could be overridden with "RssEngUrl"/"RssRusUrl" settings or
+ * FONTA_RSS_ENG/FONTA_RSS_RUS variables (e.g. to point to rss_stub tool).
+ */
+class RssTextProvider : public QObject, public TextProvider
+{
+    Q_OBJECT
+
+public:
+    explicit RssTextProvider(QObject *parent = 0);
+    ~RssTextProvider();
+
+    static bool enabled();
+
+    bool sentence(LanguageContext language, const TextQuery &query, QString &out) override;
+
+private slots:
+    void readyReadSlot();
+    void finishedSlot();
+
+private:
+    struct Feed {
+        QString name;
+        QString url;
+        QString tag;
+
+        // cached
+        QStringList items;
+        QDateTime fetched;
+        QString etag;
+        QString lastModified;
+
+        // in flight
+        QXmlStreamReader xml;
+        QStringList fresh;
+        QString text;
+        bool inItem {false};
+        bool inTag {false};
+        i64 started {0}; // trace::now() of request
+    };
+
+    QNetworkAccessManager *m_network {nullptr};
+    QHash<QNetworkReply *, Feed *> m_replies;
+
+    Feed m_eng;
+    Feed m_rus;
+    QSet<int> m_engPool;
+    QSet<int> m_rusPool;
+
+    void fetch(Feed &feed);
+    void parse(Feed &feed);
+
+    static QString cachePath(const Feed &feed);
+    static void loadCache(Feed &feed);
+    static void saveCache(const Feed &feed);
+};
+
+} // namespace fonta
+
+#endif // TEXTPROVIDER_H
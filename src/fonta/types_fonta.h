@@ -15,6 +15,22 @@ enum_class (FilterMode) {
     Script,
     Decorative,
     Symbolic,
+    Greek,
+    Armenian,
+    Hebrew,
+    Arabic,
+    Devanagari,
+    Thai,
+    Georgian,
+    Chinese,
+    Japanese,
+    Korean,
+    Light,
+    Bold,
+    Condensed,
+    Expanded,
+    Italic,
+    Variable,
     End,
     Custom = End
 
@@ -30,6 +46,22 @@ enum_class (FilterMode) {
         case Script:        return QApplication::translate("FilterMode", "Script");        break;
         case Decorative:    return QApplication::translate("FilterMode", "Decorative");    break;
         case Symbolic:      return QApplication::translate("FilterMode", "Symbolic");      break;
+        case Greek:         return QApplication::translate("FilterMode", "Greek");         break;
+        case Armenian:      return QApplication::translate("FilterMode", "Armenian");      break;
+        case Hebrew:        return QApplication::translate("FilterMode", "Hebrew");        break;
+        case Arabic:        return QApplication::translate("FilterMode", "Arabic");        break;
+        case Devanagari:    return QApplication::translate("FilterMode", "Devanagari");    break;
+        case Thai:          return QApplication::translate("FilterMode", "Thai");          break;
+        case Georgian:      return QApplication::translate("FilterMode", "Georgian");      break;
+        case Chinese:       return QApplication::translate("FilterMode", "Chinese");       break;
+        case Japanese:      return QApplication::translate("FilterMode", "Japanese");      break;
+        case Korean:        return QApplication::translate("FilterMode", "Korean");        break;
+        case Light:         return QApplication::translate("FilterMode", "Light");         break;
+        case Bold:          return QApplication::translate("FilterMode", "Bold");          break;
+        case Condensed:     return QApplication::translate("FilterMode", "Condensed");     break;
+        case Expanded:      return QApplication::translate("FilterMode", "Expanded");      break;
+        case Italic:        return QApplication::translate("FilterMode", "Italic");        break;
+        case Variable:      return QApplication::translate("FilterMode", "Variable");      break;
         }
     }
 };
@@ -1,8 +1,12 @@
 #include "about.h"
 #include "types_fonta.h"
+#include "fontadb.h"
 
+#include <QFileDialog>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QMessageBox>
+#include <QPlainTextEdit>
 #include <QPushButton>
 #include <QVersionNumber>
 
@@ -24,6 +28,14 @@ About::About(const QVersionNumber& version, QWidget *parent) :
     auto vSpacer2 = new QSpacerItem(20, 40, QSizePolicy::Minimum, QSizePolicy::Expanding);
     vLayout->addItem(vSpacer2);
 
+    m_report = new QPlainTextEdit(this);
+    m_report->setReadOnly(true);
+    m_report->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_report->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_report->setMinimumSize(560, 320);
+    m_report->hide();
+    vLayout->addWidget(m_report);
+
     auto hLayout = new QHBoxLayout();
     auto horizontalSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
     hLayout->addItem(horizontalSpacer);
@@ -32,6 +44,16 @@ About::About(const QVersionNumber& version, QWidget *parent) :
     pushButton->setObjectName(QStringLiteral("pushButton"));
     hLayout->addWidget(pushButton);
 
+    auto reportButton = new QPushButton(this);
+    reportButton->setObjectName(QStringLiteral("reportButton"));
+    reportButton->setCheckable(true);
+    hLayout->addWidget(reportButton);
+
+    m_exportButton = new QPushButton(this);
+    m_exportButton->setObjectName(QStringLiteral("exportButton"));
+    m_exportButton->hide();
+    hLayout->addWidget(m_exportButton);
+
     auto hSpacer2 = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
     hLayout->addItem(hSpacer2);
     vLayout->addLayout(hLayout);
@@ -42,6 +64,8 @@ About::About(const QVersionNumber& version, QWidget *parent) :
     setWindowTitle(tr("About"));
     label->setText(tr("Fonta v. %1").arg(version.toString()));
     pushButton->setText(tr("OK"));
+    reportButton->setText(tr("Scan Report"));
+    m_exportButton->setText(tr("Export..."));
 
     QMetaObject::connectSlotsByName(this);
 }
@@ -55,4 +79,29 @@ void About::on_pushButton_clicked()
     hide();
 }
 
+void About::on_reportButton_clicked()
+{
+    const bool show = m_report->isHidden();
+    if(show) {
+        // report could change after rescan, so it is taken every time
+        m_report->setPlainText(fontaDB().scanReport().toText() + '\n' + fontaDB().lookupReport());
+    }
+
+    m_report->setVisible(show);
+    m_exportButton->setVisible(show && !fontaDB().scanReport().isEmpty());
+    adjustSize();
+}
+
+void About::on_exportButton_clicked()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Export Scan Report"), QStringLiteral("scan_report.json"), tr("JSON (*.json)"));
+    if(fileName.isEmpty()) {
+        return;
+    }
+
+    if(!fontaDB().scanReport().save(fileName)) {
+        QMessageBox::warning(this, tr("Export Scan Report"), tr("Couldn't write %1").arg(fileName));
+    }
+}
+
 } // namespace fonta
@@ -4,6 +4,8 @@
 #include <QDialog>
 
 class QVersionNumber;
+class QPlainTextEdit;
+class QPushButton;
 
 namespace fonta {
 
@@ -17,6 +19,12 @@ public:
 
 private slots:
     void on_pushButton_clicked();
+    void on_reportButton_clicked();
+    void on_exportButton_clicked();
+
+private:
+    QPlainTextEdit *m_report;
+    QPushButton *m_exportButton;
 };
 
 } // namespace fonta
@@ -5,9 +5,12 @@
 #include "sampler.h"
 #include "fontadb.h"
 #include "loremgenerator.h"
+#include "trace.h"
+#include "fontafile.h"
 
 #include <QHBoxLayout>
 #include <QJsonObject>
+#include <QDataStream>
 #include <QScrollBar>
 #include <QTimerEvent>
 #include <QMenu>
@@ -178,12 +181,50 @@ StyleSheet& Field::sheet() const
 void Field::applySheet()
 {
     setStyleSheet(m_sheet.get());
+
+    emit modified();
+}
+
+static TextQuery sampleQuery(const QFont &font)
+{
+    TextQuery query = TextQuery::forFont(font);
+    query.minLength = 20;
+    query.maxLength = 200;
+
+    return query;
 }
 
 void Field::fetchSamples()
 {
-    m_engText = Sampler::instance()->getEngText(m_contentMode);
-    m_rusText = Sampler::instance()->getRusText(m_contentMode);
+    const TextQuery query = sampleQuery(font());
+
+    m_engText = Sampler::instance()->getEngText(m_contentMode, query);
+    m_rusText = Sampler::instance()->getRusText(m_contentMode, query);
+}
+
+void Field::fetchCoveredSamples()
+{
+    if(m_contentMode != ContentMode::News) {
+        return;
+    }
+
+    // replace only sentences the new font can't render, and only with ones it can
+    const TextQuery covered = TextQuery::forFont(font());
+    const TextQuery query = sampleQuery(font());
+
+    if(!covered.accepts(m_engText)) {
+        QString text = Sampler::instance()->getEngText(m_contentMode, query);
+        if(query.accepts(text)) {
+            m_engText = text;
+        }
+    }
+
+    if(!covered.accepts(m_rusText)) {
+        QString text = Sampler::instance()->getRusText(m_contentMode, query);
+        if(query.accepts(text)) {
+            m_rusText = text;
+        }
+    }
 }
 
 static QString truncWord(CStringRef str)
@@ -197,18 +238,42 @@ static QString truncWord(CStringRef str)
     }
 }
 
+// cmap tells for sure, OS/2 Cyrillic bits are the fallback for fonts without one
+static bool rendersRussian(CStringRef family)
+{
+    // sorted, as Coverage::containsAll() wants
+    static const QVector<u32> alphabet = [] {
+        QVector<u32> points;
+        points << 0x0401; // Ё
+        for(u32 c = 0x0410; c<=0x044F; ++c) {
+            points << c;  // А..я
+        }
+        points << 0x0451; // ё
+        return points;
+    }();
+
+    const Coverage &coverage = fontaDB().coverage(family);
+    if(coverage.isEmpty()) {
+        return fontaDB().isCyrillic(family);
+    }
+
+    return coverage.containsAll(alphabet);
+}
+
 void Field::updateText()
 {
     if(m_contentMode == ContentMode::UserDefined) {
         return;
     }
 
+    FONTA_TRACE_SPAN("relayout", "Field::updateText");
+
     QString text;
 
     switch(m_languageContext) {
         default:
         case LanguageContext::Auto: {
-            bool cyr = fontaDB().isCyrillic(fontFamily());
+            bool cyr = rendersRussian(fontFamily());
             text = cyr ? m_rusText : m_engText;
         } break;
         case LanguageContext::Eng: text = m_engText; break;
@@ -230,12 +295,14 @@ void Field::updateLoremText()
         return;
     }
 
+    FONTA_TRACE_SPAN("relayout", "Field::updateLoremText");
+
     QString text;
 
     switch(m_languageContext) {
         default:
         case LanguageContext::Auto: {
-            bool cyr = fontaDB().isCyrillic(fontFamily());
+            bool cyr = rendersRussian(fontFamily());
             text = cyr ? m_rusText : m_engText;
         } break;
         case LanguageContext::Eng: text = m_engText; break;
@@ -334,7 +401,10 @@ void Field::setFontFamily(CStringRef family)
         setFontStyle(s.at(0));
     }
 
+    fetchCoveredSamples();
     updateText();
+
+    emit modified();
 }
 
 void Field::setFontSize(float size)
@@ -347,13 +417,15 @@ void Field::setFontSize(float size)
 
     setFont(newFont);
     updateLoremText();
+
+    emit modified();
 }
 
 void Field::setFontStyle(CStringRef style)
 {
     const QFont& f = font();
 
-    QFont newFont = qtDB().font(f.family(), style, f.pointSize());
+    QFont newFont = fontaDB().font(f.family(), style, f.pointSize());
 
     float px = pt2px(newFont.pointSize())/1000.0f*(float)m_tracking;
     newFont.setLetterSpacing(QFont::AbsoluteSpacing, px);
@@ -361,6 +433,8 @@ void Field::setFontStyle(CStringRef style)
     setFont(newFont);
     m_fontStyle = style;
     updateLoremText();
+
+    emit modified();
 }
 
 void Field::setPreferableFontStyle(CStringRef style)
@@ -373,6 +447,8 @@ void Field::alignText(Qt::Alignment alignment)
 {
     m_alignment = alignment;
     alignTextHorizontally(alignment);
+
+    emit modified();
 }
 
 void Field::alignTextHorizontally(Qt::Alignment alignment)
@@ -390,6 +466,8 @@ void Field::setLeading(float val)
     m_leading = val;
     updateLoremText();
     updateLeading();
+
+    emit modified();
 }
 
 void Field::updateLeading()
@@ -417,6 +495,8 @@ void Field::setTracking(int val)
 
     setFont(newFont);
     updateLoremText();
+
+    emit modified();
 }
 
 void Field::setContentMode(ContentMode mode)
@@ -448,23 +528,66 @@ void Field::save(QJsonObject &json) const
 
 void Field::load(const QJsonObject &json)
 {
-    QString family = json[QLatin1String("family")].toString(QStringLiteral("Arial"));
-    double size = json[QLatin1String("size")].toDouble(12.0);
-    QString style = json[QLatin1String("style")].toString(QStringLiteral("Normal"));
+    restore(json[QLatin1String("family")].toString(QStringLiteral("Arial")),
+            json[QLatin1String("style")].toString(QStringLiteral("Normal")),
+            json[QLatin1String("size")].toDouble(12.0),
+            json[QLatin1String("text")].toString(QStringLiteral("The quick brown fox jumped over the lazy dog")),
+            json[QLatin1String("alignment")].toInt(1),
+            json[QLatin1String("leading")].toDouble(inf()),
+            json[QLatin1String("tracking")].toInt(0),
+            json[QLatin1String("textColor")].toString(),
+            json[QLatin1String("backgroundColor")].toString());
+}
+
+void Field::save(QDataStream &out) const
+{
+    out << data();
+}
+
+void Field::load(QDataStream &in)
+{
+    FieldData f;
+    f.leading = inf();
+    in >> f;
+
+    restore(f.family, f.style, f.size, f.text, f.alignment, f.leading, f.tracking, f.textColor, f.backgroundColor);
+}
+
+FieldData Field::data() const
+{
+    const QFont& f = font();
+
+    FieldData d;
+    d.family = f.family();
+    d.style = fontStyle();
+    d.size = f.pointSizeF();
+    d.leading = leading();
+    d.tracking = static_cast<i32>(tracking());
+    d.alignment = static_cast<i32>(textAlignment());
+    d.text = toPlainText();
+    d.textColor = sheet()[QStringLiteral("color")];
+    d.backgroundColor = sheet()[QStringLiteral("background-color")];
 
+    return d;
+}
+
+void Field::restore(CStringRef family, CStringRef style, double size,
+                    CStringRef text, int alignment, float leading, int tracking,
+                    CStringRef textColor, CStringRef backgroundColor)
+{
     setPreferableFontStyle(style);
 
-    QFont newFont = qtDB().font(family, style, size); // requires int size
+    QFont newFont = fontaDB().font(family, style, size); // requires int size
     newFont.setPointSizeF(size);                      // set double size
     setFont(newFont);
 
-    setText(json[QLatin1String("text")].toString(QStringLiteral("The quick brown fox jumped over the lazy dog")));
-    alignText(static_cast<Qt::Alignment>(json[QLatin1String("alignment")].toInt(1)));
-    setLeading(json[QLatin1String("leading")].toDouble(inf()));
-    setTracking(json[QLatin1String("tracking")].toInt(0));
+    setText(text);
+    alignText(static_cast<Qt::Alignment>(alignment));
+    setLeading(leading);
+    setTracking(tracking);
 
-    sheet().set(QStringLiteral("color"), json[QLatin1String("textColor")].toString());
-    sheet().set(QStringLiteral("background-color"), json[QLatin1String("backgroundColor")].toString());
+    sheet().set(QStringLiteral("color"), textColor);
+    sheet().set(QStringLiteral("background-color"), backgroundColor);
     applySheet();
 
     m_contentMode = ContentMode::UserDefined;
@@ -6,9 +6,12 @@
 #include <QTextEdit>
 
 class QHBoxLayout;
+class QDataStream;
 
 namespace fonta {
 
+struct FieldData;
+
 class WorkArea;
 class TooglePanel;
 
@@ -58,11 +61,15 @@ public:
 
     void save(QJsonObject &json) const;
     void load(const QJsonObject &json);
+    void save(QDataStream &out) const;
+    void load(QDataStream &in);
+    FieldData data() const;
 
 signals:
     void focussed();
     void contentBecameUserDefined();
     void swapRequested();
+    void modified();
 
 public slots:
     void showContextMenu(const QPoint &point);
@@ -95,7 +102,11 @@ private:
     TooglePanel* m_tooglePanel;
 
     void updateLeading();
+    void fetchCoveredSamples();
     void alignTextHorizontally(Qt::Alignment alignment);
+    void restore(CStringRef family, CStringRef style, double size,
+                 CStringRef text, int alignment, float leading, int tracking,
+                 CStringRef textColor, CStringRef backgroundColor);
 };
 
 } // namespace fonta
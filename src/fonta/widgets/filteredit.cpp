@@ -1,5 +1,6 @@
 #include "filteredit.h"
 #include "types.h"
+#include "fontadb.h"
 
 #include <QKeyEvent>
 #include <QListWidget>
@@ -61,6 +62,24 @@ void FilterEdit::suppose(QChar typed)
 void FilterEdit::apply()
 {
     QList<QListWidgetItem*> items = m_listWidget->findItems(text(), Qt::MatchExactly);
+
+    // localized, typographic, full or PostScript name, then any name containing text
+    if(items.isEmpty()) {
+        QStringList candidates = fontaDB().searchFamilies(text());
+        const QString resolved = fontaDB().resolveFamily(text());
+        if(!resolved.isNull()) {
+            candidates.prepend(resolved);
+        }
+
+        for(CStringRef family : std::as_const(candidates)) {
+            items = m_listWidget->findItems(family, Qt::MatchExactly);
+            if(!items.isEmpty()) {
+                setText(family);
+                break;
+            }
+        }
+    }
+
     if(items.size() > 0) {
         m_listWidget->setCurrentItem(items[0]);
         m_listWidget->scrollToItem(items[0], QAbstractItemView::PositionAtCenter);
@@ -1,6 +1,7 @@
 #include "workarea.h"
 
 #include "sampler.h"
+#include "fontafile.h"
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -218,4 +219,54 @@ void WorkArea::load(const QJsonObject &json)
     setSizes(sizesList);
 }
 
+void WorkArea::save(TabData &tab) const
+{
+    QVector<FieldData> fields;
+    save(tab, fields);
+
+    tab.fields.reserve(fields.size());
+    for(const FieldData &field : std::as_const(fields)) {
+        QByteArray bytes;
+        QDataStream out(&bytes, QIODevice::WriteOnly);
+        out.setVersion(FontaFile::StreamVersion);
+        out << field;
+        tab.fields << bytes;
+    }
+}
+
+void WorkArea::save(TabData &tab, QVector<FieldData> &fields) const
+{
+    tab.name = name();
+    tab.currField = m_currField ? m_currField->id() : 0;
+    tab.sizes = sizes();
+    tab.fields.clear();
+
+    fields.clear();
+    fields.reserve(m_fields.size());
+    for(auto field : m_fields) {
+        fields << field->data();
+    }
+}
+
+void WorkArea::load(const TabData &tab)
+{
+    clear();
+
+    m_name = tab.name;
+
+    for(const QByteArray &bytes : tab.fields) {
+        QDataStream in(bytes);
+        in.setVersion(FontaFile::StreamVersion);
+
+        Field* field = addField(InitType::Empty);
+        field->load(in);
+    }
+
+    if(m_fields.length()) {
+        m_currField = m_fields.at(qBound(0, tab.currField, m_fields.length()-1));
+    }
+
+    setSizes(tab.sizes);
+}
+
 } // namespace fonta
@@ -7,6 +7,9 @@
 
 namespace fonta {
 
+struct TabData;
+struct FieldData;
+
 class WorkArea : public QSplitter {
 
     Q_OBJECT
@@ -40,6 +43,10 @@ public:
 
     void save(QJsonObject &json) const;
     void load(const QJsonObject &json);
+    void save(TabData &tab) const;
+    //! tab state without encoding fields, they are returned as plain values
+    void save(TabData &tab, QVector<FieldData> &fields) const;
+    void load(const TabData &tab);
 
 private:
     void loadSample(CStringRef jsonTxt);
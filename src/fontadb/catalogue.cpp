@@ -0,0 +1,765 @@
+#include "catalogue.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace fonta {
+
+u32 StringPool::add(CStringRef s)
+{
+    auto it = m_ids.constFind(s);
+    if(it != m_ids.constEnd()) {
+        return *it;
+    }
+
+    const u32 id = count();
+    m_chars += s;
+    m_offsets << m_chars.size();
+    m_ids.insert(s, id);
+
+    return id;
+}
+
+void StringPool::squeeze()
+{
+    m_ids = QHash<QString, u32>();
+    m_chars.squeeze();
+    m_offsets.squeeze();
+}
+
+qint64 StringPool::bytes() const
+{
+    return m_chars.capacity()*sizeof(QChar) + m_offsets.capacity()*sizeof(u32);
+}
+
+namespace {
+
+struct FilePath {
+    QString dir;  // with trailing slash, shared by files of directory
+    QString name;
+
+    explicit FilePath(CStringRef path) {
+        const int slash = path.lastIndexOf('/') + 1;
+        dir = path.left(slash);
+        name = path.mid(slash);
+    }
+
+    bool operator<(const FilePath &other) const {
+        const int c = dir.compare(other.dir);
+        return c != 0 ? c < 0 : name < other.name;
+    }
+    bool operator==(const FilePath &other) const { return dir == other.dir && name == other.name; }
+};
+
+template <typename T>
+qint64 vectorBytes(const QVector<T> &v)
+{
+    return v.capacity()*sizeof(T);
+}
+
+} // namespace
+
+Catalogue::Catalogue(const TTFMap &TTFs)
+{
+    FONTA_TRACE_SPAN("catalogue", "build");
+
+    // sorted by family, so that lookup is binary search
+    QVector<const TTFMap::value_type *> fonts;
+    fonts.reserve(static_cast<int>(TTFs.size()));
+    for(cauto pair : TTFs) {
+        fonts << &pair;
+    }
+    std::sort(fonts.begin(), fonts.end(), [](const TTFMap::value_type *a, const TTFMap::value_type *b) {
+        return a->first < b->first;
+    });
+
+    // sorted by directory and name
+    std::vector<FilePath> paths;
+    for(cauto pair : TTFs) {
+        for(CStringRef file : pair.second.files) {
+            paths.emplace_back(file);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    QHash<QString, Id> fileIds;
+    fileIds.reserve(static_cast<int>(paths.size()));
+
+    m_dir.reserve(static_cast<int>(paths.size()));
+    m_fileName.reserve(static_cast<int>(paths.size()));
+    for(const FilePath &path : paths) {
+        fileIds.insert(path.dir + path.name, m_fileName.size());
+        m_dir << m_strings.add(path.dir);
+        m_fileName << m_strings.add(path.name);
+    }
+
+    const int count = fonts.size();
+    m_family.reserve(count);
+    m_familyClass.reserve(count);
+    m_familySubClass.reserve(count);
+    m_flags.reserve(count);
+    m_panose.reserve(count);
+    m_unicodeRange.reserve(4*count);
+    m_codePageRange.reserve(2*count);
+    m_coverage.reserve(count);
+    m_faceStart.reserve(count + 1);
+    m_axisStart.reserve(count + 1);
+    m_nameStart.reserve(count + 1);
+    m_fileStart.reserve(count + 1);
+
+    // file -> fonts is inverse of font -> files, counted first
+    QVector<u32> fontsPerFile(m_fileName.size() + 1, 0);
+
+    for(const TTFMap::value_type *pair : std::as_const(fonts)) {
+        const TTF &ttf = pair->second;
+
+        m_family << m_strings.add(pair->first);
+        m_familyClass << static_cast<u8>(ttf.familyClass);
+        m_familySubClass << static_cast<u8>(ttf.familySubClass);
+        m_flags << static_cast<u8>((ttf.latin ? Latin : 0)
+                                 | (ttf.cyrillic ? Cyrillic : 0)
+                                 | (ttf.monospaced ? Monospaced : 0)
+                                 | (ttf.symbolic ? Symbolic : 0)
+                                 | (ttf.valid ? Valid : 0));
+        m_panose << ttf.panose;
+        m_unicodeRange << ttf.unicodeRange[0] << ttf.unicodeRange[1] << ttf.unicodeRange[2] << ttf.unicodeRange[3];
+        m_codePageRange << ttf.codePageRange[0] << ttf.codePageRange[1];
+        m_coverage << ttf.coverage;
+
+        m_faceStart << m_faceStyle.size();
+        for(const FontFace &face : ttf.faces) {
+            m_faceStyle << m_strings.add(face.style);
+            m_faceWeight << face.weight;
+            m_faceWidth << static_cast<u8>(face.width);
+            m_faceSelection << face.selection;
+            m_faceItalicAngle << face.italicAngle;
+            m_faceInstance << face.instance;
+            m_faceCoordStart << m_faceCoords.size();
+            m_faceCoords << face.coordinates;
+        }
+
+        m_axisStart << m_axisTag.size();
+        for(const FontAxis &axis : ttf.axes) {
+            m_axisTag << axis.tag;
+            m_axisMin << axis.min;
+            m_axisDef << axis.def;
+            m_axisMax << axis.max;
+            m_axisName << m_strings.add(axis.name);
+        }
+
+        m_nameStart << m_name.size();
+        for(const FontName &n : ttf.names) {
+            m_name << m_strings.add(n.name);
+            m_nameId << static_cast<u8>(n.id);
+            m_namePlatform << static_cast<u8>(n.platform);
+            m_nameLanguage << n.language;
+        }
+
+        m_fileStart << m_files.size();
+        QVector<Id> files;
+        files.reserve(ttf.files.size());
+        for(CStringRef file : ttf.files) {
+            files << fileIds.value(file);
+        }
+        std::sort(files.begin(), files.end());
+        for(Id file : std::as_const(files)) {
+            m_files << file;
+            ++fontsPerFile[file + 1];
+        }
+    }
+    m_faceStart << m_faceStyle.size();
+    m_faceCoordStart << m_faceCoords.size();
+    m_axisStart << m_axisTag.size();
+    m_nameStart << m_name.size();
+    m_fileStart << m_files.size();
+
+    for(int i = 1; i<fontsPerFile.size(); ++i) {
+        fontsPerFile[i] += fontsPerFile[i-1];
+    }
+    m_fontStart = fontsPerFile;
+    m_fonts.resize(m_files.size());
+
+    // fonts are visited in id order, so fonts of every file come out sorted
+    QVector<u32> next = fontsPerFile;
+    for(Id font = 0; font<count; ++font) {
+        for(u32 i = m_fileStart.at(font); i<m_fileStart.at(font+1); ++i) {
+            m_fonts[next[m_files.at(i)]++] = font;
+        }
+    }
+
+    buildNameIndex();
+
+    m_strings.squeeze();
+    m_faceStyle.squeeze();
+    m_faceWeight.squeeze();
+    m_faceWidth.squeeze();
+    m_faceSelection.squeeze();
+    m_faceItalicAngle.squeeze();
+    m_faceInstance.squeeze();
+    m_faceCoordStart.squeeze();
+    m_faceCoords.squeeze();
+    m_axisTag.squeeze();
+    m_axisMin.squeeze();
+    m_axisDef.squeeze();
+    m_axisMax.squeeze();
+    m_axisName.squeeze();
+    m_files.squeeze();
+    m_name.squeeze();
+    m_nameId.squeeze();
+    m_namePlatform.squeeze();
+    m_nameLanguage.squeeze();
+
+    buildComponents();
+    buildScripts();
+
+    trace::counter("catalogue", "bytes", memory().total());
+}
+
+void Catalogue::unpack(TTFMap &TTFs, File2FontsMap &File2Fonts) const
+{
+    TTFs.clear();
+    File2Fonts.clear();
+
+    TTFs.reserve(fontsCount());
+    File2Fonts.reserve(filesCount());
+
+    for(Id font = 0; font<fontsCount(); ++font) {
+        const QString name = family(font);
+
+        TTF ttf;
+        static_cast<FontTraits &>(ttf) = traits(font);
+        ttf.faces = faces(font);
+        ttf.axes = axes(font);
+        ttf.coverage = m_coverage.at(font);
+        ttf.names = names(font);
+
+        for(u32 i = m_fileStart.at(font); i<m_fileStart.at(font+1); ++i) {
+            const QString path = filePath(m_files.at(i));
+            ttf.files << path;
+            File2Fonts[path] << name;
+        }
+
+        TTFs.emplace(name, std::move(ttf));
+    }
+}
+
+Catalogue::Id Catalogue::font(CStringRef family) const
+{
+    const QStringView key(family);
+    auto it = std::lower_bound(m_family.cbegin(), m_family.cend(), key, [this](u32 name, QStringView key) {
+        return m_strings.view(name) < key;
+    });
+
+    if(it == m_family.cend() || m_strings.view(*it) != key) {
+        return null;
+    }
+
+    return static_cast<Id>(it - m_family.cbegin());
+}
+
+Catalogue::Id Catalogue::file(CStringRef path) const
+{
+    const int slash = path.lastIndexOf('/') + 1;
+    const QStringView dir = QStringView(path).left(slash);
+    const QStringView name = QStringView(path).mid(slash);
+
+    // directory and name columns are sorted together
+    Id lo = 0;
+    Id hi = filesCount();
+    while(lo < hi) {
+        const Id mid = lo + (hi - lo)/2;
+        int c = m_strings.view(m_dir.at(mid)).compare(dir);
+        if(c == 0) {
+            c = m_strings.view(m_fileName.at(mid)).compare(name);
+        }
+
+        if(c == 0) {
+            return mid;
+        }
+
+        if(c < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return null;
+}
+
+QString Catalogue::filePath(Id file) const
+{
+    const QStringView dir = m_strings.view(m_dir.at(file));
+    const QStringView name = m_strings.view(m_fileName.at(file));
+
+    QString path;
+    path.reserve(static_cast<int>(dir.size() + name.size()));
+    path.append(dir.data(), static_cast<int>(dir.size()));
+    path.append(name.data(), static_cast<int>(name.size()));
+    return path;
+}
+
+FontTraits Catalogue::traits(Id font) const
+{
+    FontTraits t;
+    if(font == null) {
+        return t;
+    }
+
+    const u8 flags = m_flags.at(font);
+    t.familyClass = static_cast<FamilyClass::type>(m_familyClass.at(font));
+    t.familySubClass = m_familySubClass.at(font);
+    t.latin = flags & Latin;
+    t.cyrillic = flags & Cyrillic;
+    t.monospaced = flags & Monospaced;
+    t.symbolic = flags & Symbolic;
+    t.valid = flags & Valid;
+    t.panose = m_panose.at(font);
+    for(int i = 0; i<4; ++i) {
+        t.unicodeRange[i] = m_unicodeRange.at(4*font + i);
+    }
+    for(int i = 0; i<2; ++i) {
+        t.codePageRange[i] = m_codePageRange.at(2*font + i);
+    }
+
+    return t;
+}
+
+QStringList Catalogue::styles(Id font) const
+{
+    QStringList list;
+    for(u32 i = m_faceStart.at(font); i<m_faceStart.at(font+1); ++i) {
+        if(!m_strings.view(m_faceStyle.at(i)).isEmpty()) {
+            list << m_strings.at(m_faceStyle.at(i));
+        }
+    }
+    return list;
+}
+
+FontFace Catalogue::face(Id font, int face) const
+{
+    const u32 i = m_faceStart.at(font) + face;
+
+    FontFace f;
+    f.style = m_strings.at(m_faceStyle.at(i));
+    f.weight = m_faceWeight.at(i);
+    f.width = m_faceWidth.at(i);
+    f.selection = m_faceSelection.at(i);
+    f.italicAngle = m_faceItalicAngle.at(i);
+    f.instance = m_faceInstance.at(i);
+    for(u32 c = m_faceCoordStart.at(i); c<m_faceCoordStart.at(i+1); ++c) {
+        f.coordinates << m_faceCoords.at(c);
+    }
+    return f;
+}
+
+QVector<FontFace> Catalogue::faces(Id font) const
+{
+    QVector<FontFace> list;
+    for(int i = 0; i<facesCount(font); ++i) {
+        list << face(font, i);
+    }
+    return list;
+}
+
+int Catalogue::face(Id font, CStringRef style) const
+{
+    const QStringView key(style);
+    for(u32 i = m_faceStart.at(font); i<m_faceStart.at(font+1); ++i) {
+        if(m_strings.view(m_faceStyle.at(i)).compare(key, Qt::CaseInsensitive) == 0) {
+            return static_cast<int>(i - m_faceStart.at(font));
+        }
+    }
+    return -1;
+}
+
+bool Catalogue::hasWeight(Id font, int min, int max) const
+{
+    for(u32 i = m_faceStart.at(font); i<m_faceStart.at(font+1); ++i) {
+        if(m_faceWeight.at(i) >= min && m_faceWeight.at(i) <= max) {
+            return true;
+        }
+    }
+    return hasAxis(font, FontAxis::Weight, min, max);
+}
+
+bool Catalogue::hasWidth(Id font, int min, int max) const
+{
+    for(u32 i = m_faceStart.at(font); i<m_faceStart.at(font+1); ++i) {
+        if(m_faceWidth.at(i) >= min && m_faceWidth.at(i) <= max) {
+            return true;
+        }
+    }
+    return hasAxis(font, FontAxis::Width, FontFace::stretch(min), FontFace::stretch(max));
+}
+
+bool Catalogue::hasItalic(Id font) const
+{
+    for(u32 i = m_faceStart.at(font); i<m_faceStart.at(font+1); ++i) {
+        if((m_faceSelection.at(i) & (FontFace::Italic | FontFace::Oblique)) || m_faceItalicAngle.at(i) != 0) {
+            return true;
+        }
+    }
+    return hasAxis(font, FontAxis::Italic, 0.5, 1) || hasAxis(font, FontAxis::Slant, -90, -0.5);
+}
+
+QVector<FontAxis> Catalogue::axes(Id font) const
+{
+    QVector<FontAxis> list;
+    for(u32 i = m_axisStart.at(font); i<m_axisStart.at(font+1); ++i) {
+        FontAxis a;
+        a.tag = m_axisTag.at(i);
+        a.min = m_axisMin.at(i);
+        a.def = m_axisDef.at(i);
+        a.max = m_axisMax.at(i);
+        a.name = m_strings.at(m_axisName.at(i));
+        list << a;
+    }
+    return list;
+}
+
+bool Catalogue::hasAxis(Id font, u32 tag, double min, double max) const
+{
+    for(u32 i = m_axisStart.at(font); i<m_axisStart.at(font+1); ++i) {
+        if(m_axisTag.at(i) == tag) {
+            return m_axisMax.at(i) / 65536.0 >= min && m_axisMin.at(i) / 65536.0 <= max;
+        }
+    }
+    return false;
+}
+
+QStringList Catalogue::files(Id font) const
+{
+    QStringList list;
+    for(u32 i = m_fileStart.at(font); i<m_fileStart.at(font+1); ++i) {
+        list << filePath(m_files.at(i));
+    }
+    return list;
+}
+
+QStringList Catalogue::fonts(Id file) const
+{
+    QStringList list;
+    for(u32 i = m_fontStart.at(file); i<m_fontStart.at(file+1); ++i) {
+        list << family(m_fonts.at(i));
+    }
+    return list;
+}
+
+QVector<FontName> Catalogue::names(Id font) const
+{
+    QVector<FontName> list;
+    for(u32 i = m_nameStart.at(font); i<m_nameStart.at(font+1); ++i) {
+        FontName n;
+        n.id = m_nameId.at(i);
+        n.platform = m_namePlatform.at(i);
+        n.language = m_nameLanguage.at(i);
+        n.name = m_strings.at(m_name.at(i));
+        list << n;
+    }
+    return list;
+}
+
+QString Catalogue::nameKey(CStringRef name)
+{
+    QString key;
+    key.reserve(name.length());
+
+    for(const QChar &c : name) {
+        if(c.isLetterOrNumber()) {
+            key += c.toLower();
+        }
+    }
+
+    return key;
+}
+
+void Catalogue::buildNameIndex()
+{
+    FONTA_TRACE_SPAN("catalogue", "names");
+
+    struct Entry {
+        QString key;
+        Id font;
+
+        bool operator<(const Entry &other) const { return key != other.key ? key < other.key : font < other.font; }
+        bool operator==(const Entry &other) const { return key == other.key && font == other.font; }
+    };
+
+    std::vector<Entry> entries;
+    for(Id font = 0; font<fontsCount(); ++font) {
+        // family is indexed even if font has no name records (.fon)
+        entries.push_back({nameKey(family(font)), font});
+        for(u32 i = m_nameStart.at(font); i<m_nameStart.at(font+1); ++i) {
+            FontName n;
+            n.id = m_nameId.at(i);
+            if(n.isFamily()) {
+                entries.push_back({nameKey(m_strings.at(m_name.at(i))), font});
+            }
+        }
+    }
+
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    m_indexKey.clear();
+    m_indexFont.clear();
+    m_indexKey.reserve(static_cast<int>(entries.size()));
+    m_indexFont.reserve(static_cast<int>(entries.size()));
+    for(const Entry &e : entries) {
+        if(e.key.isEmpty()) {
+            continue;
+        }
+        m_indexKey << m_strings.add(e.key);
+        m_indexFont << e.font;
+    }
+}
+
+QVector<Catalogue::Id> Catalogue::fontsNamed(CStringRef name) const
+{
+    const QString key = nameKey(name);
+    const QStringView view(key);
+
+    auto it = std::lower_bound(m_indexKey.cbegin(), m_indexKey.cend(), view, [this](u32 k, QStringView key) {
+        return m_strings.view(k) < key;
+    });
+
+    QVector<Id> found;
+    for(int i = static_cast<int>(it - m_indexKey.cbegin()); i<m_indexKey.size() && m_strings.view(m_indexKey.at(i)) == view; ++i) {
+        found << m_indexFont.at(i);
+    }
+    return found;
+}
+
+QVector<Catalogue::Id> Catalogue::searchNames(CStringRef text) const
+{
+    FONTA_TRACE_SPAN("catalogue", "searchNames");
+
+    const QString key = nameKey(text);
+    if(key.isEmpty()) {
+        return QVector<Id>();
+    }
+
+    // equal keys are adjacent and interned once, so every distinct key is tested once
+    QVector<Id> found;
+    u32 lastKey = 0;
+    bool lastMatched = false;
+    for(int i = 0; i<m_indexKey.size(); ++i) {
+        const u32 k = m_indexKey.at(i);
+        if(i == 0 || k != lastKey) {
+            lastKey = k;
+            lastMatched = m_strings.view(k).indexOf(key) >= 0;
+        }
+        if(lastMatched) {
+            found << m_indexFont.at(i);
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    return found;
+}
+
+QVector<Catalogue::Id> Catalogue::fontsCovering(const QVector<u32> &codePoints) const
+{
+    FONTA_TRACE_SPAN("catalogue", "fontsCovering");
+
+    QVector<Id> found;
+    for(Id font = 0; font<fontsCount(); ++font) {
+        if(!m_coverage.at(font).isEmpty() && m_coverage.at(font).containsAll(codePoints)) {
+            found << font;
+        }
+    }
+    return found;
+}
+
+QStringList Catalogue::linkedFonts(Id font) const
+{
+    QStringList list;
+    if(font == null) {
+        return list;
+    }
+
+    const Id c = m_component.at(font);
+    for(u32 i = m_componentStart.at(c); i<m_componentStart.at(c+1); ++i) {
+        if(m_members.at(i) != font) {
+            list << family(m_members.at(i));
+        }
+    }
+    return list;
+}
+
+void Catalogue::buildComponents()
+{
+    FONTA_TRACE_SPAN("catalogue", "components");
+
+    const int count = fontsCount();
+
+    // union-find over fonts, fonts of every file are united with its first one
+    QVector<Id> parent(count);
+    QVector<int> size(count, 1);
+    for(Id font = 0; font<count; ++font) {
+        parent[font] = font;
+    }
+
+    cauto find = [&parent](Id x) {
+        while(parent.at(x) != x) {
+            parent[x] = parent.at(parent.at(x)); // path halving
+            x = parent.at(x);
+        }
+        return x;
+    };
+
+    for(Id file = 0; file<filesCount(); ++file) {
+        const u32 first = m_fontStart.at(file);
+        for(u32 i = first + 1; i<m_fontStart.at(file+1); ++i) {
+            Id a = find(m_fonts.at(first));
+            Id b = find(m_fonts.at(i));
+            if(a == b) {
+                continue;
+            }
+
+            if(size.at(a) < size.at(b)) {
+                std::swap(a, b);
+            }
+            parent[b] = a;
+            size[a] += size.at(b);
+        }
+    }
+
+    // components are numbered in order of their first font, members come sorted
+    m_component.fill(null, count);
+    QVector<u32> membersCount;
+    for(Id font = 0; font<count; ++font) {
+        const Id root = find(font);
+        if(m_component.at(root) == null) {
+            m_component[root] = membersCount.size();
+            membersCount << 0;
+        }
+        m_component[font] = m_component.at(root);
+        ++membersCount[m_component.at(font)];
+    }
+
+    m_componentStart.resize(membersCount.size() + 1);
+    m_componentStart[0] = 0;
+    for(int c = 0; c<membersCount.size(); ++c) {
+        m_componentStart[c+1] = m_componentStart.at(c) + membersCount.at(c);
+    }
+
+    m_members.resize(count);
+    QVector<u32> next = m_componentStart;
+    for(Id font = 0; font<count; ++font) {
+        m_members[next[m_component.at(font)]++] = font;
+    }
+}
+
+void Catalogue::buildScripts()
+{
+    FONTA_TRACE_SPAN("catalogue", "scripts");
+
+    const int words = scriptWords();
+    m_scriptFonts.fill(0, Script::count*words);
+
+    for(Id font = 0; font<fontsCount(); ++font) {
+        const FontTraits t = traits(font);
+        for(int script = 0; script<Script::count; ++script) {
+            if(t.supports(static_cast<Script::type>(script))) {
+                m_scriptFonts[script*words + font/64] |= u64(1) << (font%64);
+            }
+        }
+    }
+}
+
+Catalogue::Memory Catalogue::memory() const
+{
+    Memory m;
+    m.strings = m_strings.bytes();
+    m.columns = vectorBytes(m_nameStart) + vectorBytes(m_name) + vectorBytes(m_nameId) + vectorBytes(m_namePlatform)
+              + vectorBytes(m_nameLanguage) + vectorBytes(m_indexKey) + vectorBytes(m_indexFont)
+              + vectorBytes(m_family) + vectorBytes(m_familyClass) + vectorBytes(m_familySubClass)
+              + vectorBytes(m_flags) + vectorBytes(m_panose) + vectorBytes(m_unicodeRange) + vectorBytes(m_codePageRange)
+              + vectorBytes(m_scriptFonts) + vectorBytes(m_faceStart) + vectorBytes(m_faceStyle) + vectorBytes(m_faceWeight)
+              + vectorBytes(m_faceWidth) + vectorBytes(m_faceSelection) + vectorBytes(m_faceItalicAngle)
+              + vectorBytes(m_faceInstance) + vectorBytes(m_faceCoordStart) + vectorBytes(m_faceCoords)
+              + vectorBytes(m_axisStart) + vectorBytes(m_axisTag) + vectorBytes(m_axisMin) + vectorBytes(m_axisDef)
+              + vectorBytes(m_axisMax) + vectorBytes(m_axisName)
+              + vectorBytes(m_dir) + vectorBytes(m_fileName);
+    m.relations = vectorBytes(m_fileStart) + vectorBytes(m_files) + vectorBytes(m_fontStart) + vectorBytes(m_fonts)
+                + vectorBytes(m_component) + vectorBytes(m_componentStart) + vectorBytes(m_members);
+    m.coverage = vectorBytes(m_coverage);
+    for(const Coverage &c : m_coverage) {
+        m.coverage += c.bytes();
+    }
+    return m;
+}
+
+namespace {
+
+// Qt 5 and libstdc++ on 64 bit, every allocation pays malloc header too
+const qint64 mallocOverhead = 16;
+const qint64 stringHeader = 24;   // QArrayData
+const qint64 hashHeader = 48;     // QHashData
+const qint64 hashNode = 24;       // next, hash, QString key
+const qint64 listHeader = 16;     // QListData::Data
+
+// implicitly shared strings are counted once
+qint64 stringBytes(CStringRef s, QSet<const void *> &seen)
+{
+    if(s.isNull() || seen.contains(s.constData())) {
+        return 0;
+    }
+    seen.insert(s.constData());
+    return stringHeader + (s.capacity() + 1)*sizeof(QChar) + mallocOverhead;
+}
+
+qint64 setBytes(const QSet<QString> &set, QSet<const void *> &seen)
+{
+    qint64 bytes = hashHeader + set.capacity()*sizeof(void *) + set.size()*(hashNode + mallocOverhead) + 2*mallocOverhead;
+    for(CStringRef s : set) {
+        bytes += stringBytes(s, seen);
+    }
+    return bytes;
+}
+
+} // namespace
+
+qint64 Catalogue::mapMemory(const TTFMap &TTFs, const File2FontsMap &File2Fonts)
+{
+    QSet<const void *> seen;
+
+    // unordered_map: buckets and nodes with next pointer and cached hash
+    qint64 bytes = static_cast<qint64>(TTFs.bucket_count()*sizeof(void *))
+                 + static_cast<qint64>(TTFs.size()*(sizeof(void *) + sizeof(TTFMap::value_type) + sizeof(size_t) + mallocOverhead));
+
+    for(cauto pair : TTFs) {
+        const TTF &ttf = pair.second;
+        bytes += stringBytes(pair.first, seen);
+        bytes += setBytes(ttf.files, seen);
+        bytes += vectorBytes(ttf.faces) + mallocOverhead;
+        for(const FontFace &face : ttf.faces) {
+            bytes += stringBytes(face.style, seen) + vectorBytes(face.coordinates);
+        }
+        bytes += vectorBytes(ttf.axes);
+        for(const FontAxis &axis : ttf.axes) {
+            bytes += stringBytes(axis.name, seen);
+        }
+        bytes += ttf.coverage.bytes();
+        bytes += vectorBytes(ttf.names) + mallocOverhead;
+        for(const FontName &name : ttf.names) {
+            bytes += stringBytes(name.name, seen);
+        }
+    }
+
+    bytes += hashHeader + File2Fonts.capacity()*sizeof(void *) + 2*mallocOverhead;
+    for(auto it = File2Fonts.cbegin(); it != File2Fonts.cend(); ++it) {
+        bytes += hashNode + sizeof(QSet<QString>) + mallocOverhead;
+        bytes += stringBytes(it.key(), seen);
+        bytes += setBytes(it.value(), seen);
+    }
+
+    return bytes;
+}
+
+} // namespace fonta
@@ -1,6 +1,7 @@
 #include "classifier.h"
 
 #include <QStringList>
+#include <QSet>
 #include <QVector>
 #include <QDir>
 #include <QDebug>
@@ -103,6 +104,16 @@ static const QStringList postfixes = {
 	QStringLiteral("Khmer"),
 };
 
+// lookup sets for trim(), postfixes are matched case-insensitively
+static const QSet<QString> prefixSet = prefixes.toSet();
+static const QSet<QString> postfixSet = [] {
+    QSet<QString> set;
+    for(CStringRef postfix : postfixes) {
+        set << postfix.toLower();
+    }
+    return set;
+}();
+
 static const QStringList sansHints = {
     QStringLiteral(" sans serif"),
     QStringLiteral(" sans"),
@@ -177,13 +188,13 @@ QString trim(CStringRef name)
 
     QVector<QStringRef> v = str.contains(' ') ? QStringRef(&str).split(' ', QString::SkipEmptyParts) : split(str);
 
-    while(v.length() > 1 && prefixes.contains(getSharedQString(v[0]))) {
+    while(v.length() > 1 && prefixSet.contains(getSharedQString(v[0]))) {
         v.pop_front();
     }
 
     for(int i = 1; i<v.length(); ++i) {
         QString fromRef(getSharedQString(v[i]));
-        if(postfixes.contains(fromRef, Qt::CaseInsensitive)) {
+        if(postfixSet.contains(fromRef.toLower())) {
             v.remove(i, v.length()-i);
         }
     }
@@ -209,9 +220,22 @@ bool Classifier::load(CStringRef dbPath)
         }
     }
 
+    rebuildIndex();
+
     return true;
 }
 
+void Classifier::rebuildIndex()
+{
+    m_index.clear();
+
+    for(cauto type : FontType::enumerate()) {
+        for(CStringRef family : std::as_const(m_db[type])) {
+            m_index[family] |= type;
+        }
+    }
+}
+
 bool Classifier::loadFontType(FontType::type type)
 {
     QFile file(m_dbPath + QDir::separator() + FontType::fileName(type));
@@ -270,16 +294,12 @@ bool Classifier::storeFontType(FontType::type type)
 
 int Classifier::fontInfo(CStringRef family, SearchType searchType) const
 {
-    int info = 0;
-
-    QString trimmed = trim(family);
-
-    for(cauto type : FontType::enumerate()) {
-        if(m_db[type].contains(trimmed)) {
-            info |= type;
-        }
+    return trimmedFontInfo(trim(family), searchType);
+}
 
-    }
+int Classifier::trimmedFontInfo(CStringRef trimmed, SearchType searchType) const
+{
+    int info = m_index.value(trimmed, 0);
 
     if(!FontType::exists(info) && searchType == AdvancedSearch) {
         static const QVector<QPair<FontType::type, const QStringList &>> hintsMap = {
@@ -313,6 +333,7 @@ void Classifier::_addFontInfo(CStringRef family, int info)
             if(!m_db[type].contains(family)) {
                 qDebug() << family << QStringLiteral("added");
                 m_db[type] << family;
+                m_index[family] |= type;
             }
         }
     }
@@ -342,6 +363,7 @@ void Classifier::rewriteFontInfo(CStringRef family, int info)
     for(cauto type : FontType::enumerate()) {
         m_db[type].removeOne(trimmed);
     }
+    m_index.remove(trimmed);
 
     _addFontInfo(trimmed, info);
 }
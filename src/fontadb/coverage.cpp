@@ -0,0 +1,291 @@
+#include "coverage.h"
+
+#include <QChar>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <functional>
+
+namespace fonta {
+
+static const u32 maxCodePoint = 0x10FFFF;
+static const int groupWords = 1024;   // 64 bit words of group bitmap
+static const int bitmapValues = 4096; // the same as 16 bit values
+
+void Coverage::Builder::addRange(u32 first, u32 last)
+{
+    last = qMin(last, maxCodePoint);
+    if(first > last) {
+        return;
+    }
+
+    for(u32 key = first >> 16; key <= (last >> 16); ++key) {
+        QVector<u64> &words = m_bitmaps[static_cast<u16>(key)];
+        if(words.isEmpty()) {
+            words.fill(0, groupWords);
+        }
+
+        const u32 lo = key == (first >> 16) ? (first & 0xFFFF) : 0;
+        const u32 hi = key == (last >> 16) ? (last & 0xFFFF) : 0xFFFF;
+
+        for(u32 bit = lo; bit <= hi; ) {
+            const u32 word = bit >> 6;
+            const u32 from = bit & 63;
+            const u32 to = qMin<u32>(63, from + (hi - bit));
+            const u64 mask = (to - from == 63) ? ~u64(0) : (((u64(1) << (to - from + 1)) - 1) << from);
+            words[word] |= mask;
+            bit += to - from + 1;
+        }
+    }
+}
+
+void Coverage::Builder::add(const Coverage &coverage)
+{
+    for(int group = 0; group<coverage.m_keys.size(); ++group) {
+        const u32 high = u32(coverage.m_keys.at(group)) << 16;
+        const u32 begin = coverage.m_starts.at(group);
+        const u32 end = coverage.m_starts.at(group+1);
+
+        switch(coverage.m_kinds.at(group)) {
+            case Array:
+                for(u32 i = begin; i<end; ++i) {
+                    add(high | coverage.m_values.at(i));
+                }
+                break;
+            case Runs:
+                for(u32 i = begin; i<end; i += 2) {
+                    const u32 first = high | coverage.m_values.at(i);
+                    addRange(first, first + coverage.m_values.at(i+1));
+                }
+                break;
+            case Bitmap: {
+                QVector<u64> &words = m_bitmaps[coverage.m_keys.at(group)];
+                if(words.isEmpty()) {
+                    words.fill(0, groupWords);
+                }
+                for(int w = 0; w<groupWords; ++w) {
+                    const u16 *v = coverage.m_values.constData() + begin + 4*w;
+                    words[w] |= u64(v[0]) | (u64(v[1]) << 16) | (u64(v[2]) << 32) | (u64(v[3]) << 48);
+                }
+            } break;
+        }
+    }
+}
+
+Coverage Coverage::Builder::build() const
+{
+    Coverage c;
+    c.m_starts << 0;
+
+    for(auto it = m_bitmaps.cbegin(); it != m_bitmaps.cend(); ++it) {
+        const QVector<u64> &words = it.value();
+
+        // a run starts at every set bit whose previous bit is clear
+        int count = 0;
+        int runs = 0;
+        u64 previous = 0;
+        for(u64 w : words) {
+            count += qPopulationCount(w);
+            runs += qPopulationCount(w & ~((w << 1) | (previous >> 63)));
+            previous = w;
+        }
+
+        if(count == 0) {
+            continue;
+        }
+
+        Kind kind = Bitmap;
+        if(count <= 2*runs && count < bitmapValues) {
+            kind = Array;
+        } else if(2*runs < bitmapValues) {
+            kind = Runs;
+        }
+
+        if(kind == Bitmap) {
+            for(u64 w : words) {
+                c.m_values << u16(w) << u16(w >> 16) << u16(w >> 32) << u16(w >> 48);
+            }
+        } else {
+            int runStart = -1;
+            for(int word = 0; word<groupWords; ++word) {
+                for(u64 w = words.at(word); w; w &= w - 1) {
+                    const int low = word*64 + qCountTrailingZeroBits(w);
+                    if(kind == Array) {
+                        c.m_values << u16(low);
+                    } else if(runStart >= 0 && low == runStart + c.m_values.last() + 1) {
+                        ++c.m_values.last();
+                    } else {
+                        runStart = low;
+                        c.m_values << u16(low) << u16(0);
+                    }
+                }
+            }
+        }
+
+        c.m_keys << it.key();
+        c.m_kinds << kind;
+        c.m_starts << c.m_values.size();
+    }
+
+    if(c.m_keys.isEmpty()) {
+        return Coverage();
+    }
+
+    c.m_keys.squeeze();
+    c.m_kinds.squeeze();
+    c.m_starts.squeeze();
+    c.m_values.squeeze();
+    return c;
+}
+
+QVector<u32> Coverage::codePoints(CStringRef text)
+{
+    QVector<u32> points;
+    for(u32 c : text.toUcs4()) {
+        const QChar::Category category = QChar::category(c);
+        if(QChar::isSpace(c) || category == QChar::Other_Control || category == QChar::Other_Format) {
+            continue;
+        }
+        points << c;
+    }
+
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    return points;
+}
+
+bool Coverage::groupContains(int group, u16 low) const
+{
+    const u16 *begin = m_values.constData() + m_starts.at(group);
+    const u16 *end = m_values.constData() + m_starts.at(group+1);
+
+    switch(m_kinds.at(group)) {
+        case Array:
+            return std::binary_search(begin, end, low);
+        case Runs: {
+            // last run starting not after low
+            int lo = 0;
+            int hi = static_cast<int>(end - begin)/2;
+            while(lo < hi) {
+                const int mid = lo + (hi - lo)/2;
+                if(begin[2*mid] <= low) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo > 0 && u32(low - begin[2*(lo-1)]) <= begin[2*(lo-1) + 1];
+        }
+        case Bitmap:
+            return begin[low >> 4] & (1u << (low & 15));
+    }
+
+    return false;
+}
+
+bool Coverage::isValid() const
+{
+    // groups are binary searched by key
+    if(std::adjacent_find(m_keys.cbegin(), m_keys.cend(), std::greater_equal<u16>()) != m_keys.cend()) {
+        return false;
+    }
+
+    for(int group = 0; group<m_kinds.size(); ++group) {
+        const u32 size = m_starts.at(group+1) - m_starts.at(group);
+        switch(m_kinds.at(group)) {
+            case Array:
+                break;
+            case Runs:
+                if(size % 2) {
+                    return false;
+                }
+                break;
+            case Bitmap:
+                if(size != static_cast<u32>(bitmapValues)) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool Coverage::contains(u32 codePoint) const
+{
+    const u16 key = static_cast<u16>(codePoint >> 16);
+    auto it = std::lower_bound(m_keys.cbegin(), m_keys.cend(), key);
+    if(codePoint > maxCodePoint || it == m_keys.cend() || *it != key) {
+        return false;
+    }
+
+    return groupContains(static_cast<int>(it - m_keys.cbegin()), static_cast<u16>(codePoint));
+}
+
+bool Coverage::containsAll(const QVector<u32> &codePoints) const
+{
+    // code points are sorted, so groups are visited in order
+    int group = 0;
+    for(u32 c : codePoints) {
+        const u16 key = static_cast<u16>(c >> 16);
+        while(group < m_keys.size() && m_keys.at(group) < key) {
+            ++group;
+        }
+
+        if(c > maxCodePoint || group == m_keys.size() || m_keys.at(group) != key || !groupContains(group, static_cast<u16>(c))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int Coverage::count() const
+{
+    int n = 0;
+    for(int group = 0; group<m_keys.size(); ++group) {
+        const u32 begin = m_starts.at(group);
+        const u32 end = m_starts.at(group+1);
+
+        switch(m_kinds.at(group)) {
+            case Array:
+                n += end - begin;
+                break;
+            case Runs:
+                for(u32 i = begin; i<end; i += 2) {
+                    n += m_values.at(i+1) + 1;
+                }
+                break;
+            case Bitmap:
+                for(u32 i = begin; i<end; ++i) {
+                    n += qPopulationCount(m_values.at(i));
+                }
+                break;
+        }
+    }
+    return n;
+}
+
+qint64 Coverage::bytes() const
+{
+    return m_keys.capacity()*sizeof(u16) + m_kinds.capacity()*sizeof(u8)
+         + m_starts.capacity()*sizeof(u32) + m_values.capacity()*sizeof(u16);
+}
+
+Coverage Coverage::united(const Coverage &other) const
+{
+    if(other.isEmpty()) {
+        return *this;
+    }
+    if(isEmpty()) {
+        return other;
+    }
+
+    Builder builder;
+    builder.add(*this);
+    builder.add(other);
+    return builder.build();
+}
+
+} // namespace fonta
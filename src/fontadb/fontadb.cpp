@@ -1,13 +1,15 @@
 #include "FontaDB.h"
+#include "fontconfigsource.h"
+#include "fontreader.h"
+#include "taskgraph.h"
+#include "trace.h"
 
+#include <QCoreApplication>
+#include <QDir>
 #include <QDirIterator>
-#include <thread>
-#include <QThread>
-
-#ifdef FONTA_MEASURES
-#include <QElapsedTimer>
-#include <QDebug>
-#endif
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
 
 #ifdef FONTA_DETAILED_DEBUG
 #include <QDebug>
@@ -17,808 +19,921 @@
 #include <QStandardPaths>
 #include <QSettings>
 #include <QProcess>
-#include <QCryptographicHash>
 #include <QDataStream>
-#include <mutex>
+#include <QSaveFile>
+#include <algorithm>
+#include <memory>
 
 namespace fonta {
 
 #define CACHE_FILE (QStringLiteral("C:\\ProgramData\\PitM\\Fonta\\cache.dat"))
 
-const TTF TTF::null = TTF();
-
-static void getFontFiles(QStringList &out)
-{
-    cauto fontsDirs = QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
-    for(CStringRef dir : fontsDirs) {
-        QDirIterator it(dir, {QStringLiteral("*.ttf"), QStringLiteral("*.otf"), QStringLiteral("*.ttc"), QStringLiteral("*.otc"), QStringLiteral("*.fon")} , QDir::Files, QDirIterator::Subdirectories);
-        while (it.hasNext()) {
-            it.next();
-            QString fileName = it.filePath();
+DB *DB::mInstance = nullptr;
 
-            // if file is planned tobe deleted - do not include it to list of font files
-            QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
-            QStringList filesToDelete = fontaReg.value(QStringLiteral("FilesToDelete")).toStringList();
-            if(!filesToDelete.contains(fileName)) {
-                out << it.filePath();
-            }
-        }
+DB *DB::instance() {
+    if (mInstance == nullptr) {
+        mInstance = new DB;
     }
-}
-
-#pragma pack(push, 1)
-
-struct TTFOffsetTable {
-    u32 SfntVersion;
-    u16 NumTables;
-    u16 SearchRange;
-    u16 EntrySelector;
-    u16 RangeShift;
-};
 
-struct TTFTableRecord {
-    char TableName[4];
-    u32 CheckSum;
-    u32 Offset;
-    u32 Length;
-};
-
-struct TTFNameHeader {
-    u16 Selector;
-    u16 RecordsCount;
-    u16 StorageOffset;
-};
+    return mInstance;
+}
 
-struct TTFNameRecord {
-    u16 PlatformID;
-    u16 EncodingID;
-    u16 LanguageID;
-    u16 NameID;
-    u16 StringLength;
-    u16 StringOffset; //from start of storage area
+DB::DB()
+{
 
-    TTFNameRecord() : PlatformID(1), EncodingID(0), LanguageID(0), NameID(1), StringLength(0), StringOffset(0)
-    {}
-};
+}
 
-struct TTFOS2Header {
-    u32 placeholder0;
-    u32 placeholder1;
-    u32 placeholder2;
-    u32 placeholder3;
-    u32 placeholder4;
-    u32 placeholder5;
-    u32 placeholder6;
-    u16 placeholder7;
-
-    i16 FamilyClass;
-    Panose panose;
-    u32 UnicodeRange1;
+// results of background rescan, applied on GUI thread
+struct DB::Rescan {
+    TTFMap TTFs;              // fonts of new and changed files
+    File2FontsMap File2Fonts;
+    FileStamps stamps;        // new and changed files
+    QStringList dropped;      // removed and changed files
+    QStringList dirs;         // scanned dirs and their subdirs, to be watched
+    ScanReport report;        // of new and changed files, merged on GUI thread
 };
 
-#pragma pack(pop)
+// burst of file copies of font installer ends up in one rescan
+static const int debounceMs = 500;
 
-namespace TTFTable {
-    enum type {
-        NO = -1,
-        NAME,
-        OS2,
-        count
-    };
+// file is in dir or in its subdir
+static bool isUnder(CStringRef file, const QStringList &dirs)
+{
+    for(CStringRef dir : dirs) {
+        if(file.startsWith(dir) && file.length() > dir.length() && file.at(dir.length()) == '/') {
+            return true;
+        }
+    }
+    return false;
 }
 
-static std::mutex readTTFMutex;
-static std::mutex readFile2Fonts;
+// fontconfig seeds files from its own dirs, so they are scanned too or seed would never be replaced
+static QStringList fontDirs()
+{
+    QStringList dirs = QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
+    dirs += FontconfigSource::fontDirs();
 
-template <typename T> inline void swap(T &x);
+    for(QString &dir : dirs) {
+        dir = QDir::cleanPath(dir);
+    }
+    dirs.removeDuplicates();
 
-template <> inline void swap<u16>(u16 &x)
-{
-    x = u16( 0
-             | ((x & 0x00ff) << 8)
-             | ((x & 0xff00) >> 8) );
+    // subdirs are scanned with their dirs
+    QStringList roots;
+    for(CStringRef dir : std::as_const(dirs)) {
+        if(!isUnder(dir, dirs)) {
+            roots << dir;
+        }
+    }
+    return roots;
 }
 
-template <> inline void swap<u32>(u32 &x)
+void DB::load()
 {
-    x = 0
-        | ((x & 0x000000ff) << 24)
-        | ((x & 0x0000ff00) << 8)
-        | ((x & 0x00ff0000) >> 8)
-        | ((x & 0xff000000) >> 24);
-}
+    FONTA_TRACE_SPAN("db", "load");
+
+    // known fonts and cache don't depend on each other,
+    // QFontDatabase isn't needed at all until something is rendered
+    bool cached = false;
+    TaskGraph startup;
+
+    const auto known = startup.add("Classifier::load", [this]{
+        classifier.load(QStringLiteral(":/known_fonts"));
+    });
+
+    const auto cache = startup.add("loadCache", [this, &cached]{
+        cached = loadCache();
+    });
+
+    // first run: fontconfig already knows families and files, parsing fills OS/2 data later
+    const auto seed = startup.add("fontconfig", [this, &cached]{
+        TTFMap TTFs;
+        File2FontsMap File2Fonts;
+        if(!cached && FontconfigSource::available() && FontconfigSource::read(TTFs, File2Fonts)) {
+            m_catalogue = Catalogue(TTFs);
+            m_seeded = !m_catalogue.isEmpty();
+        }
+    }, {cache});
 
-template <typename T>
-inline T read_raw(QFile &f)
-{
-    T data;
-    f.read((char*)&data, sizeof(T));
+    startup.add("buildIndex", [this, &cached]{
+        if(cached || m_seeded) {
+            updateUninstalledFonts();
+            buildIndex(catalogueFamilies());
+        }
+    }, {known, seed});
 
-    return data;
-}
+    startup.run();
 
-template <typename T> inline T read(QFile &f)
-{
-    T data = read_raw<T>(f);
-    swap(data);
+    // last snapshot is shown at once and validated afterwards
+    if(cached || m_seeded) {
+        m_loaded = true;
+        emit loadFinished();
+    }
 
-    return data;
+    rescan();
 }
 
-template <>
-inline TTFOffsetTable read<TTFOffsetTable>(QFile &f)
+bool DB::loadCache()
 {
-    auto data = read_raw<TTFOffsetTable>(f);
-    swap(data.NumTables); // this is the only usefull field
-    return data;
-}
+    FONTA_TRACE_SPAN("cache", "load");
 
-template <>
-inline TTFTableRecord read<TTFTableRecord>(QFile &f)
-{
-    auto data = read_raw<TTFTableRecord>(f);
+    QFile file(CACHE_FILE);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
 
-    swap(data.Offset);
-    swap(data.Length);
-    // do NOT swap TableName and CheckSum
+    QDataStream cacheStream(&file);
+    cacheStream.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+    cacheStream >> *this;
 
-    return data;
+    if(cacheStream.status() != QDataStream::Ok) {
+        m_catalogue = Catalogue();
+        m_fileStamps.clear();
+        return false;
+    }
+
+    return true;
 }
 
-template <>
-inline TTFNameHeader read<TTFNameHeader>(QFile &f)
+void DB::saveCache() const
 {
-    auto data = read_raw<TTFNameHeader>(f);
+    FONTA_TRACE_SPAN("cache", "save");
 
-    swap(data.RecordsCount);
-    swap(data.StorageOffset);
+    QSaveFile file(CACHE_FILE);
+    if(!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
 
-    return data;
+    QDataStream cacheStream(&file);   // we will serialize the data into the file
+    cacheStream.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+    cacheStream << *this;
+    file.commit();
 }
 
-template <>
-inline TTFNameRecord read<TTFNameRecord>(QFile &f)
+void DB::rescan(const QStringList &dirs)
 {
-    auto data = read_raw<TTFNameRecord>(f);
+    if(m_loader.joinable()) {
+        return;
+    }
 
-    swap(data.StringLength);
-    swap(data.StringOffset);
-    // Notice that we did not do swap PlatformID, EncodingID, LanguageID, NameID!
+    // copies are shared with worker, members are only touched by GUI thread
+    const FileStamps known = m_fileStamps;
+    const QStringList toDelete = filesToDelete();
+    const QStringList roots = dirs.isEmpty() ? fontDirs() : dirs;
 
-    return data;
+    // GUI thread stays free to sample m_scanProgress while files are read
+    m_loader = std::thread([this, known, toDelete, roots]{
+        Rescan *rescan = new Rescan;
+        scan(known, toDelete, roots, *rescan);
+        QMetaObject::invokeMethod(this, "applyRescan", Qt::QueuedConnection, Q_ARG(void*, rescan));
+    });
 }
 
-template <>
-inline TTFOS2Header read<TTFOS2Header>(QFile &f)
+void DB::scan(const FileStamps &known, const QStringList &toDelete, const QStringList &dirs, Rescan &rescan)
 {
-    auto data = read_raw<TTFOS2Header>(f);
+    FONTA_TRACE_SPAN("db", "scan");
 
-    swap(data.UnicodeRange1);
-    // do not swap family class
+    FileStamps current;
+    FontReader::fontFiles(dirs, nullptr, &current);
 
-    return data;
-}
-
-class FontReader
-{
-public:
-    FontReader(TTFMap &TTFs, File2FontsMap &File2Fonts);
-    ~FontReader();
+    for(CStringRef dir : dirs) {
+        if(!QFileInfo(dir).isDir()) {
+            continue;
+        }
 
-    void readFile(CStringRef fileName);
+        rescan.dirs << dir;
+        QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while(it.hasNext()) {
+            rescan.dirs << it.next();
+        }
+    }
 
-private:
-    TTFMap &TTFs;
-    File2FontsMap &File2Fonts;
+    // if file is planned tobe deleted - do not include it to list of font files
+    for(CStringRef f : toDelete) {
+        current.remove(f);
+    }
 
-    QFile f;
-    TTFTableRecord tablesMap[TTFTable::count];
+    qint64 bytes = 0;
+    QStringList toRead;
+    for(auto it = current.cbegin(); it != current.cend(); ++it) {
+        auto old = known.constFind(it.key());
+        if(old != known.cend() && *old == *it) {
+            continue;
+        }
 
-    bool readTablesMap(const u8 *const data);
-    void readTTF();
-    void readTTC();
-    void readFON();
-    void readFont();
+        if(old != known.cend()) {
+            rescan.dropped << it.key();
+        }
+        toRead << it.key();
+        bytes += it->size;
+        rescan.stamps.insert(it.key(), *it);
+    }
 
-    template <typename T> inline T read()
-    {
-        return fonta::read<T>(f);
+    // files out of scanned dirs are left as they are
+    for(auto it = known.cbegin(); it != known.cend(); ++it) {
+        if(!current.contains(it.key()) && isUnder(it.key(), dirs)) {
+            rescan.dropped << it.key();
+        }
     }
-};
 
-FontReader::FontReader(TTFMap &TTFs, File2FontsMap &File2Fonts)
-    : TTFs(TTFs)
-    , File2Fonts(File2Fonts)
-{
-    memset(tablesMap, 0, TTFTable::count*sizeof(TTFTableRecord));
-}
+    trace::counter("db", "changedFiles", toRead.size());
+    trace::counter("db", "droppedFiles", rescan.dropped.size());
 
-FontReader::~FontReader()
-{
-    f.close();
+    m_scanProgress.start(bytes, toRead.size());
+    if(!toRead.isEmpty()) {
+        const i64 scanStarted = trace::now();
+        FontReader::readFiles(toRead, rescan.TTFs, rescan.File2Fonts, 0, &m_scanProgress, &rescan.report);
+        rescan.report.setWallTime(trace::now() - scanStarted);
+    }
+    m_scanProgress.finish();
 }
 
-void FontReader::readFile(CStringRef fileName)
+void DB::applyRescan(void *result)
 {
-#ifdef FONTA_DETAILED_DEBUG
-    qDebug() << qPrintable(QFileInfo(fileName).fileName()) << ":";
-#endif
-
-    f.setFileName(fileName);
+    FONTA_TRACE_SPAN("db", "applyRescan");
 
-    if (Q_UNLIKELY(!f.open(QIODevice::ReadOnly))) {
-        qWarning() << "Couldn't open!";
-        return;
+    if(m_loader.joinable()) {
+        m_loader.join();
     }
 
-    if(fileName.endsWith(QLatin1String(".ttc"), Qt::CaseInsensitive)) {
-        readTTC();
-    } else if(fileName.endsWith(QLatin1String(".fon"), Qt::CaseInsensitive)) {
-        readFON();
-    } else {
-        readTTF();
-    }
-}
+    std::unique_ptr<Rescan> rescan(static_cast<Rescan*>(result));
 
-void FontReader::readFON()
-{
-    f.seek(60);
-    u16 headOffset = read_raw<u16>(f) + 4;
+    // fontconfig seed is replaced by parsed data of every file parser has reached
+    if(m_seeded) {
+        m_seeded = false;
+        for(auto it = rescan->stamps.cbegin(); it != rescan->stamps.cend(); ++it) {
+            if(m_catalogue.file(it.key()) != Catalogue::null) {
+                rescan->dropped << it.key();
+            }
+        }
+    }
 
-    f.seek(headOffset);
-    u16 fontresOffset = read_raw<u16>(f);
+    // live rescan of a few files keeps report of the startup scan
+    m_scanReport.merge(std::move(rescan->report), rescan->dropped);
 
-    f.seek(headOffset + 28);
-    u16 length = read_raw<u16>(f);
+    const bool changed = !rescan->dropped.isEmpty() || !rescan->stamps.isEmpty();
 
-    f.seek(headOffset + fontresOffset - 1);
+    if(changed) {
+        // catalogue is immutable, it is unpacked, patched and built again
+        TTFMap TTFs;
+        File2FontsMap File2Fonts;
+        m_catalogue.unpack(TTFs, File2Fonts);
 
-    char *bytes = new char[length];
-    f.read(bytes, length);
+        // forget removed and changed files
+        for(CStringRef file : std::as_const(rescan->dropped)) {
+            const QSet<QString> fonts = File2Fonts.take(file);
+            for(CStringRef font : fonts) {
+                auto it = TTFs.find(font);
+                if(it == TTFs.end()) {
+                    continue;
+                }
 
-    QString name(bytes);
+                it->second.files.remove(file);
+                if(it->second.files.isEmpty()) {
+                    TTFs.erase(it);
+                }
+            }
+            m_fileStamps.remove(file);
+        }
 
-    delete [] bytes;
+        // fresh data wins, fonts also found in unchanged files keep them
+        for(auto &pair : rescan->TTFs) {
+            auto it = TTFs.find(pair.first);
+            if(it != TTFs.end()) {
+                pair.second.files.unite(it->second.files);
+                it->second = std::move(pair.second);
+            } else {
+                TTFs.emplace(pair.first, std::move(pair.second));
+            }
+        }
 
-    QStringRef nameRef(&name);
-    nameRef = nameRef.mid(name.indexOf(':') + 1);
+        for(auto it = rescan->File2Fonts.cbegin(); it != rescan->File2Fonts.cend(); ++it) {
+            File2Fonts[it.key()] = it.value();
+        }
 
-    const int ipareth = nameRef.indexOf('(');
-    const int icomma = nameRef.indexOf(',');
+        for(auto it = rescan->stamps.cbegin(); it != rescan->stamps.cend(); ++it) {
+            m_fileStamps.insert(it.key(), it.value());
+        }
 
-    if(icomma == -1 && ipareth != -1) {
-        nameRef.truncate(ipareth);
-    } else if(icomma != -1) {
-        for(int i = icomma-1; i>=0; --i) {
-            if(!nameRef.at(i).isDigit()) {
-                nameRef.truncate(i+1);
-                break;
-            }
+        if(m_loaded) {
+            update(Catalogue(TTFs));
+        } else {
+            m_catalogue = Catalogue(TTFs);
         }
+        saveCache();
     }
 
-    int i = nameRef.indexOf(QLatin1String("Font for "));
-    if(i != -1) {
-        nameRef.truncate(i);
-    }
+    trace::counter("db", "fonts", m_catalogue.fontsCount());
 
-    i = nameRef.indexOf(QLatin1String(" Font "));
-    if(i != -1) {
-        nameRef.truncate(i);
-    }
+    watch(rescan->dirs);
 
-    i = nameRef.indexOf(QLatin1String(" for "));
-    if(i != -1) {
-        nameRef.truncate(i);
+    // dirs changed while this rescan ran
+    if(!m_dirtyDirs.isEmpty()) {
+        m_debounce->start();
     }
 
-    name = nameRef.trimmed().toString();
+    if(!m_loaded) {
+        m_loaded = true;
+        updateUninstalledFonts();
+        buildIndex(catalogueFamilies());
+        emit loadFinished();
+    }
+}
 
-#ifdef FONTA_DETAILED_DEBUG
-    qDebug() << '\t' << name;
-#endif
+void DB::update(Catalogue catalogue)
+{
+    FONTA_TRACE_SPAN("db", "update");
 
-    CStringRef fileName = f.fileName();
+    const QStringList before = m_families;
 
-    {
-        std::lock_guard<std::mutex> lock(readFile2Fonts);
-        File2Fonts[fileName] << name;
-        (void)lock;
+    // predicates could change only for families with new traits or faces
+    QHash<QString, u64> changing;
+    for(Catalogue::Id font = 0; font<catalogue.fontsCount(); ++font) {
+        const QString family = catalogue.family(font);
+        const Catalogue::Id old = m_catalogue.font(family);
+        if(old != Catalogue::null && (m_catalogue.traits(old) != catalogue.traits(font) || m_catalogue.faces(old) != catalogue.faces(font))) {
+            changing.insert(family, predicates(family));
+        }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(readTTFMutex);
-        if(TTFs.contains(name)) {
-            TTFs[name].files << f.fileName();
-            return;
+    m_catalogue = std::move(catalogue);
+    buildIndex(catalogueFamilies());
+
+    CatalogueDelta delta = diff(before, m_families);
+    for(CStringRef family : std::as_const(m_families)) {
+        auto it = changing.constFind(family);
+        if(it == changing.constEnd()) {
+            continue;
+        }
+
+        const u64 flipped = *it ^ predicates(family);
+        if(flipped) {
+            delta.changed << family;
+            delta.changedPredicates << flipped;
         }
-        (void)lock;
     }
 
-    TTF ttf;
-    ttf.valid = true;
-    ttf.files << std::move(fileName);
+    trace::counter("db", "deltaAdded", delta.added.size());
+    trace::counter("db", "deltaRemoved", delta.removed.size());
+    trace::counter("db", "deltaChanged", delta.changed.size());
 
-    {
-        std::lock_guard<std::mutex> lock(readTTFMutex);
-        TTFs[name] = std::move(ttf);
-        (void)lock;
+    if(!delta.isEmpty()) {
+        emit catalogueChanged(delta);
     }
 }
 
-void FontReader::readTTC()
+bool DB::familyLess(CStringRef a, CStringRef b)
 {
-    f.seek(8);
-
-    const u32 offsetTablesCount = read<u32>();
-
-    std::vector<u32> offsets(offsetTablesCount);
-    f.read((char*)offsets.data(), offsetTablesCount*sizeof(u32));
+    const int c = a.compare(b, Qt::CaseInsensitive);
+    return c != 0 ? c < 0 : a < b;
+}
 
-    for(u32 offset : std::as_const(offsets)) {
-        swap(offset);
-        if(Q_LIKELY(f.seek(offset))) {
-            readTTF();
+CatalogueDelta DB::diff(const QStringList &before, const QStringList &after)
+{
+    // both snapshots are sorted, one merge pass
+    CatalogueDelta delta;
+
+    int i = 0;
+    int j = 0;
+    while(i < before.size() || j < after.size()) {
+        if(j == after.size() || (i < before.size() && familyLess(before.at(i), after.at(j)))) {
+            delta.removed << before.at(i++);
+        } else if(i == before.size() || familyLess(after.at(j), before.at(i))) {
+            delta.added << after.at(j++);
+        } else {
+            ++i;
+            ++j;
         }
     }
+
+    return delta;
 }
 
-void FontReader::readTTF()
+void DB::watch(const QStringList &dirs)
 {
-    cauto ttcHeader = read<TTFOffsetTable>();
-
-    qint64 dataSize = ttcHeader.NumTables*sizeof(TTFTableRecord);
-    if(Q_UNLIKELY(dataSize > f.size())) {
-        return;
+    if(!m_watcher) {
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &DB::onDirectoryChanged);
+
+        m_debounce = new QTimer(this);
+        m_debounce->setSingleShot(true);
+        m_debounce->setInterval(debounceMs);
+        connect(m_debounce, &QTimer::timeout, this, &DB::rescanDirty);
+    }
+
+    // removed dirs are dropped by watcher itself
+    const QStringList watched = m_watcher->directories();
+    QStringList added;
+    for(CStringRef dir : dirs) {
+        if(!watched.contains(dir)) {
+            added << dir;
+        }
     }
 
-    u8 *data = new u8[dataSize];
-    f.read((char*)data, dataSize);
-
-    u8 *dataPtr = data;
+    if(!added.isEmpty()) {
+        m_watcher->addPaths(added);
+    }
+}
 
-    int tablesCount = 0;
-    for(int i = 0; i<ttcHeader.NumTables; ++i) {
-        tablesCount += (int)readTablesMap(dataPtr);
-        if(tablesCount == TTFTable::count) {
-            break;
-        }
-        dataPtr += sizeof(TTFTableRecord);
+void DB::onDirectoryChanged(const QString &dir)
+{
+    if(!m_dirtyDirs.contains(dir)) {
+        m_dirtyDirs << dir;
     }
 
-    delete data;
+    // every event of burst postpones rescan
+    m_debounce->start();
+}
 
-    if(Q_UNLIKELY(tablesCount != TTFTable::count)) {
-        qWarning() << "no necessary tables!";
+void DB::rescanDirty()
+{
+    // the running one is followed by another, see applyRescan()
+    if(m_loader.joinable() || m_dirtyDirs.isEmpty()) {
         return;
     }
 
-    readFont();
+    // subdir is rescanned with its dir anyway
+    QStringList dirs;
+    for(CStringRef dir : std::as_const(m_dirtyDirs)) {
+        if(!isUnder(dir, m_dirtyDirs)) {
+            dirs << dir;
+        }
+    }
+    m_dirtyDirs.clear();
+
+    trace::instant("db", "rescanDirty");
+    rescan(dirs);
 }
 
-bool FontReader::readTablesMap(const u8 *const data)
+void DB::loadFiles(const QStringList &files)
 {
-    const TTFTableRecord *const table = (TTFTableRecord*)data;
-    TTFTable::type tableType = TTFTable::NO;
+    classifier.load(QStringLiteral(":/known_fonts"));
 
-    if(memcmp(table->TableName, "name", 4) == 0) {
-        tableType = TTFTable::NAME;
-    }
+    TTFMap TTFs;
+    File2FontsMap File2Fonts;
 
-    if(memcmp(table->TableName, "OS/2", 4) == 0) {
-        tableType = TTFTable::OS2;
-    }
+    m_scanReport.clear();
+    const i64 scanStarted = trace::now();
+    FontReader::readFiles(files, TTFs, File2Fonts, 0, nullptr, &m_scanReport);
+    m_scanReport.setWallTime(trace::now() - scanStarted);
 
-    if(tableType != TTFTable::NO) {
-        tablesMap[tableType] = *table;
-        swap(tablesMap[tableType].Offset);
-        swap(tablesMap[tableType].Length);
-        return true;
-    } else {
-        return false;
-    }
+    m_catalogue = Catalogue(TTFs);
+
+    buildIndex(catalogueFamilies());
 }
 
-static inline u16 getU16(const char *p)
+DB::~DB()
 {
-    u16 val;
-    val = *p++ << 8;
-    val |= *p;
+    if(m_loader.joinable()) {
+        m_loader.join();
+    }
 
-    return val;
+    delete QtDB;
 }
 
-static QString decodeFontName(u16 code, const char *string, u16 length)
+void DB::updateUninstalledFonts()
 {
-    QString i18n_name;
-
-    // HB is Platform
-    // LB is Encoding
-    switch(code) {
-        case 0x0000:
-        case 0x0003:
-        case 0x0300:
-        case 0x0302:
-        case 0x030A:
-        case 0x0301: {
-            length /= 2;
-            i18n_name.resize(length);
-            QChar *uc = (QChar *) i18n_name.unicode();
+    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
+    QStringList uninstalledFonts = fontaReg.value(QStringLiteral("FontaUninstalledFonts")).toStringList();
+    for(int i = 0; i<uninstalledFonts.count(); ++i) {
+        CStringRef f = uninstalledFonts[i];
 
-            for(int i = 0; i < length; ++i) {
-                uc[i] = getU16(string + 2*i);
-            }
-        } break;
-        case 0x0100:
-        default: {
-            i18n_name.resize(length);
-            QChar *uc = (QChar *) i18n_name.unicode();
-
-            for(int i = 0; i < length; ++i) {
-                uc[i] = QLatin1Char(string[i]);
-            }
-        } break;
+        if(m_catalogue.font(f) == Catalogue::null) {
+            uninstalledFonts.removeAt(i);
+            --i;
+        }
     }
 
-    return i18n_name;
+    // files that couldn't be deleted go back to registry
+    fontaReg.setValue(QStringLiteral("FontaUninstalledFonts"), uninstalledFonts);
 }
 
-void FontReader::readFont()
+QFontDatabase &DB::qtDatabase() const
 {
-    /////////
-    // name
-    ///////
-    const TTFTableRecord &nameOffsetTable = tablesMap[TTFTable::NAME];
-    if(Q_UNLIKELY(!f.seek(nameOffsetTable.Offset))) {
-        return;
+    // expensive (whole fontconfig setup on Linux), so only font rendering pays for it
+    if(!QtDB) {
+        FONTA_TRACE_SPAN("startup", "QFontDatabase");
+        QtDB = new QFontDatabase;
+        reconcileQtFamilies();
     }
 
-    cauto nameHeader = read<TTFNameHeader>();
+    return *QtDB;
+}
 
-    TTFNameRecord nameRecord;
-    bool properLanguage = false; // english-like language
-    const quint64 fileSize = f.size();
-    quint64 nameOffset = 0;
+QStringList DB::catalogueFamilies() const
+{
+    QStringList families;
+    families.reserve(m_catalogue.fontsCount());
+    for(Catalogue::Id font = 0; font<m_catalogue.fontsCount(); ++font) {
+        if(m_catalogue.traits(font).isValid()) {
+            families << m_catalogue.family(font);
+        }
+    }
+    std::sort(families.begin(), families.end(), familyLess);
 
-    for(u16 i = 0; i<nameHeader.RecordsCount; ++i) {
-        cauto record = read<TTFNameRecord>();
+    return families;
+}
 
-        // 1 is FamilyID
-        if(record.NameID != 0x0100) {
-            continue;
-        }
+void DB::buildIndex(QStringList families)
+{
+    FONTA_TRACE_SPAN("classify", "DB::buildIndex");
 
-        const quint64 offset = nameOffsetTable.Offset + nameHeader.StorageOffset + record.StringOffset;
-        if(Q_UNLIKELY(offset > fileSize - (nameRecord.StringLength+1))) {
-            continue;
-        }
+    m_families = std::move(families);
+    const QStringList uninstalledList = uninstalled();
+    for(cauto f : uninstalledList) {
+        m_families.removeAll(f);
+    }
 
-        nameRecord = record;
-        nameOffset = offset;
+    m_aliases.clear();
+    m_fontInfo.clear();
+    m_reconciled.clear();
+    m_aliases.reserve(m_families.size());
+    m_fontInfo.reserve(m_families.size());
 
-        const u8 langCode = record.LanguageID >> 8; // notice that we did not do swap LanguageID bytes! See swap<TTFNameRecord>()
-        if(record.PlatformID == 0x0300) { // Windows platform
-            properLanguage = langCode == 0x09 || // English
-                             langCode == 0x07 || // German
-                             langCode == 0x0C || // French
-                             langCode == 0x0A || // Spanish
-                             langCode == 0x3B;   // Scandinavic
+    for(CStringRef family : std::as_const(m_families)) {
+        const QString key = Catalogue::nameKey(family);
+        if(!m_aliases.contains(key)) {
+            m_aliases.insert(key, family);
         }
 
-        if(Q_UNLIKELY(properLanguage)) {
-            break;
-        }
+        m_fontInfo.insert(family, classifier.trimmedFontInfo(trim(family)));
     }
 
-    const u16 MAX_NAME_SIZE = 1024;
-    if(Q_UNLIKELY(nameRecord.StringLength > MAX_NAME_SIZE)) {
-        nameRecord.StringLength = MAX_NAME_SIZE;
+    // load() blocks GUI thread while this runs, so QtDB can't appear meanwhile
+    if(QtDB) {
+        reconcileQtFamilies();
     }
+}
 
-    char nameBytes[MAX_NAME_SIZE];
-    f.seek(nameOffset);
-    f.read(nameBytes, nameRecord.StringLength);
-
-    const u16 code = (nameRecord.PlatformID & 0xFF00) + (nameRecord.EncodingID >> 8);
-    const QString fontName = decodeFontName(code, nameBytes, nameRecord.StringLength);
-
-#ifdef FONTA_DETAILED_DEBUG
-    if(properLanguage) {
-        qDebug() << '\t' << (nameRecord.PlatformID>>8) << (nameRecord.EncodingID>>8) << (nameRecord.LanguageID>>8) << fontName;
-    } else {
-        qDebug() << '\t' << "not proper!" << (nameRecord.PlatformID>>8) << (nameRecord.EncodingID>>8) << (nameRecord.LanguageID>>8) << fontName;
+QString DB::resolveFamily(CStringRef alias) const
+{
+    const QString key = Catalogue::nameKey(alias);
+    auto it = m_aliases.constFind(key);
+    if(it != m_aliases.constEnd()) {
+        return *it;
     }
-#endif
 
-    CStringRef fileName = f.fileName();
-
-    {
-        std::lock_guard<std::mutex> lock(readFile2Fonts);
-        File2Fonts[fileName] << fontName;
-        (void)lock;
+    // localized, typographic, full or PostScript name of some installed family
+    for(Catalogue::Id font : m_catalogue.fontsNamed(key)) {
+        const QString family = m_catalogue.family(font);
+        if(m_fontInfo.contains(family)) {
+            return family;
+        }
     }
 
-    {
-        std::lock_guard<std::mutex> lock(readTTFMutex);
-        if(TTFs.contains(fontName)) {
-            TTFs[fontName].files << fileName;
-            return;
+    return QString::null;
+}
+
+QString DB::resolveFamily(const QStringList &aliases) const
+{
+    for(CStringRef alias : aliases) {
+        const QString family = resolveFamily(alias);
+        if(!family.isNull()) {
+            return family;
         }
-        (void)lock;
     }
 
-    TTF ttf;
-    ttf.valid = true;
-    ttf.files << std::move(fileName);
-    //qDebug() << '\t' << fontName;
-
-    /////////
-    // OS/2
-    ///////
-    const TTFTableRecord& os2OffsetTable = tablesMap[TTFTable::OS2];
-    f.seek(os2OffsetTable.Offset);
+    return QString::null;
+}
 
-    cauto os2Header = read<TTFOS2Header>();
+QStringList DB::searchFamilies(CStringRef text) const
+{
+    FONTA_TRACE_SPAN("filter", "DB::searchFamilies");
 
-    ttf.panose = os2Header.panose;
+    QStringList families;
+    for(Catalogue::Id font : m_catalogue.searchNames(text)) {
+        const QString family = m_catalogue.family(font);
+        if(m_fontInfo.contains(family)) {
+            families << family;
+        }
+    }
+    std::sort(families.begin(), families.end(), familyLess);
 
-    // notice we did not swap family class, so LowByte is FamilyClass, HighByte is FamilySubclass
-    ttf.familyClass = (FamilyClass::type)(os2Header.FamilyClass & 0xFF);
-    ttf.familySubClass = (int)(os2Header.FamilyClass >> 8);
+    return families;
+}
 
-    cauto langBit = [&os2Header](int bit) {
-        return !!(os2Header.UnicodeRange1 & (1<<bit));
-    };
-    ttf.latin = langBit(0) || langBit(1) || langBit(2) || langBit(3);
-    ttf.cyrillic = langBit(9);
+int DB::fontInfo(CStringRef family) const
+{
+    auto it = m_fontInfo.constFind(family);
+    if(it != m_fontInfo.constEnd()) {
+        return *it;
+    }
 
-    {
-        std::lock_guard<std::mutex> lock(readTTFMutex);
-        TTFs[fontName] = std::move(ttf);
-        (void)lock;
+    // Qt spelling of installed family
+    const Catalogue::Id font = fontOf(family);
+    if(font != Catalogue::null) {
+        it = m_fontInfo.constFind(m_catalogue.family(font));
+        if(it != m_fontInfo.constEnd()) {
+            return *it;
+        }
     }
-}
 
-#ifndef FONTA_DETAILED_DEBUG
+    return classifier.fontInfo(family);
+}
 
-void LoadThread::load()
+Catalogue::Id DB::fontOf(CStringRef family) const
 {
-    for(int i = from; i<=to; ++i) {
-        FontReader reader(TTFs, File2Fonts);
-        reader.readFile(out[i]);
-        emit fileLoaded();
+    const Catalogue::Id font = m_catalogue.font(family);
+    if(font != Catalogue::null) {
+        ++m_lookups.exact;
+        return font;
     }
-}
-
-#endif
-
 
-DB *DB::mInstance = nullptr;
+    auto it = m_reconciled.constFind(family);
+    if(it == m_reconciled.constEnd()) {
+        it = m_reconciled.insert(family, reconcile(family));
+    }
 
-DB *DB::instance() {
-    if (mInstance == nullptr) {
-        mInstance = new DB;
+    if(it->isEmpty()) {
+        ++m_lookups.missed;
+        return Catalogue::null;
     }
 
-    return mInstance;
+    ++m_lookups.reconciled;
+    return it->first();
 }
 
-DB::DB()
+// trailing words Qt keeps in style-linked family names, but catalogue family doesn't have
+static bool isStyleWord(CStringRef word)
 {
+    static const QStringList words = {
+        QStringLiteral("Thin"), QStringLiteral("Hairline"), QStringLiteral("ExtraLight"), QStringLiteral("UltraLight"),
+        QStringLiteral("Light"), QStringLiteral("SemiLight"), QStringLiteral("Regular"), QStringLiteral("Normal"),
+        QStringLiteral("Book"), QStringLiteral("Medium"), QStringLiteral("SemiBold"), QStringLiteral("DemiBold"),
+        QStringLiteral("Bold"), QStringLiteral("ExtraBold"), QStringLiteral("UltraBold"), QStringLiteral("Black"),
+        QStringLiteral("Heavy"), QStringLiteral("Italic"), QStringLiteral("Oblique"), QStringLiteral("Condensed"),
+        QStringLiteral("SemiCondensed"), QStringLiteral("Narrow"), QStringLiteral("Expanded"), QStringLiteral("Extended"),
+    };
 
+    return words.contains(word, Qt::CaseInsensitive);
 }
 
-static u64 dirSize(CStringRef dirName)
+QVector<Catalogue::Id> DB::reconcile(CStringRef family) const
 {
-    QFileInfo info(dirName);
+    QString name = family;
 
-    QDir dir(info.absoluteFilePath());
-    dir.setFilter(QDir::NoDotAndDotDot | QDir::AllDirs | QDir::Files);
-    const QFileInfoList list = dir.entryInfoList();
+    // Qt tells families of several foundries apart as "Family [Foundry]"
+    if(name.endsWith(']')) {
+        const int bracket = name.lastIndexOf(QLatin1String(" ["));
+        if(bracket > 0) {
+            name.truncate(bracket);
+        }
+    }
 
-    u64 size = 0;
+    // then any family-like name (typographic, WWS, full, PostScript), then without style words
+    QStringList words = name.split(' ', QString::SkipEmptyParts);
+    while(!words.isEmpty()) {
+        const QString candidate = words.join(' ');
 
-    for(const QFileInfo &info : list) {
-        if(info.isDir()) {
-            size += dirSize(info.absoluteFilePath());
-            continue;
+        QVector<Catalogue::Id> fonts = m_catalogue.fontsNamed(candidate);
+        const Catalogue::Id exact = m_catalogue.font(candidate);
+        if(exact != Catalogue::null) {
+            fonts.removeAll(exact);
+            fonts.prepend(exact);
         }
 
-        if(info.isFile()) {
-            size += info.size();
+        if(!fonts.isEmpty()) {
+            return fonts;
         }
-    }
 
-    return size;
-}
-
-static u64 fontsDirsSize()
-{
-    u64 size = 0;
-    cauto fontsDirs = QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
-    for(CStringRef dir : fontsDirs) {
-        size += dirSize(dir);
+        if(!isStyleWord(words.last())) {
+            break;
+        }
+        words.removeLast();
     }
 
-    return size;
+    return QVector<Catalogue::Id>();
 }
 
-void DB::load()
+void DB::reconcileQtFamilies() const
 {
-    QtDB = new QFontDatabase;
-    classifier.load(QStringLiteral(":/known_fonts"));
-
-    updateUninstalledFonts();
+    FONTA_TRACE_SPAN("db", "reconcileQtFamilies");
 
-    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
-    u64 hash = fontsDirsSize();
-    bool hash_exists = fontaReg.contains(QStringLiteral("FontsDirHash"));
-    bool cache_exists = QFileInfo(CACHE_FILE).exists();
-    if(cache_exists) {
-        QFile file(CACHE_FILE);
-        file.open(QIODevice::ReadOnly);
-        QDataStream cacheStream(&file);
-        cache_exists = cacheStream.version() == QDataStream::Qt_DefaultCompiledVersion;
-    }
-
-#ifdef FONTA_MEASURES
-        QElapsedTimer timer;
-        timer.start();
-#endif
+    m_qtFamilies = FamilyLookups();
+    m_qtUnmatched.clear();
 
-    if(cache_exists &&
-       hash_exists  &&
-       fontaReg.value(QStringLiteral("FontsDirHash"), static_cast<u64>(-1)) == hash) {
+    for(CStringRef family : QtDB->families()) {
+        if(m_catalogue.font(family) != Catalogue::null) {
+            ++m_qtFamilies.exact;
+            continue;
+        }
 
-#ifdef FONTA_MEASURES
-        qDebug() << "cache load";
-#endif
+        auto it = m_reconciled.constFind(family);
+        if(it == m_reconciled.constEnd()) {
+            it = m_reconciled.insert(family, reconcile(family));
+        }
 
-        QFile file(CACHE_FILE);
-        file.open(QIODevice::ReadOnly);
-        QDataStream cacheStream(&file);
-        cacheStream >> *this;
-        file.close();
+        if(it->isEmpty()) {
+            ++m_qtFamilies.missed;
+            m_qtUnmatched << family;
+        } else {
+            ++m_qtFamilies.reconciled;
+        }
+    }
 
-    } else {
+    trace::counter("db", "qtFamiliesReconciled", m_qtFamilies.reconciled);
+    trace::counter("db", "qtFamiliesMissed", m_qtFamilies.missed);
+}
 
-#ifdef FONTA_MEASURES
-        qDebug() << "no cache";
-#endif
+QString DB::catalogueFamily(CStringRef family) const
+{
+    const Catalogue::Id font = fontOf(family);
+    return font == Catalogue::null ? QString() : m_catalogue.family(font);
+}
 
-        QStringList out;
-        getFontFiles(out);
+QString DB::lookupReport() const
+{
+    cauto line = [](const FamilyLookups &l) {
+        return QCoreApplication::translate("fonta", "%1 exact, %2 reconciled, %3 missed, hit rate %4%\n")
+                .arg(l.exact).arg(l.reconciled).arg(l.missed)
+                .arg(l.hitRate()*100, 0, 'f', 1);
+    };
 
-        filesCount = out.length();
+    QString text = QCoreApplication::translate("fonta", "Family lookups:\n  ") + line(m_lookups);
 
-#ifndef FONTA_DETAILED_DEBUG
-        int cores = std::thread::hardware_concurrency();
-        if(!cores) cores = 4;
-        const int chunkN = out.size() / cores;
+    if(QtDB) {
+        text += QCoreApplication::translate("fonta", "\nQt families:\n  ") + line(m_qtFamilies);
+        for(CStringRef family : m_qtUnmatched) {
+            text += QStringLiteral("    ") + family + '\n';
+        }
+    }
 
-        std::vector<QThread *> threads;
+    return text;
+}
 
-        int from = 0;
-        int to = qMin(chunkN, out.size()-1);
-        for(int i = 0; i<cores; ++i) {
-            QThread *thread = new QThread(this);
-            LoadThread *worker = new LoadThread(out, from, to, TTFs, File2Fonts);
-            worker->moveToThread(thread);
+double FamilyLookups::hitRate() const
+{
+    const int total = exact + reconciled + missed;
+    return total > 0 ? (exact + reconciled) / static_cast<double>(total) : 1.0;
+}
 
-            connect(thread, &QThread::started, worker, &LoadThread::load);
-            connect(worker, &LoadThread::fileLoaded, this, &DB::updateProgress, Qt::DirectConnection);
+static int styleRank(CStringRef style)
+{
+    static const QStringList regular = {
+        QStringLiteral("Regular"), QStringLiteral("Normal"), QStringLiteral("Book"), QStringLiteral("Roman"), QStringLiteral("Plain")
+    };
 
-            thread->start();
+    return regular.contains(style, Qt::CaseInsensitive) ? 0 : 1;
+}
 
-            threads.push_back(thread);
-            from = to+1;
+QStringList DB::styles(CStringRef family) const
+{
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
+        return QStringList();
+    }
 
-            if(i+1 >= (cores-1)) {
-                to = out.size()-1;
-            } else {
-                to += chunkN;
-            }
-        }
+    QVector<FontFace> faces = m_catalogue.faces(font);
+    faces.erase(std::remove_if(faces.begin(), faces.end(), [](const FontFace &f) { return f.style.isEmpty(); }), faces.end());
 
-        for(auto *t : threads) {
-            t->quit();
-            t->wait();
-            t->deleteLater();
-        }
-#else
-        for(int i = 0; i<out.size(); ++i) {
-            FontReader reader(TTFs, File2Fonts);
-            reader.readFile(out[i]);
-        }
-#endif
+    // bitmap fonts have no subfamily names
+    if(faces.isEmpty()) {
+        return QStringList(QStringLiteral("Regular"));
+    }
 
-        // analyse fonts on common files
-        for(cauto fontName : std::as_const(TTFs)) {
-            auto &TTF = TTFs[fontName.first];
-            for(cauto f : TTF.files) {
-                TTF.linkedFonts.unite(File2Fonts[f]);
-            }
-            TTF.linkedFonts.remove(fontName.first); // remove itself
-        }
+    // regular face goes first, it's the default one, then as type specimens order them
+    std::stable_sort(faces.begin(), faces.end(), [](const FontFace &a, const FontFace &b) {
+        const int ra = styleRank(a.style);
+        const int rb = styleRank(b.style);
+        if(ra != rb) return ra < rb;
+        if(a.width != b.width) return a.width < b.width;
+        if(a.weight != b.weight) return a.weight < b.weight;
+        return !a.isItalic() && b.isItalic();
+    });
 
-        fontaReg.setValue(QStringLiteral("FontsDirHash"), hash);
+    QStringList styles;
+    for(const FontFace &f : std::as_const(faces)) {
+        styles << f.style;
+    }
+    return styles;
+}
 
-        QFile file(CACHE_FILE);
-        file.open(QIODevice::WriteOnly);
-        QDataStream cacheStream(&file);   // we will serialize the data into the file
-        cacheStream.setVersion(QDataStream::Qt_DefaultCompiledVersion);
-        cacheStream << *this;
-        file.close();
+QVector<FontFace> DB::faces(CStringRef family) const
+{
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
+        return QVector<FontFace>();
     }
 
-#ifdef FONTA_MEASURES
-        qDebug() << timer.elapsed() << "milliseconds to load fonts";
-        qDebug() << TTFs.size() << "fonts loaded";
-#endif
+    return m_catalogue.faces(font);
+}
 
-    emit loadFinished();
+// QFont weight nearest to usWeightClass, the same steps Qt maps OS/2 weights with
+static int qtWeight(int weight)
+{
+    if(weight < 150) return QFont::Thin;
+    if(weight < 250) return QFont::ExtraLight;
+    if(weight < 350) return QFont::Light;
+    if(weight < 450) return QFont::Normal;
+    if(weight < 550) return QFont::Medium;
+    if(weight < 650) return QFont::DemiBold;
+    if(weight < 750) return QFont::Bold;
+    if(weight < 850) return QFont::ExtraBold;
+    return QFont::Black;
 }
 
-void DB::updateProgress()
+QFont DB::font(CStringRef family, CStringRef style, int pointSize) const
 {
-    int newProgress = (int)((++loadedFiles)/(float)filesCount*100);
-    if(progress != newProgress) {
-        progress = newProgress;
-        emit emitProgress(progress);
-    }
+    const Catalogue::Id id = fontOf(family);
+    const int face = id == Catalogue::null ? -1 : m_catalogue.face(id, style);
+    if(face < 0) {
+        return qtDatabase().font(family, style, pointSize);
+    }
+
+    // style name picks the face, the rest is for fallback fonts
+    const FontFace f = m_catalogue.face(id, face);
+    QFont font(family, pointSize, qtWeight(f.weight), f.isItalic());
+    font.setStretch(f.stretch());
+    font.setStyleName(style);
+    return font;
 }
 
-DB::~DB()
+bool DB::hasWeight(CStringRef family, int min, int max) const
 {
-    delete QtDB;
+    const Catalogue::Id font = fontOf(family);
+    return font != Catalogue::null && m_catalogue.hasWeight(font, min, max);
 }
 
-void DB::updateUninstalledFonts()
+bool DB::hasWidth(CStringRef family, int min, int max) const
 {
-    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
-    QStringList uninstalledFonts = fontaReg.value(QStringLiteral("FontaUninstalledFonts")).toStringList();
-    for(int i = 0; i<uninstalledFonts.count(); ++i) {
-        CStringRef f = uninstalledFonts[i];
+    const Catalogue::Id font = fontOf(family);
+    return font != Catalogue::null && m_catalogue.hasWidth(font, min, max);
+}
 
-        if(!QtDB->families().contains(f)) {
-            uninstalledFonts.removeAt(i);
-            --i;
-        }
+bool DB::isItalic(CStringRef family) const
+{
+    const Catalogue::Id font = fontOf(family);
+    return font != Catalogue::null && m_catalogue.hasItalic(font);
+}
+
+QVector<FontAxis> DB::axes(CStringRef family) const
+{
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
+        return QVector<FontAxis>();
     }
 
-    // files that couldn't be deleted go back to registry
-    fontaReg.setValue(QStringLiteral("FontaUninstalledFonts"), uninstalledFonts);
+    return m_catalogue.axes(font);
 }
 
-QStringList DB::families() const
+bool DB::isVariable(CStringRef family) const
 {
-    QStringList fonts = QtDB->families();
-    const QStringList uninstalledList = uninstalled();
-    for(cauto f : uninstalledList) {
-        fonts.removeAll(f);
-    }
+    const Catalogue::Id font = fontOf(family);
+    return font != Catalogue::null && m_catalogue.isVariable(font);
+}
 
-    return fonts;
+bool DB::hasAxis(CStringRef family, CStringRef tag, double min, double max) const
+{
+    const Catalogue::Id font = fontOf(family);
+    return font != Catalogue::null && m_catalogue.hasAxis(font, FontAxis::tagFromString(tag), min, max);
 }
 
 QStringList DB::linkedFonts(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
-    if(ttf.isNull()) {
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
         return QStringList();
     }
 
-    return ttf.linkedFonts.toList();
+    return m_catalogue.linkedFonts(font);
 }
 
 QStringList DB::fontFiles(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
-    if(ttf.isNull()) {
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
         return QStringList();
     }
 
-    return ttf.files.toList();
+    return m_catalogue.files(font);
+}
+
+const Coverage &DB::coverage(CStringRef family) const
+{
+    static const Coverage none;
+
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
+        return none;
+    }
+
+    return m_catalogue.coverage(font);
+}
+
+QStringList DB::familiesRendering(CStringRef text) const
+{
+    FONTA_TRACE_SPAN("filter", "DB::familiesRendering");
+
+    const QVector<u32> codePoints = Coverage::codePoints(text);
+
+    QStringList families;
+    for(CStringRef family : m_families) {
+        const Coverage &c = m_catalogue.coverage(m_catalogue.font(family));
+        if(!c.isEmpty() && c.containsAll(codePoints)) {
+            families << family;
+        }
+    }
+    return families;
 }
 
 void DB::uninstall(CStringRef family)
@@ -843,11 +958,12 @@ void DB::uninstall(CStringRef family)
     QSettings uninstalledReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
     uninstalledReg.setValue(QStringLiteral("FontaUninstalledFonts"), uninstalledList);
 
-    // Register Files to Remove
-    cauto files = fontaDB().fontFiles(family); // "C:/Windows/Fonts/arial.ttf"
-
+    // Register Files to Remove, linked fonts are hidden so their files go too
     QStringList filesToDeleteList = filesToDelete();
-    filesToDeleteList << files;
+    filesToDeleteList << fontFiles(family); // "C:/Windows/Fonts/arial.ttf"
+    for(CStringRef linked : linkedFonts(family)) {
+        filesToDeleteList << fontFiles(linked);
+    }
     filesToDeleteList.removeDuplicates();
 
     QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
@@ -858,6 +974,14 @@ void DB::uninstall(CStringRef family)
     QProcess p;
     p.start(QStringLiteral("cmd.exe"), QStringList() << QStringLiteral("/c") << QStringLiteral("fonts_cleaner.bat"));
     p.waitForFinished();
+
+    const QStringList before = m_families;
+    buildIndex(m_families);
+
+    const CatalogueDelta delta = diff(before, m_families);
+    if(!delta.isEmpty()) {
+        emit catalogueChanged(delta);
+    }
 }
 
 QStringList DB::uninstalled() const
@@ -872,30 +996,29 @@ QStringList DB::filesToDelete() const
     return fontaReg.value(QStringLiteral("FilesToDelete"), QStringList()).toStringList();
 }
 
-const TTF &DB::getTTF(CStringRef family) const {
-    if(!TTFs.contains(family)) {
-        return TTF::null;
-    }
-
-    return TTFs.at(family);
+FontTraits DB::traits(CStringRef family) const
+{
+    return m_catalogue.traits(fontOf(family));
 }
 
 FullFontInfo DB::getFullFontInfo(CStringRef family) const
 {
     FullFontInfo fullInfo;
 
-    const TTF &ttf = getTTF(family);
-    fullInfo.TTFExists = ttf.isValid();
-    fullInfo.fontaTFF = &ttf;
+    fullInfo.traits = traits(family);
+    fullInfo.TTFExists = fullInfo.traits.isValid();
+    fullInfo.files = fontFiles(family);
+    fullInfo.linkedFonts = linkedFonts(family);
 
-    fullInfo.qtInfo.cyrillic = QtDB->writingSystems(family).contains(QFontDatabase::Cyrillic);
-    fullInfo.qtInfo.symbolic = QtDB->writingSystems(family).contains(QFontDatabase::Symbol);
-    fullInfo.qtInfo.monospaced = QtDB->isFixedPitch(family);
+    QFontDatabase &qt = qtDatabase();
+    fullInfo.qtInfo.cyrillic = qt.writingSystems(family).contains(QFontDatabase::Cyrillic);
+    fullInfo.qtInfo.symbolic = qt.writingSystems(family).contains(QFontDatabase::Symbol);
+    fullInfo.qtInfo.monospaced = qt.isFixedPitch(family);
 
     return fullInfo;
 }
 
-static bool _isSerif(const TTF& ttf)
+static bool _isSerif(const FontTraits& ttf)
 {
     if(FamilyClass::isSerif(ttf.familyClass)) {
         return true;
@@ -912,13 +1035,13 @@ static bool _isSerif(const TTF& ttf)
 bool DB::isSerif(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return FontType::isSerif(info);
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -926,7 +1049,7 @@ bool DB::isSerif(CStringRef family) const
     return _isSerif(ttf);
 }
 
-static bool _isSansSerif(const TTF& ttf)
+static bool _isSansSerif(const FontTraits& ttf)
 {
     if(FamilyClass::isSans(ttf.familyClass)) {
         return true;
@@ -943,13 +1066,13 @@ static bool _isSansSerif(const TTF& ttf)
 bool DB::isSansSerif(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return FontType::isSans(info);
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -960,35 +1083,30 @@ bool DB::isSansSerif(CStringRef family) const
 bool DB::isMonospaced(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Monospaced;
     }
 
     // 2
-    bool qt = false;
-    bool panose = false;
-
-    qt = QtDB->isFixedPitch(family);
-
-    const TTF &ttf = getTTF(family);
-    if(ttf.isValid()) {
-        panose = ttf.panose.isMonospaced();
+    const FontTraits ttf = traits(family);
+    if(ttf.isNull()) {
+        return false;
     }
 
-    return qt || panose;
+    return ttf.monospaced || ttf.panose.isMonospaced();
 }
 
 bool DB::isScript(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Script;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1008,13 +1126,13 @@ bool DB::isScript(CStringRef family) const
 bool DB::isDecorative(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Display;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1034,7 +1152,7 @@ bool DB::isDecorative(CStringRef family) const
 bool DB::isSymbolic(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Symbolic;
     }
@@ -1044,7 +1162,7 @@ bool DB::isSymbolic(CStringRef family) const
         return true;*/
 
     // 3
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1066,13 +1184,13 @@ bool DB::isSymbolic(CStringRef family) const
 bool DB::isOldStyle(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Oldstyle;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1086,13 +1204,13 @@ bool DB::isOldStyle(CStringRef family) const
 bool DB::isTransitional(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Transitional;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1106,13 +1224,13 @@ bool DB::isTransitional(CStringRef family) const
 bool DB::isModern(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Modern;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1123,13 +1241,13 @@ bool DB::isModern(CStringRef family) const
 bool DB::isSlab(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Slab;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1140,7 +1258,7 @@ bool DB::isSlab(CStringRef family) const
 
 bool DB::isCoveSerif(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1157,7 +1275,7 @@ bool DB::isCoveSerif(CStringRef family) const
 
 bool DB::isSquareSerif(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1174,7 +1292,7 @@ bool DB::isSquareSerif(CStringRef family) const
 
 bool DB::isBoneSerif(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1190,7 +1308,7 @@ bool DB::isBoneSerif(CStringRef family) const
 
 bool DB::isAsymmetricSerif(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1206,7 +1324,7 @@ bool DB::isAsymmetricSerif(CStringRef family) const
 
 bool DB::isTriangleSerif(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1224,13 +1342,13 @@ bool DB::isTriangleSerif(CStringRef family) const
 bool DB::isGrotesque(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Grotesque;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1246,13 +1364,13 @@ bool DB::isGrotesque(CStringRef family) const
 bool DB::isGeometric(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Geometric;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1265,13 +1383,13 @@ bool DB::isGeometric(CStringRef family) const
 bool DB::isHumanist(CStringRef family) const
 {
     // 1
-    int info = classifier.fontInfo(family);
+    int info = fontInfo(family);
     if(FontType::exists(info)) {
         return info & FontType::Humanist;
     }
 
     // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1283,7 +1401,7 @@ bool DB::isHumanist(CStringRef family) const
 
 bool DB::isNormalSans(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1301,7 +1419,7 @@ bool DB::isNormalSans(CStringRef family) const
 
 bool DB::isRoundedSans(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1317,7 +1435,7 @@ bool DB::isRoundedSans(CStringRef family) const
 
 bool DB::isFlarredSans(CStringRef family) const
 {
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1331,6 +1449,59 @@ bool DB::isFlarredSans(CStringRef family) const
     return ttf.panose.SerifStyle == Panose::SerifStyle::FLARED;
 }
 
+u64 DB::predicates(CStringRef family) const
+{
+    using Test = bool (DB::*)(CStringRef) const;
+    static const QVector<QPair<Test, u64>> tests = {
+        {&DB::isSerif,           Predicate::Serif},
+        {&DB::isSansSerif,       Predicate::SansSerif},
+        {&DB::isMonospaced,      Predicate::Monospaced},
+        {&DB::isScript,          Predicate::Script},
+        {&DB::isDecorative,      Predicate::Decorative},
+        {&DB::isSymbolic,        Predicate::Symbolic},
+        {&DB::isOldStyle,        Predicate::OldStyle},
+        {&DB::isTransitional,    Predicate::Transitional},
+        {&DB::isModern,          Predicate::Modern},
+        {&DB::isSlab,            Predicate::Slab},
+        {&DB::isCoveSerif,       Predicate::CoveSerif},
+        {&DB::isSquareSerif,     Predicate::SquareSerif},
+        {&DB::isBoneSerif,       Predicate::BoneSerif},
+        {&DB::isAsymmetricSerif, Predicate::AsymmetricSerif},
+        {&DB::isTriangleSerif,   Predicate::TriangleSerif},
+        {&DB::isGrotesque,       Predicate::Grotesque},
+        {&DB::isGeometric,       Predicate::Geometric},
+        {&DB::isHumanist,        Predicate::Humanist},
+        {&DB::isNormalSans,      Predicate::NormalSans},
+        {&DB::isRoundedSans,     Predicate::RoundedSans},
+        {&DB::isFlarredSans,     Predicate::FlarredSans},
+        {&DB::isCyrillic,        Predicate::Cyrillic},
+        {&DB::isGreek,           Predicate::Greek},
+        {&DB::isArmenian,        Predicate::Armenian},
+        {&DB::isHebrew,          Predicate::Hebrew},
+        {&DB::isArabic,          Predicate::Arabic},
+        {&DB::isDevanagari,      Predicate::Devanagari},
+        {&DB::isThai,            Predicate::Thai},
+        {&DB::isGeorgian,        Predicate::Georgian},
+        {&DB::isChinese,         Predicate::Chinese},
+        {&DB::isJapanese,        Predicate::Japanese},
+        {&DB::isKorean,          Predicate::Korean},
+        {&DB::isLight,           Predicate::Light},
+        {&DB::isBold,            Predicate::Bold},
+        {&DB::isCondensed,       Predicate::Condensed},
+        {&DB::isExpanded,        Predicate::Expanded},
+        {&DB::isItalic,          Predicate::Italic},
+        {&DB::isVariable,        Predicate::Variable},
+    };
+
+    u64 bits = 0;
+    for(cauto test : tests) {
+        if((this->*test.first)(family)) {
+            bits |= test.second;
+        }
+    }
+    return bits;
+}
+
 bool DB::isNonCyrillic(CStringRef family) const
 {
     return !isCyrillic(family);
@@ -1338,12 +1509,7 @@ bool DB::isNonCyrillic(CStringRef family) const
 
 bool DB::isCyrillic(CStringRef family) const
 {
-    // 1
-    if(QtDB->writingSystems(family).contains(QFontDatabase::Cyrillic))
-        return true;
-
-    // 2
-    const TTF &ttf = getTTF(family);
+    const FontTraits ttf = traits(family);
     if(ttf.isNull()) {
         return false;
     }
@@ -1351,6 +1517,16 @@ bool DB::isCyrillic(CStringRef family) const
     return ttf.cyrillic;
 }
 
+bool DB::supports(CStringRef family, Script::type script) const
+{
+    const Catalogue::Id font = fontOf(family);
+    if(font == Catalogue::null) {
+        return false;
+    }
+
+    return m_catalogue.supports(font, script);
+}
+
 /*bool DB::isNotLatinOrCyrillic(CStringRef family) const
 {
     cauto systems = QtDB->writingSystems(family);
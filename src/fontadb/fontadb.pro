@@ -9,15 +9,33 @@ TEMPLATE = lib
 CONFIG += staticlib
 
 SOURCES += \
+    catalogue.cpp \
+    coverage.cpp \
     fontadb.cpp \
+    fontconfigsource.cpp \
+    fontreader.cpp \
     classifier.cpp \
-    serialization.cpp
+    serialization.cpp \
+    scanprogress.cpp \
+    scanreport.cpp \
+    taskgraph.cpp \
+    trace.cpp
 
 HEADERS += \
+    $${INCLUDE_PATH}/catalogue.h \
+    $${INCLUDE_PATH}/coverage.h \
     $${INCLUDE_PATH}/fontadb.h \
+    $${INCLUDE_PATH}/fontrecord.h \
+    $${INCLUDE_PATH}/fontconfigsource.h \
+    $${INCLUDE_PATH}/fontreader.h \
+    $${INCLUDE_PATH}/sfnt.h \
     $${INCLUDE_PATH}/panose.h \
     $${INCLUDE_PATH}/types.h \
     $${INCLUDE_PATH}/classifier.h \
+    $${INCLUDE_PATH}/scanprogress.h \
+    $${INCLUDE_PATH}/scanreport.h \
+    $${INCLUDE_PATH}/taskgraph.h \
+    $${INCLUDE_PATH}/trace.h \
     serialization.h
 
 VERSION = 0.0.1
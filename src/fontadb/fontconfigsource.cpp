@@ -0,0 +1,238 @@
+#include "fontconfigsource.h"
+#include "trace.h"
+
+#include <QSettings>
+#include <QtAlgorithms>
+
+#ifdef FONTA_FONTCONFIG
+#include <fontconfig/fontconfig.h>
+#endif
+
+namespace fonta {
+
+bool FontconfigSource::available()
+{
+#ifdef FONTA_FONTCONFIG
+    QSettings fontaReg(QStringLiteral("PitM"), QStringLiteral("Fonta"));
+    return fontaReg.value(QStringLiteral("Fontconfig"), true).toBool();
+#else
+    return false;
+#endif
+}
+
+#ifdef FONTA_FONTCONFIG
+
+// the same formats FontReader::fontFiles() picks up, rescan reparses exactly these files
+static bool readable(CStringRef file)
+{
+    static const QStringList suffixes = {
+        QStringLiteral(".ttf"), QStringLiteral(".otf"), QStringLiteral(".ttc"), QStringLiteral(".otc"), QStringLiteral(".fon")
+    };
+
+    for(CStringRef suffix : suffixes) {
+        if(file.endsWith(suffix, Qt::CaseInsensitive)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// english name (family or style) if there is one, as FontReader prefers it too
+static QString localizedName(FcPattern *font, const char *object, const char *langObject)
+{
+    QString first;
+
+    FcChar8 *value = nullptr;
+    for(int i = 0; FcPatternGetString(font, object, i, &value) == FcResultMatch; ++i) {
+        const QString name = QString::fromUtf8(reinterpret_cast<const char *>(value));
+        if(i == 0) {
+            first = name;
+        }
+
+        FcChar8 *lang = nullptr;
+        if(FcPatternGetString(font, langObject, i, &lang) == FcResultMatch
+        && qstrncmp(reinterpret_cast<const char *>(lang), "en", 2) == 0) {
+            return name;
+        }
+    }
+
+    return first;
+}
+
+static Coverage coverage(const FcCharSet *charset)
+{
+    Coverage::Builder builder;
+    if(!charset) {
+        return builder.build();
+    }
+
+    FcChar32 map[FC_CHARSET_MAP_SIZE];
+    FcChar32 next = 0;
+    for(FcChar32 base = FcCharSetFirstPage(charset, map, &next); base != FC_CHARSET_DONE; base = FcCharSetNextPage(charset, map, &next)) {
+        for(int word = 0; word<FC_CHARSET_MAP_SIZE; ++word) {
+            for(FcChar32 bits = map[word]; bits; bits &= bits - 1) {
+                builder.add(base + word*32 + qCountTrailingZeroBits(bits));
+            }
+        }
+    }
+
+    return builder.build();
+}
+
+// the same fields FontReader takes from OS/2 and post, as close as fontconfig tells them
+static FontFace face(FcPattern *font, CStringRef style)
+{
+    FontFace face;
+    face.style = style;
+
+    int weight = FC_WEIGHT_REGULAR;
+    if(FcPatternGetInteger(font, FC_WEIGHT, 0, &weight) == FcResultMatch) {
+        face.weight = static_cast<u16>(qBound(1, FcWeightToOpenType(weight), 1000));
+    }
+
+    int width = FC_WIDTH_NORMAL;
+    if(FcPatternGetInteger(font, FC_WIDTH, 0, &width) == FcResultMatch) {
+        face.width = FontFace::widthClass(width);
+    }
+
+    int slant = FC_SLANT_ROMAN;
+    FcPatternGetInteger(font, FC_SLANT, 0, &slant);
+    if(slant == FC_SLANT_ITALIC) {
+        face.selection |= FontFace::Italic;
+    } else if(slant == FC_SLANT_OBLIQUE) {
+        face.selection |= FontFace::Oblique;
+    }
+    if(face.weight >= 700) {
+        face.selection |= FontFace::Bold;
+    }
+    if(slant == FC_SLANT_ROMAN && face.weight == 400) {
+        face.selection |= FontFace::Regular;
+    }
+
+    // fontconfig lists named instances of variable fonts as faces of their own
+    int index = 0;
+    if(FcPatternGetInteger(font, FC_INDEX, 0, &index) == FcResultMatch && (index >> 16) > 0) {
+        face.instance = static_cast<i16>((index >> 16) - 1);
+    }
+
+    return face;
+}
+
+static bool hasLang(const FcLangSet *langs, const char *lang)
+{
+    return langs && FcLangSetHasLang(langs, reinterpret_cast<const FcChar8 *>(lang)) != FcLangDifferentLang;
+}
+
+bool FontconfigSource::read(TTFMap &TTFs, File2FontsMap &File2Fonts, const QStringList &skip)
+{
+    FONTA_TRACE_SPAN("crawl", "fontconfig");
+
+    if(!FcInit()) {
+        return false;
+    }
+
+    FcPattern *pattern = FcPatternCreate();
+    FcObjectSet *objects = FcObjectSetBuild(FC_FAMILY, FC_FAMILYLANG, FC_STYLE, FC_STYLELANG, FC_WEIGHT, FC_WIDTH, FC_SLANT, FC_SPACING, FC_FILE, FC_INDEX, FC_LANG, FC_CHARSET, nullptr);
+    FcFontSet *set = FcFontList(nullptr, pattern, objects);
+
+    FcObjectSetDestroy(objects);
+    FcPatternDestroy(pattern);
+
+    if(!set) {
+        return false;
+    }
+
+    const QSet<QString> skipped = skip.toSet();
+
+    for(int i = 0; i<set->nfont; ++i) {
+        FcPattern *font = set->fonts[i];
+
+        FcChar8 *file = nullptr;
+        if(FcPatternGetString(font, FC_FILE, 0, &file) != FcResultMatch) {
+            continue;
+        }
+
+        const QString fileName = QString::fromUtf8(reinterpret_cast<const char *>(file));
+        if(!readable(fileName) || skipped.contains(fileName)) {
+            continue;
+        }
+
+        const QString name = localizedName(font, FC_FAMILY, FC_FAMILYLANG);
+        if(name.isEmpty()) {
+            continue;
+        }
+
+        FcLangSet *langs = nullptr;
+        FcPatternGetLangSet(font, FC_LANG, 0, &langs);
+
+        FcCharSet *charset = nullptr;
+        FcPatternGetCharSet(font, FC_CHARSET, 0, &charset);
+
+        int spacing = FC_PROPORTIONAL;
+        FcPatternGetInteger(font, FC_SPACING, 0, &spacing);
+
+        const QString style = localizedName(font, FC_STYLE, FC_STYLELANG);
+
+        File2Fonts[fileName] << name;
+
+        TTF &ttf = TTFs[name];
+        ttf.valid = true;
+        ttf.files << fileName;
+        ttf.addFace(face(font, style));
+        // languages stand for OS/2 ranges until the first scan reads real ones
+        for(int script = 0; script<Script::count; ++script) {
+            if(hasLang(langs, Script::lang(static_cast<Script::type>(script)))) {
+                const int bit = Script::unicodeBit(static_cast<Script::type>(script));
+                ttf.unicodeRange[bit/32] |= 1u << (bit%32);
+            }
+        }
+        ttf.latin = ttf.supports(Script::Latin);
+        ttf.cyrillic = ttf.supports(Script::Cyrillic);
+        ttf.monospaced |= spacing >= FC_MONO;
+        ttf.coverage = ttf.coverage.united(coverage(charset));
+    }
+
+    trace::counter("crawl", "fontconfigFaces", set->nfont);
+    FcFontSetDestroy(set);
+
+    return true;
+}
+
+QStringList FontconfigSource::fontDirs()
+{
+    QStringList dirs;
+    if(!FcInit()) {
+        return dirs;
+    }
+
+    FcStrList *list = FcConfigGetFontDirs(nullptr);
+    if(!list) {
+        return dirs;
+    }
+
+    for(FcChar8 *dir = FcStrListNext(list); dir; dir = FcStrListNext(list)) {
+        dirs << QString::fromUtf8(reinterpret_cast<const char *>(dir));
+    }
+    FcStrListDone(list);
+
+    return dirs;
+}
+
+#else
+
+bool FontconfigSource::read(TTFMap &TTFs, File2FontsMap &File2Fonts, const QStringList &skip)
+{
+    (void)TTFs;
+    (void)File2Fonts;
+    (void)skip;
+    return false;
+}
+
+QStringList FontconfigSource::fontDirs()
+{
+    return QStringList();
+}
+
+#endif
+
+} // namespace fonta
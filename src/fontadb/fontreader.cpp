@@ -0,0 +1,1061 @@
+#include "fontreader.h"
+#include "trace.h"
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSettings>
+#include <QDebug>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fonta {
+
+static std::mutex readTTFMutex;
+static std::mutex readFile2Fonts;
+
+template <typename T>
+inline T read_raw(QFile &f)
+{
+    T data;
+    f.read((char*)&data, sizeof(T));
+
+    return data;
+}
+
+template <typename T> inline T read(QFile &f)
+{
+    T data = read_raw<T>(f);
+    swap(data);
+
+    return data;
+}
+
+template <>
+inline TTFOffsetTable read<TTFOffsetTable>(QFile &f)
+{
+    auto data = read_raw<TTFOffsetTable>(f);
+    swap(data.NumTables); // this is the only usefull field
+    return data;
+}
+
+template <>
+inline TTFTableRecord read<TTFTableRecord>(QFile &f)
+{
+    auto data = read_raw<TTFTableRecord>(f);
+
+    swap(data.Offset);
+    swap(data.Length);
+    // do NOT swap TableName and CheckSum
+
+    return data;
+}
+
+template <>
+inline TTFOS2Header read<TTFOS2Header>(QFile &f)
+{
+    auto data = read_raw<TTFOS2Header>(f);
+
+    swap(data.WeightClass);
+    swap(data.WidthClass);
+    swap(data.Selection);
+    swap(data.UnicodeRange1);
+    swap(data.UnicodeRange2);
+    swap(data.UnicodeRange3);
+    swap(data.UnicodeRange4);
+    swap(data.CodePageRange1);
+    swap(data.CodePageRange2);
+    // do not swap family class
+
+    return data;
+}
+
+template <>
+inline TTFPostHeader read<TTFPostHeader>(QFile &f)
+{
+    auto data = read_raw<TTFPostHeader>(f);
+
+    swap(data.ItalicAngle);
+    swap(data.IsFixedPitch);
+    return data;
+}
+
+template <>
+inline TTFCmapHeader read<TTFCmapHeader>(QFile &f)
+{
+    auto data = read_raw<TTFCmapHeader>(f);
+
+    swap(data.TablesCount);
+    return data;
+}
+
+template <>
+inline TTFCmapEncodingRecord read<TTFCmapEncodingRecord>(QFile &f)
+{
+    auto data = read_raw<TTFCmapEncodingRecord>(f);
+
+    swap(data.PlatformID);
+    swap(data.EncodingID);
+    swap(data.Offset);
+    return data;
+}
+
+FontReader::FontReader(TTFMap &TTFs, File2FontsMap &File2Fonts, ScanReport *report)
+    : TTFs(TTFs)
+    , File2Fonts(File2Fonts)
+    , report(report)
+{
+    memset(tablesMap, 0, TTFTable::count*sizeof(TTFTableRecord));
+}
+
+FontReader::~FontReader()
+{
+    f.close();
+}
+
+template <typename T> inline T FontReader::read()
+{
+    scan.bytes += sizeof(T);
+    return fonta::read<T>(f);
+}
+
+template <typename T> inline T FontReader::readRaw()
+{
+    scan.bytes += sizeof(T);
+    return fonta::read_raw<T>(f);
+}
+
+qint64 FontReader::readData(char *data, qint64 size)
+{
+    const qint64 n = f.read(data, size);
+    if(n > 0) {
+        scan.bytes += n;
+    }
+    return n;
+}
+
+void FontReader::fail(ScanError::type error)
+{
+    // first error of file is the reason, collection faces after it are still counted
+    if(scan.error == ScanError::None) {
+        scan.error = error;
+    }
+}
+
+qint64 FontReader::readFile(CStringRef fileName)
+{
+    FONTA_TRACE_SPAN("parse", "readFile");
+
+#ifdef FONTA_DETAILED_DEBUG
+    qDebug() << qPrintable(QFileInfo(fileName).fileName()) << ":";
+#endif
+
+    QElapsedTimer timer;
+    timer.start();
+
+    scan = FileScan();
+    scan.file = fileName;
+
+    f.setFileName(fileName);
+
+    if (Q_UNLIKELY(!f.open(QIODevice::ReadOnly))) {
+        fail(ScanError::Open);
+    } else if(fileName.endsWith(QLatin1String(".ttc"), Qt::CaseInsensitive) || fileName.endsWith(QLatin1String(".otc"), Qt::CaseInsensitive)) {
+        readTTC();
+    } else if(fileName.endsWith(QLatin1String(".fon"), Qt::CaseInsensitive)) {
+        readFON();
+    } else {
+        readTTF();
+    }
+
+    const qint64 size = f.size();
+    f.close();
+
+    if(Q_UNLIKELY(scan.error != ScanError::None)) {
+        qWarning() << fileName << ':' << ScanError::toString(scan.error);
+    }
+
+    if(report) {
+        scan.duration = timer.nsecsElapsed();
+        report->add(std::move(scan));
+    }
+
+    return size;
+}
+
+void FontReader::readFON()
+{
+    f.seek(60);
+    u16 headOffset = readRaw<u16>() + 4;
+
+    f.seek(headOffset);
+    u16 fontresOffset = readRaw<u16>();
+
+    f.seek(headOffset + 28);
+    u16 length = readRaw<u16>();
+
+    if(Q_UNLIKELY(!f.seek(headOffset + fontresOffset - 1))) {
+        fail(ScanError::Truncated);
+        return;
+    }
+
+    char *bytes = new char[length];
+    readData(bytes, length);
+
+    QString name(bytes);
+
+    delete [] bytes;
+
+    QStringRef nameRef(&name);
+    nameRef = nameRef.mid(name.indexOf(':') + 1);
+
+    const int ipareth = nameRef.indexOf('(');
+    const int icomma = nameRef.indexOf(',');
+
+    if(icomma == -1 && ipareth != -1) {
+        nameRef.truncate(ipareth);
+    } else if(icomma != -1) {
+        for(int i = icomma-1; i>=0; --i) {
+            if(!nameRef.at(i).isDigit()) {
+                nameRef.truncate(i+1);
+                break;
+            }
+        }
+    }
+
+    int i = nameRef.indexOf(QLatin1String("Font for "));
+    if(i != -1) {
+        nameRef.truncate(i);
+    }
+
+    i = nameRef.indexOf(QLatin1String(" Font "));
+    if(i != -1) {
+        nameRef.truncate(i);
+    }
+
+    i = nameRef.indexOf(QLatin1String(" for "));
+    if(i != -1) {
+        nameRef.truncate(i);
+    }
+
+    name = nameRef.trimmed().toString();
+
+#ifdef FONTA_DETAILED_DEBUG
+    qDebug() << '\t' << name;
+#endif
+
+    ++scan.faces;
+
+    CStringRef fileName = f.fileName();
+
+    {
+        std::lock_guard<std::mutex> lock(readFile2Fonts);
+        File2Fonts[fileName] << name;
+        (void)lock;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(readTTFMutex);
+        if(TTFs.contains(name)) {
+            TTFs[name].files << f.fileName();
+            return;
+        }
+        (void)lock;
+    }
+
+    TTF ttf;
+    ttf.valid = true;
+    ttf.files << std::move(fileName);
+
+    {
+        std::lock_guard<std::mutex> lock(readTTFMutex);
+        TTFs[name] = std::move(ttf);
+        (void)lock;
+    }
+}
+
+void FontReader::readTTC()
+{
+    f.seek(8);
+
+    const u32 offsetTablesCount = read<u32>();
+    if(Q_UNLIKELY(offsetTablesCount*sizeof(u32) > static_cast<u64>(f.size()))) {
+        fail(ScanError::Collection);
+        return;
+    }
+
+    std::vector<u32> offsets(offsetTablesCount);
+    readData((char*)offsets.data(), offsetTablesCount*sizeof(u32));
+
+    for(u32 offset : std::as_const(offsets)) {
+        swap(offset);
+        if(Q_LIKELY(f.seek(offset))) {
+            readTTF();
+        } else {
+            fail(ScanError::Collection);
+        }
+    }
+}
+
+void FontReader::readTTF()
+{
+    // faces of collection don't share optional tables
+    memset(tablesMap, 0, TTFTable::count*sizeof(TTFTableRecord));
+
+    cauto ttcHeader = read<TTFOffsetTable>();
+
+    qint64 dataSize = ttcHeader.NumTables*sizeof(TTFTableRecord);
+    if(Q_UNLIKELY(dataSize > f.size())) {
+        fail(ScanError::Truncated);
+        return;
+    }
+
+    u8 *data = new u8[dataSize];
+    readData((char*)data, dataSize);
+
+    u8 *dataPtr = data;
+
+    int tablesCount = 0;
+    for(int i = 0; i<ttcHeader.NumTables; ++i) {
+        tablesCount += (int)readTablesMap(dataPtr);
+        if(tablesCount == TTFTable::count) {
+            break;
+        }
+        dataPtr += sizeof(TTFTableRecord);
+    }
+
+    delete data;
+
+    if(Q_UNLIKELY(tablesMap[TTFTable::NAME].Length == 0 || tablesMap[TTFTable::OS2].Length == 0)) {
+        fail(ScanError::NoTables);
+        return;
+    }
+
+    // OS/2 fields up to WinDescent are read unconditionally
+    if(Q_UNLIKELY(tablesMap[TTFTable::OS2].Length < TTFOS2HeaderV0Size)) {
+        fail(ScanError::Truncated);
+        return;
+    }
+
+    readFont();
+}
+
+bool FontReader::readTablesMap(const u8 *const data)
+{
+    const TTFTableRecord *const table = (TTFTableRecord*)data;
+    TTFTable::type tableType = TTFTable::NO;
+
+    if(memcmp(table->TableName, "name", 4) == 0) {
+        tableType = TTFTable::NAME;
+    }
+
+    if(memcmp(table->TableName, "OS/2", 4) == 0) {
+        tableType = TTFTable::OS2;
+    }
+
+    if(memcmp(table->TableName, "post", 4) == 0) {
+        tableType = TTFTable::POST;
+    }
+
+    if(memcmp(table->TableName, "cmap", 4) == 0) {
+        tableType = TTFTable::CMAP;
+    }
+
+    if(memcmp(table->TableName, "fvar", 4) == 0) {
+        tableType = TTFTable::FVAR;
+    }
+
+    if(memcmp(table->TableName, "STAT", 4) == 0) {
+        tableType = TTFTable::STAT;
+    }
+
+    if(tableType != TTFTable::NO) {
+        tablesMap[tableType] = *table;
+        swap(tablesMap[tableType].Offset);
+        swap(tablesMap[tableType].Length);
+        return true;
+    } else {
+        return false;
+    }
+}
+
+static inline u16 be16(const uchar *p)
+{
+    return u16((p[0] << 8) | p[1]);
+}
+
+static inline u32 be32(const uchar *p)
+{
+    return (u32(p[0]) << 24) | (u32(p[1]) << 16) | (u32(p[2]) << 8) | p[3];
+}
+
+static QString decodeFontName(u16 code, const uchar *string, u16 length)
+{
+    QString i18n_name;
+
+    // HB is Platform
+    // LB is Encoding
+    switch(code) {
+        case 0x0000:
+        case 0x0001:
+        case 0x0002:
+        case 0x0003:
+        case 0x0004:
+        case 0x0300:
+        case 0x0302:
+        case 0x030A:
+        case 0x0301: {
+            length /= 2;
+            i18n_name.resize(length);
+            QChar *uc = (QChar *) i18n_name.unicode();
+
+            for(int i = 0; i < length; ++i) {
+                uc[i] = be16(string + 2*i);
+            }
+        } break;
+        case 0x0100:
+        default: {
+            i18n_name.resize(length);
+            QChar *uc = (QChar *) i18n_name.unicode();
+
+            for(int i = 0; i < length; ++i) {
+                uc[i] = QLatin1Char(string[i]);
+            }
+        } break;
+    }
+
+    return i18n_name;
+}
+
+// english-like language of Windows platform record
+static bool isProperLanguage(const FontName &name)
+{
+    if(name.platform != 3) { // Windows platform
+        return false;
+    }
+
+    const u8 langCode = name.language & 0xFF;
+    return langCode == 0x09 || // English
+           langCode == 0x07 || // German
+           langCode == 0x0C || // French
+           langCode == 0x0A || // Spanish
+           langCode == 0x3B;   // Scandinavic
+}
+
+// Unicode and Windows records are UTF-16, Macintosh ones are read only in Roman encoding
+static bool isDecodable(u16 platform, u16 encoding)
+{
+    return platform == 0
+        || (platform == 1 && encoding == 0)
+        || (platform == 3 && (encoding == 0 || encoding == 1 || encoding == 10));
+}
+
+// family-like and subfamily ones are kept for every font, the rest only when asked
+static bool isIndexedName(u16 id)
+{
+    switch(id) {
+        case FontName::Family:
+        case FontName::Subfamily:
+        case FontName::Full:
+        case FontName::PostScript:
+        case FontName::TypographicFamily:
+        case FontName::TypographicSubfamily:
+        case FontName::WWSFamily:
+        case FontName::WWSSubfamily:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// records of ids (indexed ones if empty) of name table, in table order without duplicates
+static QVector<FontName> readNames(const QByteArray &table, const QVector<u16> &ids = QVector<u16>())
+{
+    QVector<FontName> names;
+
+    const uchar *data = reinterpret_cast<const uchar *>(table.constData());
+    const int size = table.size();
+    if(size < static_cast<int>(sizeof(TTFNameHeader))) {
+        return names;
+    }
+
+    const int count = be16(data + 2);
+    const int storage = be16(data + 4);
+
+    for(int i = 0; i<count; ++i) {
+        const uchar *record = data + sizeof(TTFNameHeader) + i*sizeof(TTFNameRecord);
+        if(record + sizeof(TTFNameRecord) > data + size) {
+            break;
+        }
+
+        FontName name;
+        name.platform = be16(record);
+        const u16 encoding = be16(record + 2);
+        name.language = be16(record + 4);
+        name.id = be16(record + 6);
+        const u16 length = be16(record + 8);
+        const int offset = storage + be16(record + 10);
+
+        if(ids.isEmpty() ? !isIndexedName(name.id) : !ids.contains(name.id)) {
+            continue;
+        }
+
+        if(!isDecodable(name.platform, encoding) || length == 0 || offset + length > size) {
+            continue;
+        }
+
+        name.name = decodeFontName(u16((name.platform << 8) | encoding), data + offset, length).trimmed();
+        if(!name.name.isEmpty() && !names.contains(name)) {
+            names << name;
+        }
+    }
+
+    return names;
+}
+
+// english-like record of id, the first one of any language otherwise
+static QString preferredName(const QVector<FontName> &names, u16 id)
+{
+    const FontName *found = nullptr;
+    for(const FontName &name : names) {
+        if(name.id != id) {
+            continue;
+        }
+        if(isProperLanguage(name)) {
+            return name.name;
+        }
+        if(!found) {
+            found = &name;
+        }
+    }
+
+    return found ? found->name : QString();
+}
+
+// segment mapping to delta values, code points mapped to .notdef aren't covered
+static void readCmap4(const QByteArray &table, Coverage::Builder &builder)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(table.constData());
+    const int size = table.size();
+    if(size < 14) {
+        return;
+    }
+
+    const int segments = be16(data + 6) / 2;
+    const int endCodes = 14;
+    const int startCodes = endCodes + 2*segments + 2; // reservedPad
+    const int deltas = startCodes + 2*segments;
+    const int rangeOffsets = deltas + 2*segments;
+    if(rangeOffsets + 2*segments > size) {
+        return;
+    }
+
+    for(int i = 0; i<segments; ++i) {
+        const int end = be16(data + endCodes + 2*i);
+        const int start = be16(data + startCodes + 2*i);
+        const int delta = be16(data + deltas + 2*i);
+        const int rangeOffset = be16(data + rangeOffsets + 2*i);
+
+        if(start > end || start == 0xFFFF) {
+            continue;
+        }
+
+        if(rangeOffset == 0) {
+            // the only code point of segment wrapping to glyph 0
+            const int zero = (0x10000 - delta) & 0xFFFF;
+            if(zero >= start && zero <= end) {
+                if(zero > start) builder.addRange(start, zero - 1);
+                if(zero < end) builder.addRange(zero + 1, end);
+            } else {
+                builder.addRange(start, end);
+            }
+            continue;
+        }
+
+        // idRangeOffset is relative to its own position
+        const int glyphs = rangeOffsets + 2*i + rangeOffset;
+        for(int c = start; c<=end; ++c) {
+            const int at = glyphs + 2*(c - start);
+            if(at + 2 > size) {
+                break;
+            }
+
+            const u16 glyph = be16(data + at);
+            if(glyph != 0 && ((glyph + delta) & 0xFFFF) != 0) {
+                builder.add(c);
+            }
+        }
+    }
+}
+
+// segmented coverage, full Unicode
+static void readCmap12(const QByteArray &table, Coverage::Builder &builder)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(table.constData());
+    const int size = table.size();
+    if(size < 16) {
+        return;
+    }
+
+    const u32 groups = qMin<u32>(be32(data + 12), (size - 16) / 12);
+    for(u32 i = 0; i<groups; ++i) {
+        const uchar *group = data + 16 + 12*i;
+        const u32 start = be32(group);
+        const u32 end = be32(group + 4);
+        const u32 startGlyph = be32(group + 8);
+
+        builder.addRange(startGlyph == 0 ? start + 1 : start, end);
+    }
+}
+
+// design axes of STAT by tag, their names are preferred over fvar ones
+static QHash<u32, u16> readStatAxisNames(const QByteArray &table)
+{
+    QHash<u32, u16> names;
+
+    const uchar *data = reinterpret_cast<const uchar *>(table.constData());
+    const int size = table.size();
+    if(size < 12) {
+        return names;
+    }
+
+    const int recordSize = be16(data + 4);
+    const int count = be16(data + 6);
+    const u32 offset = be32(data + 8);
+    if(recordSize < 8) {
+        return names;
+    }
+
+    for(int i = 0; i<count; ++i) {
+        const u32 at = offset + u32(i)*recordSize;
+        if(at + 8 > u32(size)) {
+            break;
+        }
+        names.insert(be32(data + at), be16(data + at + 4));
+    }
+
+    return names;
+}
+
+// fvar axes and named instances, every instance is a virtual face made from real face of the same file
+static void readVariations(const QByteArray &fvar, const QByteArray &stat, const QByteArray &nameTable,
+                           const FontFace &face, QVector<FontAxis> &axes, QVector<FontFace> &instances)
+{
+    const uchar *data = reinterpret_cast<const uchar *>(fvar.constData());
+    const int size = fvar.size();
+    if(size < 16 || be16(data) != 1) {
+        return;
+    }
+
+    const u32 axesOffset = be16(data + 4);
+    const int axisCount = be16(data + 8);
+    const int axisSize = be16(data + 10);
+    const int instanceCount = be16(data + 12);
+    const int instanceSize = be16(data + 14);
+    if(axisCount == 0 || axisSize < 20 || instanceSize < 4 + 4*axisCount
+    || axesOffset + u32(axisCount)*axisSize > u32(size)) {
+        return;
+    }
+
+    const QHash<u32, u16> statNames = readStatAxisNames(stat);
+
+    QVector<u16> nameIds;
+    QVector<u16> axisNameIds;
+    for(int i = 0; i<axisCount; ++i) {
+        const uchar *record = data + axesOffset + i*axisSize;
+
+        FontAxis axis;
+        axis.tag = be32(record);
+        axis.min = static_cast<i32>(be32(record + 4));
+        axis.def = static_cast<i32>(be32(record + 8));
+        axis.max = static_cast<i32>(be32(record + 12));
+        axes << axis;
+
+        axisNameIds << statNames.value(axis.tag, be16(record + 18));
+    }
+    nameIds << axisNameIds;
+
+    const u32 instancesOffset = axesOffset + u32(axisCount)*axisSize;
+    QVector<u16> instanceNameIds;
+    for(int i = 0; i<instanceCount; ++i) {
+        const u32 at = instancesOffset + u32(i)*instanceSize;
+        if(at + instanceSize > u32(size)) {
+            break;
+        }
+        const uchar *record = data + at;
+
+        FontFace instance = face;
+        instance.instance = static_cast<i16>(i);
+        instance.coordinates.resize(axisCount);
+
+        bool italic = face.selection & FontFace::Italic;
+        for(int a = 0; a<axisCount; ++a) {
+            const i32 value = static_cast<i32>(be32(record + 4 + 4*a));
+            instance.coordinates[a] = value;
+
+            switch(axes.at(a).tag) {
+                case FontAxis::Weight: instance.weight = static_cast<u16>(qBound(1, qRound(value / 65536.0), 1000)); break;
+                case FontAxis::Width:  instance.width = FontFace::widthClass(value / 65536.0); break;
+                case FontAxis::Slant:  instance.italicAngle = value; break;
+                case FontAxis::Italic: italic = value >= 0x8000; break;
+            }
+        }
+
+        instance.selection &= ~(FontFace::Italic | FontFace::Bold | FontFace::Regular);
+        if(italic) {
+            instance.selection |= FontFace::Italic;
+        }
+        if(instance.weight >= 700) {
+            instance.selection |= FontFace::Bold;
+        }
+        if(!italic && instance.weight == 400) {
+            instance.selection |= FontFace::Regular;
+        }
+
+        instances << instance;
+        instanceNameIds << be16(record);
+    }
+    nameIds << instanceNameIds;
+
+    // axis and instance names are in name table, font-specific ids from 256 on
+    const QVector<FontName> names = readNames(nameTable, nameIds);
+    for(int a = 0; a<axes.size(); ++a) {
+        axes[a].name = preferredName(names, axisNameIds.at(a));
+        if(axes[a].name.isEmpty()) {
+            axes[a].name = FontAxis::tagToString(axes.at(a).tag);
+        }
+    }
+    for(int i = instances.size() - 1; i>=0; --i) {
+        instances[i].style = preferredName(names, instanceNameIds.at(i));
+        if(instances.at(i).style.isEmpty()) {
+            instances.remove(i);
+        }
+    }
+}
+
+QByteArray FontReader::readTable(TTFTable::type type)
+{
+    const TTFTableRecord &record = tablesMap[type];
+    const qint64 length = qMin<qint64>(record.Length, f.size() - record.Offset);
+    if(record.Length == 0 || length <= 0 || !f.seek(record.Offset)) {
+        return QByteArray();
+    }
+
+    QByteArray table(static_cast<int>(length), Qt::Uninitialized);
+    if(readData(table.data(), length) != length) {
+        return QByteArray();
+    }
+    return table;
+}
+
+Coverage FontReader::readCoverage()
+{
+    Coverage::Builder builder;
+
+    // whole table at once (clamped by file size), subtables are decoded from memory
+    const QByteArray cmap = readTable(TTFTable::CMAP);
+    const uchar *data = reinterpret_cast<const uchar *>(cmap.constData());
+    const u32 size = static_cast<u32>(cmap.size());
+    if(size < sizeof(TTFCmapHeader)) {
+        return builder.build();
+    }
+
+    // full Unicode subtables first, then BMP ones, symbol fonts last
+    cauto rank = [](const TTFCmapEncodingRecord &r) {
+        if(r.PlatformID == 3 && r.EncodingID == 10) return 4;
+        if(r.PlatformID == 0 && (r.EncodingID == 4 || r.EncodingID == 6)) return 4;
+        if(r.PlatformID == 3 && r.EncodingID == 1) return 3;
+        if(r.PlatformID == 0 && r.EncodingID <= 3) return 2;
+        if(r.PlatformID == 3 && r.EncodingID == 0) return 1;
+        return 0;
+    };
+
+    const u32 count = qMin<u32>(be16(data + 2), (size - sizeof(TTFCmapHeader)) / sizeof(TTFCmapEncodingRecord));
+    QVector<TTFCmapEncodingRecord> records;
+    for(u32 i = 0; i<count; ++i) {
+        const uchar *p = data + sizeof(TTFCmapHeader) + i*sizeof(TTFCmapEncodingRecord);
+
+        TTFCmapEncodingRecord record;
+        record.PlatformID = be16(p);
+        record.EncodingID = be16(p + 2);
+        record.Offset = be32(p + 4);
+
+        // format and length must fit too
+        if(rank(record) > 0 && record.Offset < size && size - record.Offset >= 8) {
+            records << record;
+        }
+    }
+
+    std::stable_sort(records.begin(), records.end(), [&rank](const TTFCmapEncodingRecord &a, const TTFCmapEncodingRecord &b) {
+        return rank(a) > rank(b);
+    });
+
+    for(const TTFCmapEncodingRecord &record : std::as_const(records)) {
+        const uchar *subtable = data + record.Offset;
+        const u32 left = size - record.Offset;
+
+        const u16 format = be16(subtable);
+        if(format != 4 && format != 12) {
+            continue;
+        }
+
+        // length is u16 after format in format 4 and u32 after reserved in format 12
+        const u32 length = qMin(format == 4 ? be16(subtable + 2) : be32(subtable + 4), left);
+
+        const QByteArray table = QByteArray::fromRawData(reinterpret_cast<const char *>(subtable), static_cast<int>(length));
+        if(format == 4) {
+            readCmap4(table, builder);
+        } else {
+            readCmap12(table, builder);
+        }
+
+        if(!builder.isEmpty()) {
+            break;
+        }
+    }
+
+    return builder.build();
+}
+
+void FontReader::readFont()
+{
+    /////////
+    // name
+    ///////
+    // whole table at once, records are decoded from memory
+    const QByteArray nameTable = readTable(TTFTable::NAME);
+    if(Q_UNLIKELY(nameTable.isEmpty())) {
+        fail(ScanError::Truncated);
+        return;
+    }
+
+    const QVector<FontName> names = readNames(nameTable);
+
+    // family (1) and subfamily (2) names, english-like ones are preferred
+    const QString fontName = preferredName(names, FontName::Family);
+    const QString styleName = preferredName(names, FontName::Subfamily);
+
+    if(Q_UNLIKELY(fontName.isEmpty())) {
+        fail(ScanError::NoName);
+        return;
+    }
+
+#ifdef FONTA_DETAILED_DEBUG
+    qDebug() << '\t' << fontName << styleName << names.size() << "names";
+#endif
+
+    ++scan.faces;
+
+    CStringRef fileName = f.fileName();
+
+    {
+        std::lock_guard<std::mutex> lock(readFile2Fonts);
+        File2Fonts[fileName] << fontName;
+        (void)lock;
+    }
+
+    // faces of family mostly map the same code points, but italics and symbols may differ
+    const Coverage coverage = readCoverage();
+
+    /////////
+    // OS/2
+    ///////
+    const TTFTableRecord& os2OffsetTable = tablesMap[TTFTable::OS2];
+    f.seek(os2OffsetTable.Offset);
+
+    cauto os2Header = read<TTFOS2Header>();
+
+    /////////
+    // post
+    ///////
+    const TTFTableRecord& postOffsetTable = tablesMap[TTFTable::POST];
+    const bool hasPost = postOffsetTable.Length >= sizeof(TTFPostHeader) && f.seek(postOffsetTable.Offset);
+    const TTFPostHeader postHeader = hasPost ? read<TTFPostHeader>() : TTFPostHeader();
+
+    FontFace face;
+    face.style = styleName;
+    // some old fonts have weight in 1..9 scale
+    face.weight = static_cast<u16>(os2Header.WeightClass < 10 ? os2Header.WeightClass*100 : qMin<int>(os2Header.WeightClass, 1000));
+    if(face.weight == 0) {
+        face.weight = 400;
+    }
+    face.width = os2Header.WidthClass >= 1 && os2Header.WidthClass <= 9 ? os2Header.WidthClass : 5;
+    face.selection = os2Header.Selection;
+    face.italicAngle = hasPost ? static_cast<i32>(postHeader.ItalicAngle) : 0;
+
+    /////////
+    // fvar, STAT
+    ///////
+    QVector<FontAxis> axes;
+    QVector<FontFace> instances;
+    const QByteArray fvarTable = readTable(TTFTable::FVAR);
+    if(!fvarTable.isEmpty()) {
+        readVariations(fvarTable, readTable(TTFTable::STAT), nameTable, face, axes, instances);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(readTTFMutex);
+        if(TTFs.contains(fontName)) {
+            TTF &ttf = TTFs[fontName];
+            ttf.files << fileName;
+            ttf.addFace(face);
+            for(const FontFace &instance : std::as_const(instances)) {
+                ttf.addFace(instance);
+            }
+            ttf.addAxes(axes);
+            if(ttf.coverage != coverage) {
+                ttf.coverage = ttf.coverage.united(coverage);
+            }
+            ttf.addNames(names);
+            return;
+        }
+        (void)lock;
+    }
+
+    TTF ttf;
+    ttf.valid = true;
+    ttf.files << std::move(fileName);
+    ttf.faces << face;
+    for(const FontFace &instance : std::as_const(instances)) {
+        ttf.addFace(instance);
+    }
+    ttf.axes = axes;
+    ttf.coverage = coverage;
+    ttf.names = names;
+    //qDebug() << '\t' << fontName;
+
+    ttf.panose = os2Header.panose;
+
+    // notice we did not swap family class, so LowByte is FamilyClass, HighByte is FamilySubclass
+    ttf.familyClass = (FamilyClass::type)(os2Header.FamilyClass & 0xFF);
+    ttf.familySubClass = (int)(os2Header.FamilyClass >> 8);
+
+    ttf.unicodeRange[0] = os2Header.UnicodeRange1;
+    ttf.unicodeRange[1] = os2Header.UnicodeRange2;
+    ttf.unicodeRange[2] = os2Header.UnicodeRange3;
+    ttf.unicodeRange[3] = os2Header.UnicodeRange4;
+
+    // code page ranges appeared in version 1, bit 31 is Symbol character set
+    if(os2OffsetTable.Length >= sizeof(TTFOS2Header)) {
+        ttf.codePageRange[0] = os2Header.CodePageRange1;
+        ttf.codePageRange[1] = os2Header.CodePageRange2;
+        ttf.symbolic = !!(os2Header.CodePageRange1 & (1u<<31));
+    }
+
+    ttf.latin = ttf.supports(Script::Latin);
+    ttf.cyrillic = ttf.supports(Script::Cyrillic);
+
+    ttf.monospaced = hasPost ? postHeader.IsFixedPitch != 0 : ttf.panose.isMonospaced();
+
+    {
+        std::lock_guard<std::mutex> lock(readTTFMutex);
+        auto it = TTFs.find(fontName);
+        if(it != TTFs.end()) {
+            // other thread was faster with another face of family
+            ttf.files.unite(it->second.files);
+            for(const FontFace &other : std::as_const(it->second.faces)) {
+                ttf.addFace(other);
+            }
+            ttf.addAxes(it->second.axes);
+            ttf.coverage = ttf.coverage.united(it->second.coverage);
+            ttf.addNames(it->second.names);
+
+            // family covers scripts of all its faces, whatever face is read last
+            for(int i = 0; i<4; ++i) {
+                ttf.unicodeRange[i] |= it->second.unicodeRange[i];
+            }
+            for(int i = 0; i<2; ++i) {
+                ttf.codePageRange[i] |= it->second.codePageRange[i];
+            }
+            ttf.latin |= it->second.latin;
+            ttf.cyrillic |= it->second.cyrillic;
+        }
+        TTFs[fontName] = std::move(ttf);
+        (void)lock;
+    }
+}
+
+QStringList FontReader::fontFiles(const QStringList &dirs, qint64 *bytes, FileStamps *stamps)
+{
+    static const QStringList filters = {
+        QStringLiteral("*.ttf"), QStringLiteral("*.otf"), QStringLiteral("*.ttc"), QStringLiteral("*.otc"), QStringLiteral("*.fon")
+    };
+
+    FONTA_TRACE_SPAN("crawl", "fontFiles");
+
+    qint64 size = 0;
+    QStringList out;
+    for(CStringRef dir : dirs) {
+        QDirIterator it(dir, filters, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            out << it.next();
+            if(bytes) {
+                size += it.fileInfo().size();
+            }
+            if(stamps) {
+                const QFileInfo info = it.fileInfo();
+                FileStamp &stamp = (*stamps)[out.last()];
+                stamp.size = info.size();
+                stamp.modified = info.lastModified().toMSecsSinceEpoch();
+            }
+        }
+    }
+
+    if(bytes) {
+        *bytes = size;
+    }
+
+    trace::counter("crawl", "files", out.size());
+
+    return out;
+}
+
+void FontReader::readFiles(const QStringList &files, TTFMap &TTFs, File2FontsMap &File2Fonts,
+                           int threads, ScanProgress *progress, ScanReport *report)
+{
+    FONTA_TRACE_SPAN("parse", "readFiles");
+
+#ifndef FONTA_DETAILED_DEBUG
+    if(threads <= 0) {
+        threads = std::thread::hardware_concurrency();
+        if(!threads) threads = 4;
+    }
+    threads = qMax(1, qMin(threads, files.size()));
+
+    // files differ a lot in size, so workers take them one by one instead of fixed chunks
+    std::atomic<int> next(0);
+    cauto work = [&](int worker) {
+        for(int i = next++; i<files.size(); i = next++) {
+            FontReader reader(TTFs, File2Fonts, report);
+            const qint64 size = reader.readFile(files[i]);
+            if(progress) {
+                progress->fileRead(worker, size);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(int i = 1; i<threads; ++i) {
+        workers.emplace_back(work, i);
+    }
+    work(0);
+
+    for(auto &t : workers) {
+        t.join();
+    }
+#else
+    (void)threads;
+    for(CStringRef file : files) {
+        FontReader reader(TTFs, File2Fonts, report);
+        const qint64 size = reader.readFile(file);
+        if(progress) {
+            progress->fileRead(0, size);
+        }
+    }
+#endif
+}
+
+} // namespace fonta
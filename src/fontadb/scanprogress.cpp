@@ -0,0 +1,85 @@
+#include "scanprogress.h"
+
+#include <chrono>
+
+namespace fonta {
+
+static i64 steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ScanProgress::start(qint64 totalBytes, int totalFiles)
+{
+    for(Slot &slot : m_slots) {
+        slot.bytes.store(0, std::memory_order_relaxed);
+        slot.files.store(0, std::memory_order_relaxed);
+    }
+
+    m_totalBytes.store(totalBytes, std::memory_order_relaxed);
+    m_totalFiles.store(totalFiles, std::memory_order_relaxed);
+    m_finished.store(false, std::memory_order_relaxed);
+    m_started.store(steadyNs(), std::memory_order_release);
+}
+
+void ScanProgress::finish()
+{
+    m_finished.store(true, std::memory_order_release);
+}
+
+qint64 ScanProgress::bytesDone() const
+{
+    qint64 bytes = 0;
+    for(const Slot &slot : m_slots) {
+        bytes += slot.bytes.load(std::memory_order_relaxed);
+    }
+    return bytes;
+}
+
+int ScanProgress::filesDone() const
+{
+    int files = 0;
+    for(const Slot &slot : m_slots) {
+        files += slot.files.load(std::memory_order_relaxed);
+    }
+    return files;
+}
+
+double ScanProgress::fraction() const
+{
+    if(isFinished()) {
+        return 1.0;
+    }
+
+    const qint64 total = bytesTotal();
+    if(total <= 0) {
+        return 0.0;
+    }
+
+    return qMin(1.0, bytesDone() / static_cast<double>(total));
+}
+
+qint64 ScanProgress::etaMs() const
+{
+    const i64 started = m_started.load(std::memory_order_acquire);
+    if(started < 0) {
+        return -1;
+    }
+
+    if(isFinished()) {
+        return 0;
+    }
+
+    const qint64 done = bytesDone();
+    const i64 elapsed = steadyNs() - started;
+
+    // first few files are dominated by cold cache, rate settles later
+    if(done <= 0 || elapsed < 250*1000000LL) {
+        return -1;
+    }
+
+    const qint64 left = qMax<qint64>(0, bytesTotal() - done);
+    return static_cast<qint64>(elapsed / 1e6 * left / done);
+}
+
+} // namespace fonta
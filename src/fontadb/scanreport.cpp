@@ -0,0 +1,217 @@
+#include "scanreport.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+#include <algorithm>
+
+namespace fonta {
+
+void ScanReport::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.clear();
+    m_wallTime = 0;
+    (void)lock;
+}
+
+void ScanReport::add(FileScan &&scan)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.append(std::move(scan));
+    (void)lock;
+}
+
+void ScanReport::merge(ScanReport &&other, const QStringList &removed)
+{
+    std::lock(m_mutex, other.m_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex, std::adopt_lock);
+    std::lock_guard<std::mutex> otherLock(other.m_mutex, std::adopt_lock);
+    (void)lock;
+    (void)otherLock;
+
+    QSet<QString> replaced(removed.cbegin(), removed.cend());
+    for(const FileScan &scan : std::as_const(other.m_files)) {
+        replaced.insert(scan.file);
+    }
+
+    cauto end = std::remove_if(m_files.begin(), m_files.end(), [&replaced](const FileScan &scan) {
+        return replaced.contains(scan.file);
+    });
+    m_files.erase(end, m_files.end());
+
+    m_files += other.m_files;
+    m_wallTime += other.m_wallTime;
+
+    other.m_files.clear();
+    other.m_wallTime = 0;
+}
+
+int ScanReport::faces() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    (void)lock;
+
+    int faces = 0;
+    for(const FileScan &scan : m_files) {
+        faces += scan.faces;
+    }
+    return faces;
+}
+
+qint64 ScanReport::bytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    (void)lock;
+
+    qint64 bytes = 0;
+    for(const FileScan &scan : m_files) {
+        bytes += scan.bytes;
+    }
+    return bytes;
+}
+
+QVector<FileScan> ScanReport::slowest(int count) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    (void)lock;
+
+    QVector<FileScan> files = m_files;
+    count = qMin(count, files.size());
+    std::partial_sort(files.begin(), files.begin() + count, files.end(), [](const FileScan &a, const FileScan &b) {
+        return a.duration > b.duration;
+    });
+    files.resize(count);
+    return files;
+}
+
+QMap<ScanError::type, QStringList> ScanReport::failures() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    (void)lock;
+
+    QMap<ScanError::type, QStringList> failures;
+    for(const FileScan &scan : m_files) {
+        if(scan.error != ScanError::None) {
+            failures[scan.error] << scan.file;
+        }
+    }
+    return failures;
+}
+
+const QVector<int> &ScanReport::histogramBounds()
+{
+    static const QVector<int> bounds = {1, 2, 5, 10, 20, 50, 100, 500};
+    return bounds;
+}
+
+QVector<int> ScanReport::histogram() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    (void)lock;
+
+    cauto bounds = histogramBounds();
+    QVector<int> buckets(bounds.size() + 1, 0);
+    for(const FileScan &scan : m_files) {
+        const auto it = std::upper_bound(bounds.cbegin(), bounds.cend(), scan.duration / 1000000);
+        ++buckets[static_cast<int>(it - bounds.cbegin())];
+    }
+    return buckets;
+}
+
+static QString bucketName(int i)
+{
+    cauto bounds = ScanReport::histogramBounds();
+    if(i == bounds.size()) {
+        return QStringLiteral(">=%1ms").arg(bounds.last());
+    }
+    return QStringLiteral("<%1ms").arg(bounds.at(i));
+}
+
+QJsonObject ScanReport::toJson(int slowestCount) const
+{
+    QJsonObject o;
+    o[QStringLiteral("files")] = m_files.size();
+    o[QStringLiteral("faces")] = faces();
+    o[QStringLiteral("bytes")] = bytes();
+    o[QStringLiteral("wallMs")] = m_wallTime / 1e6;
+
+    QJsonArray slow;
+    for(const FileScan &scan : slowest(slowestCount)) {
+        QJsonObject s;
+        s[QStringLiteral("file")] = scan.file;
+        s[QStringLiteral("ms")] = scan.duration / 1e6;
+        s[QStringLiteral("bytes")] = scan.bytes;
+        s[QStringLiteral("faces")] = scan.faces;
+        slow.append(s);
+    }
+    o[QStringLiteral("slowest")] = slow;
+
+    QJsonObject failed;
+    cauto failuresMap = failures();
+    for(auto it = failuresMap.cbegin(); it != failuresMap.cend(); ++it) {
+        failed[ScanError::key(it.key())] = QJsonArray::fromStringList(it.value());
+    }
+    o[QStringLiteral("failures")] = failed;
+
+    QJsonObject histo;
+    cauto buckets = histogram();
+    for(int i = 0; i<buckets.size(); ++i) {
+        histo[bucketName(i)] = buckets.at(i);
+    }
+    o[QStringLiteral("histogram")] = histo;
+
+    return o;
+}
+
+QString ScanReport::toText(int slowestCount) const
+{
+    if(isEmpty()) {
+        return QCoreApplication::translate("fonta", "Fonts were loaded from cache, no scan was made.");
+    }
+
+    QString text;
+    text += QCoreApplication::translate("fonta", "%1 files, %2 faces, %3 MB in %4 ms\n")
+            .arg(m_files.size())
+            .arg(faces())
+            .arg(bytes() / (1024.0*1024.0), 0, 'f', 1)
+            .arg(m_wallTime / 1000000);
+
+    text += QCoreApplication::translate("fonta", "\nSlowest files:\n");
+    for(const FileScan &scan : slowest(slowestCount)) {
+        text += QStringLiteral("  %1 ms  %2\n").arg(scan.duration / 1e6, 0, 'f', 1).arg(scan.file);
+    }
+
+    cauto failuresMap = failures();
+    if(!failuresMap.isEmpty()) {
+        text += QCoreApplication::translate("fonta", "\nFailures:\n");
+        for(auto it = failuresMap.cbegin(); it != failuresMap.cend(); ++it) {
+            text += QStringLiteral("  %1 (%2)\n").arg(ScanError::toString(it.key())).arg(it.value().size());
+            for(CStringRef file : it.value()) {
+                text += QStringLiteral("    ") + file + '\n';
+            }
+        }
+    }
+
+    text += QCoreApplication::translate("fonta", "\nDurations:\n");
+    cauto buckets = histogram();
+    for(int i = 0; i<buckets.size(); ++i) {
+        text += QStringLiteral("  %1  %2\n").arg(bucketName(i), 7).arg(buckets.at(i));
+    }
+
+    return text;
+}
+
+bool ScanReport::save(CStringRef fileName) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QJsonObject o = toJson(m_files.size());
+    return file.write(QJsonDocument(o).toJson()) != -1;
+}
+
+} // namespace fonta
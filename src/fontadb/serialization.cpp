@@ -1,82 +1,203 @@
 #include "serialization.h"
 
+#include "coverage.h"
 #include "fontadb.h"
 #include <QDataStream>
+#include <algorithm>
 
 
 namespace fonta {
 
+// bump when layout changes, old caches are rebuilt then
+static const u32 cacheMagic = 0x464E5443; // FNTC
+static const u32 cacheVersion = 10;
+
+// start column of CSR layout: from 0 up to size of column it splits, never decreasing
+static bool isStartColumn(const QVector<u32> &starts, int size)
+{
+    return !starts.isEmpty() && starts.first() == 0 && static_cast<qint64>(starts.last()) == size
+        && std::is_sorted(starts.cbegin(), starts.cend());
+}
+
+template<typename T>
+static bool inRange(const QVector<T> &ids, int count)
+{
+    return std::all_of(ids.cbegin(), ids.cend(), [count](T id) {
+        return static_cast<qint64>(id) >= 0 && static_cast<qint64>(id) < count;
+    });
+}
+
 QDataStream &operator<<(QDataStream &out, const DB &db)
 {
-    out << db.TTFs;
+    out << cacheMagic << cacheVersion;
+    out << db.m_catalogue;
+    out << db.m_fileStamps;
 
     return out;
 }
 
 QDataStream &operator>>(QDataStream &in, DB &db)
 {
-    in >> db.TTFs;
+    u32 magic = 0;
+    u32 version = 0;
+    in >> magic >> version;
+    if(magic != cacheMagic || version != cacheVersion) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+
+    in >> db.m_catalogue;
+    in >> db.m_fileStamps;
 
     return in;
 }
 
-QDataStream &operator<<(QDataStream &out, const TTFMap &m)
+QDataStream &operator<<(QDataStream &out, const StringPool &pool)
 {
-    out << (u64)m.size();
-    for(cauto pair : m) {
-        out << pair.first;
-        out << pair.second;
+    out << pool.m_chars;
+    out << pool.m_offsets;
+
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, StringPool &pool)
+{
+    in >> pool.m_chars;
+    in >> pool.m_offsets;
+
+    // there is nothing to add to loaded pool
+    pool.m_ids.clear();
+    if(!isStartColumn(pool.m_offsets, pool.m_chars.size())) {
+        in.setStatus(QDataStream::ReadCorruptData);
     }
 
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const Catalogue &c)
+{
+    out << c.m_strings;
+
+    out << c.m_family;
+    out << c.m_familyClass;
+    out << c.m_familySubClass;
+    out << c.m_flags;
+    out << c.m_panose;
+    out << c.m_unicodeRange << c.m_codePageRange;
+    out << c.m_faceStart << c.m_faceStyle << c.m_faceWeight << c.m_faceWidth << c.m_faceSelection << c.m_faceItalicAngle;
+    out << c.m_faceInstance << c.m_faceCoordStart << c.m_faceCoords;
+    out << c.m_axisStart << c.m_axisTag << c.m_axisMin << c.m_axisDef << c.m_axisMax << c.m_axisName;
+    out << c.m_fileStart << c.m_files;
+    out << c.m_coverage;
+    out << c.m_nameStart << c.m_name << c.m_nameId << c.m_namePlatform << c.m_nameLanguage;
+    out << c.m_indexKey << c.m_indexFont;
+
+    out << c.m_dir;
+    out << c.m_fileName;
+    out << c.m_fontStart << c.m_fonts;
+
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, Catalogue &c)
+{
+    in >> c.m_strings;
+
+    in >> c.m_family;
+    in >> c.m_familyClass;
+    in >> c.m_familySubClass;
+    in >> c.m_flags;
+    in >> c.m_panose;
+    in >> c.m_unicodeRange >> c.m_codePageRange;
+    in >> c.m_faceStart >> c.m_faceStyle >> c.m_faceWeight >> c.m_faceWidth >> c.m_faceSelection >> c.m_faceItalicAngle;
+    in >> c.m_faceInstance >> c.m_faceCoordStart >> c.m_faceCoords;
+    in >> c.m_axisStart >> c.m_axisTag >> c.m_axisMin >> c.m_axisDef >> c.m_axisMax >> c.m_axisName;
+    in >> c.m_fileStart >> c.m_files;
+    in >> c.m_coverage;
+    in >> c.m_nameStart >> c.m_name >> c.m_nameId >> c.m_namePlatform >> c.m_nameLanguage;
+    in >> c.m_indexKey >> c.m_indexFont;
+
+    in >> c.m_dir;
+    in >> c.m_fileName;
+    in >> c.m_fontStart >> c.m_fonts;
+
+    const int fonts = c.m_family.size();
+    const int files = c.m_fileName.size();
+    const int faces = c.m_faceStyle.size();
+    const int axes = c.m_axisTag.size();
+    if(c.m_familyClass.size() != fonts || c.m_familySubClass.size() != fonts
+    || c.m_flags.size() != fonts || c.m_panose.size() != fonts
+    || c.m_faceStart.size() != fonts + 1 || c.m_fileStart.size() != fonts + 1 || c.m_coverage.size() != fonts
+    || c.m_unicodeRange.size() != 4*fonts || c.m_codePageRange.size() != 2*fonts
+    || c.m_faceWeight.size() != faces || c.m_faceWidth.size() != faces
+    || c.m_faceSelection.size() != faces || c.m_faceItalicAngle.size() != faces
+    || c.m_faceInstance.size() != faces || c.m_faceCoordStart.size() != faces + 1
+    || c.m_axisStart.size() != fonts + 1 || c.m_axisMin.size() != axes || c.m_axisDef.size() != axes
+    || c.m_axisMax.size() != axes || c.m_axisName.size() != axes
+    || c.m_nameStart.size() != fonts + 1 || c.m_nameId.size() != c.m_name.size()
+    || c.m_namePlatform.size() != c.m_name.size() || c.m_nameLanguage.size() != c.m_name.size()
+    || c.m_indexFont.size() != c.m_indexKey.size()
+    || c.m_dir.size() != files || c.m_fontStart.size() != files + 1) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+
+    // every id and offset is used without bounds checks later
+    const int strings = c.m_strings.count();
+    if(!isStartColumn(c.m_faceStart, faces) || !isStartColumn(c.m_faceCoordStart, c.m_faceCoords.size())
+    || !isStartColumn(c.m_axisStart, axes) || !isStartColumn(c.m_fileStart, c.m_files.size())
+    || !isStartColumn(c.m_nameStart, c.m_name.size()) || !isStartColumn(c.m_fontStart, c.m_fonts.size())
+    || !inRange(c.m_files, files) || !inRange(c.m_fonts, fonts) || !inRange(c.m_indexFont, fonts)
+    || !inRange(c.m_family, strings) || !inRange(c.m_faceStyle, strings) || !inRange(c.m_axisName, strings)
+    || !inRange(c.m_name, strings) || !inRange(c.m_indexKey, strings)
+    || !inRange(c.m_dir, strings) || !inRange(c.m_fileName, strings)) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+
+    // cheaper to rebuild than to store
+    c.buildComponents();
+    c.buildScripts();
+
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const Coverage &c)
+{
+    out << c.m_keys << c.m_kinds << c.m_starts << c.m_values;
+
     return out;
 }
 
-QDataStream &operator>>(QDataStream &in, TTFMap &m)
+QDataStream &operator>>(QDataStream &in, Coverage &c)
 {
-    u64 size = 0;
-    in >> size;
-    for(u64 i = 0; i<size; ++i) {
-        QString name;
-        TTF ttf;
-        in >> name;
-        in >> ttf;
-
-        m[name] = std::move(ttf);
+    in >> c.m_keys >> c.m_kinds >> c.m_starts >> c.m_values;
+
+    const int groups = c.m_keys.size();
+    if(groups == 0) {
+        c = Coverage();
+        return in;
+    }
+
+    if(c.m_kinds.size() != groups || c.m_starts.size() != groups + 1 || !isStartColumn(c.m_starts, c.m_values.size())
+    || !c.isValid()) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        c = Coverage();
     }
 
     return in;
 }
 
-QDataStream &operator<<(QDataStream &out, const TTF &ttf)
+QDataStream &operator<<(QDataStream &out, const FileStamp &s)
 {
-    out << static_cast<i32>(ttf.familyClass);
-    out << static_cast<i32>(ttf.familySubClass);
-    out << ttf.latin;
-    out << ttf.cyrillic;
-    out << ttf.panose;
-    out << ttf.valid;
-    out << ttf.files;
-    out << ttf.linkedFonts;
+    out << s.size << s.modified;
 
     return out;
 }
 
-QDataStream &operator>>(QDataStream &in, TTF &ttf)
+QDataStream &operator>>(QDataStream &in, FileStamp &s)
 {
-    i32 familyClass = 0;
-    i32 familySubClass = 0;
-
-    in >> familyClass;
-    in >> familySubClass;
-    in >> ttf.latin;
-    in >> ttf.cyrillic;
-    in >> ttf.panose;
-    in >> ttf.valid;
-    in >> ttf.files;
-    in >> ttf.linkedFonts;
-
-    ttf.familyClass = static_cast<FamilyClass::type>(familyClass);
-    ttf.familySubClass = static_cast<int>(familyClass);
+    in >> s.size >> s.modified;
 
     return in;
 }
@@ -5,19 +5,27 @@ class QDataStream;
 
 namespace fonta {
 
+class Catalogue;
+class Coverage;
 class DB;
+struct FileStamp;
 struct Panose;
-struct TTF;
-class TTFMap;
+class StringPool;
 
 QDataStream &operator<<(QDataStream &out, const DB &db);
 QDataStream &operator>>(QDataStream &in,        DB &db);
 
-QDataStream &operator<<(QDataStream &out, const TTFMap &m);
-QDataStream &operator>>(QDataStream &in,        TTFMap &m);
+QDataStream &operator<<(QDataStream &out, const StringPool &pool);
+QDataStream &operator>>(QDataStream &in,        StringPool &pool);
 
-QDataStream &operator<<(QDataStream &out, const TTF &ttf);
-QDataStream &operator>>(QDataStream &in,        TTF &ttf);
+QDataStream &operator<<(QDataStream &out, const Catalogue &c);
+QDataStream &operator>>(QDataStream &in,        Catalogue &c);
+
+QDataStream &operator<<(QDataStream &out, const Coverage &c);
+QDataStream &operator>>(QDataStream &in,        Coverage &c);
+
+QDataStream &operator<<(QDataStream &out, const FileStamp &s);
+QDataStream &operator>>(QDataStream &in,        FileStamp &s);
 
 QDataStream &operator<<(QDataStream &out, const Panose &p);
 QDataStream &operator>>(QDataStream &in,        Panose &p);
@@ -0,0 +1,154 @@
+#include "taskgraph.h"
+#include "trace.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fonta {
+
+TaskGraph::Id TaskGraph::add(const char *name, std::function<void()> task, std::initializer_list<Id> deps, Affinity affinity)
+{
+    const Id id = m_tasks.size();
+
+    Task t;
+    t.name = name;
+    t.run = std::move(task);
+    t.affinity = affinity;
+    for(Id dep : deps) {
+        Q_ASSERT(dep >= 0 && dep < id);
+        t.deps << dep;
+        m_tasks[dep].dependents << id;
+    }
+
+    m_tasks << std::move(t);
+    return id;
+}
+
+void TaskGraph::run()
+{
+    FONTA_TRACE_SPAN("startup", "TaskGraph::run");
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Id> anyReady;
+    std::deque<Id> callerReady;
+    QVector<int> waiting(m_tasks.size());
+    int done = 0;
+
+    int workersNeeded = 0;
+    for(Id id = 0; id<m_tasks.size(); ++id) {
+        const Task &t = m_tasks.at(id);
+        waiting[id] = t.deps.size();
+        if(t.affinity == AnyThread) {
+            ++workersNeeded;
+        }
+        if(waiting[id] == 0) {
+            (t.affinity == CallerThread ? callerReady : anyReady).push_back(id);
+        }
+    }
+
+    // caller thread helps with any tasks too, so it is one worker less
+    const int hardware = qMax(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int workersCount = qMax(0, qMin(workersNeeded, hardware) - 1);
+
+    // runs task outside of lock, then unlocks its dependents
+    cauto execute = [&](Id id, std::unique_lock<std::mutex> &lock) {
+        lock.unlock();
+
+        Task &t = m_tasks[id];
+        t.started = trace::now();
+        t.run();
+        t.finished = trace::now();
+        trace::complete("startup", t.name, t.started);
+
+        lock.lock();
+        ++done;
+        for(Id next : std::as_const(t.dependents)) {
+            if(--waiting[next] == 0) {
+                (m_tasks.at(next).affinity == CallerThread ? callerReady : anyReady).push_back(next);
+            }
+        }
+        changed.notify_all();
+    };
+
+    std::vector<std::thread> workers;
+    for(int i = 0; i<workersCount; ++i) {
+        workers.emplace_back([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while(true) {
+                changed.wait(lock, [&]{ return !anyReady.empty() || done == m_tasks.size(); });
+                if(anyReady.empty()) {
+                    return;
+                }
+
+                const Id id = anyReady.front();
+                anyReady.pop_front();
+                execute(id, lock);
+            }
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(done != m_tasks.size()) {
+            changed.wait(lock, [&]{ return !callerReady.empty() || !anyReady.empty() || done == m_tasks.size(); });
+
+            if(!callerReady.empty()) {
+                const Id id = callerReady.front();
+                callerReady.pop_front();
+                execute(id, lock);
+            } else if(!anyReady.empty()) {
+                const Id id = anyReady.front();
+                anyReady.pop_front();
+                execute(id, lock);
+            }
+        }
+        changed.notify_all();
+    }
+
+    for(auto &t : workers) {
+        t.join();
+    }
+
+    if(trace::enabled()) {
+        for(Id id : criticalPath()) {
+            const Task &t = m_tasks.at(id);
+            trace::async("critical", t.name, 1, t.started, t.finished);
+        }
+    }
+}
+
+QVector<TaskGraph::Id> TaskGraph::criticalPath() const
+{
+    QVector<Id> path;
+    if(m_tasks.isEmpty()) {
+        return path;
+    }
+
+    Id last = 0;
+    for(Id id = 1; id<m_tasks.size(); ++id) {
+        if(m_tasks.at(id).finished > m_tasks.at(last).finished) {
+            last = id;
+        }
+    }
+
+    // walk back through the dependency that was ready last
+    for(Id id = last; id >= 0; ) {
+        path.prepend(id);
+
+        Id gate = -1;
+        for(Id dep : m_tasks.at(id).deps) {
+            if(gate < 0 || m_tasks.at(dep).finished > m_tasks.at(gate).finished) {
+                gate = dep;
+            }
+        }
+        id = gate;
+    }
+
+    return path;
+}
+
+} // namespace fonta
@@ -0,0 +1,260 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fonta {
+namespace trace {
+
+namespace {
+
+struct Event {
+    const char *category;
+    const char *name;
+    i64 ts;
+    i64 value; // duration for spans, value for counters, id for async
+    u32 tid;
+    char phase;
+};
+
+// ~1.5 MB per thread, oldest events are overwritten
+const int bufferCapacity = 1 << 15;
+
+struct Buffer {
+    std::mutex mutex; // uncontended except while exporting
+    std::vector<Event> events;
+    u64 written {0};
+    u32 tid {0};
+    bool owned {false};
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<Buffer>> buffers;
+u32 nextTid = 1;
+QString outputFile;
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+// buffers of finished threads are handed to new ones, so pools of short living workers don't grow memory
+struct Holder {
+    Buffer *buffer {nullptr};
+
+    ~Holder() {
+        if(buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->owned = false;
+            (void)lock;
+        }
+    }
+};
+
+thread_local Holder holder;
+
+Buffer *threadBuffer()
+{
+    if(Q_LIKELY(holder.buffer)) {
+        return holder.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    (void)lock;
+
+    Buffer *buffer = nullptr;
+    for(cauto b : buffers) {
+        if(!b->owned) {
+            buffer = b.get();
+            break;
+        }
+    }
+
+    if(!buffer) {
+        buffers.emplace_back(new Buffer);
+        buffer = buffers.back().get();
+        buffer->events.resize(bufferCapacity);
+    }
+
+    buffer->owned = true;
+    buffer->tid = nextTid++;
+    holder.buffer = buffer;
+    return buffer;
+}
+
+void writeAtExit()
+{
+    if(!outputFile.isEmpty()) {
+        write(outputFile);
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+std::atomic<bool> enabled(false);
+
+void record(char phase, const char *category, const char *name, i64 ts, i64 value)
+{
+    Buffer *buffer = threadBuffer();
+
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    (void)lock;
+
+    Event &e = buffer->events[buffer->written % bufferCapacity];
+    e.category = category;
+    e.name = name;
+    e.ts = ts;
+    e.value = value;
+    e.tid = buffer->tid;
+    e.phase = phase;
+    ++buffer->written;
+}
+
+} // namespace detail
+
+void setEnabled(bool enabled)
+{
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+i64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void complete(const char *category, const char *name, i64 started)
+{
+    if(!enabled()) {
+        return;
+    }
+
+    detail::record('X', category, name, started, now() - started);
+}
+
+void counter(const char *category, const char *name, i64 value)
+{
+    if(!enabled()) {
+        return;
+    }
+
+    detail::record('C', category, name, now(), value);
+}
+
+void instant(const char *category, const char *name)
+{
+    if(!enabled()) {
+        return;
+    }
+
+    detail::record('i', category, name, now(), 0);
+}
+
+void async(const char *category, const char *name, i64 id, i64 started, i64 finished)
+{
+    if(!enabled()) {
+        return;
+    }
+
+    detail::record('b', category, name, started, id);
+    detail::record('e', category, name, finished, id);
+}
+
+void setup(const QStringList &arguments)
+{
+    QString file = QString::fromLocal8Bit(qgetenv("FONTA_TRACE"));
+
+    for(int i = 0; i<arguments.size(); ++i) {
+        CStringRef arg = arguments.at(i);
+        if(arg == QLatin1String("--trace") && i+1 < arguments.size()) {
+            file = arguments.at(i+1);
+        } else if(arg.startsWith(QLatin1String("--trace="))) {
+            file = arg.mid(8);
+        }
+    }
+
+    if(file.isEmpty()) {
+        return;
+    }
+
+    const bool first = outputFile.isEmpty();
+    outputFile = file;
+    setEnabled(true);
+
+    if(first) {
+        qAddPostRoutine(writeAtExit);
+    }
+}
+
+bool write(CStringRef fileName)
+{
+    QJsonArray events;
+
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        (void)registryLock;
+
+        for(cauto buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            (void)lock;
+
+            const u64 count = qMin<u64>(buffer->written, bufferCapacity);
+            for(u64 i = buffer->written - count; i<buffer->written; ++i) {
+                const Event &e = buffer->events[i % bufferCapacity];
+
+                QJsonObject o;
+                o[QStringLiteral("name")] = QLatin1String(e.name);
+                o[QStringLiteral("cat")] = QLatin1String(e.category);
+                o[QStringLiteral("ph")] = QString(QLatin1Char(e.phase));
+                o[QStringLiteral("ts")] = e.ts / 1000.0; // microseconds
+                o[QStringLiteral("pid")] = 1;
+                o[QStringLiteral("tid")] = static_cast<int>(e.tid);
+
+                if(e.phase == 'X') {
+                    o[QStringLiteral("dur")] = e.value / 1000.0;
+                } else if(e.phase == 'C') {
+                    o[QStringLiteral("args")] = QJsonObject{{QStringLiteral("value"), e.value}};
+                } else if(e.phase == 'b' || e.phase == 'e') {
+                    o[QStringLiteral("id")] = e.value;
+                } else if(e.phase == 'i') {
+                    o[QStringLiteral("s")] = QStringLiteral("t");
+                }
+
+                events.append(o);
+            }
+        }
+    }
+
+    QJsonObject root;
+    root[QStringLiteral("traceEvents")] = events;
+    root[QStringLiteral("displayTimeUnit")] = QStringLiteral("ms");
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Couldn't write trace to %s", qPrintable(fileName));
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+void clear()
+{
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    (void)registryLock;
+
+    for(cauto buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->written = 0;
+        (void)lock;
+    }
+}
+
+} // namespace trace
+} // namespace fonta
@@ -0,0 +1,196 @@
+#ifndef CATALOGUE_H
+#define CATALOGUE_H
+
+#include "fontrecord.h"
+#include <QStringView>
+#include <QVector>
+
+class QDataStream;
+
+namespace fonta {
+
+/*
+ * Every distinct string once in a single buffer, ids are indexes.
+ * Lookup table is needed only while adding, squeeze() drops it.
+ */
+class StringPool
+{
+public:
+    u32 add(CStringRef s);
+    QStringView view(u32 id) const { return QStringView(m_chars.constData() + m_offsets.at(id), m_offsets.at(id+1) - m_offsets.at(id)); }
+    QString at(u32 id) const { return view(id).toString(); }
+    int count() const { return m_offsets.size() - 1; }
+
+    void squeeze();
+    qint64 bytes() const;
+
+    friend QDataStream &operator<<(QDataStream &out, const StringPool &pool);
+    friend QDataStream &operator>>(QDataStream &in,        StringPool &pool);
+
+private:
+    QString m_chars;
+    QVector<u32> m_offsets {0}; // string i is [m_offsets[i], m_offsets[i+1])
+    QHash<QString, u32> m_ids;
+};
+
+/*
+ * Immutable columnar catalogue. Fonts and files are integer ids, family names,
+ * styles, directories and file names live once in the string pool (files of
+ * one directory share its prefix), classification is packed column per field,
+ * cmap coverage is a compressed bitmap per font. Every script has a bitset
+ * over fonts built from OS/2 ranges. Name records of every language are kept
+ * per font and indexed by nameKey() of family-like ones. Faces of font are rows of
+ * style, weight, width, selection and italic angle columns, named instances of
+ * variable fonts are virtual faces with fvar coordinates; axes are rows too.
+ * Fonts sharing files are linked by connected components of file <-> font graph.
+ * Built from scanner's TTFMap, rebuilt as whole when catalogue changes.
+ */
+class Catalogue
+{
+public:
+    using Id = int;
+    static const Id null = -1;
+
+    Catalogue() = default;
+    explicit Catalogue(const TTFMap &TTFs);
+
+    //! scanner structures back, to merge rescan results
+    void unpack(TTFMap &TTFs, File2FontsMap &File2Fonts) const;
+
+    bool isEmpty() const { return m_family.isEmpty(); }
+    int fontsCount() const { return m_family.size(); }
+    int filesCount() const { return m_fileName.size(); }
+
+    //! binary search, null if there is no such font or file
+    Id font(CStringRef family) const;
+    Id file(CStringRef path) const;
+
+    QString family(Id font) const { return m_strings.at(m_family.at(font)); }
+    QString filePath(Id file) const;
+    FontTraits traits(Id font) const;
+    //! bitset index lookup, no traits are unpacked
+    bool supports(Id font, Script::type script) const {
+        return m_scriptFonts.at(script*scriptWords() + font/64) & (u64(1) << (font%64));
+    }
+    //! non-empty subfamily names of faces
+    QStringList styles(Id font) const;
+    //! faces of font in scan order, OS/2 weight, width, selection and post italic angle of each
+    int facesCount(Id font) const { return m_faceStart.at(font+1) - m_faceStart.at(font); }
+    FontFace face(Id font, int face) const;
+    QVector<FontFace> faces(Id font) const;
+    //! index of face with style up to case, -1 if there is none
+    int face(Id font, CStringRef style) const;
+    //! some face of font has usWeightClass (usWidthClass) in [min, max] or its wght (wdth) axis reaches
+    //! there; columns only, no face is unpacked
+    bool hasWeight(Id font, int min, int max) const;
+    bool hasWidth(Id font, int min, int max) const;
+    bool hasItalic(Id font) const;
+    //! fvar axes of variable font, empty for static one
+    QVector<FontAxis> axes(Id font) const;
+    bool isVariable(Id font) const { return m_axisStart.at(font+1) != m_axisStart.at(font); }
+    //! font has axis and some value of [min, max] is in its range
+    bool hasAxis(Id font, u32 tag, double min, double max) const;
+    QStringList files(Id font) const;
+    QStringList fonts(Id file) const;
+    //! empty if font has no Unicode cmap (.fon)
+    const Coverage &coverage(Id font) const { return m_coverage.at(font); }
+    //! fonts mapping every code point, see Coverage::codePoints()
+    QVector<Id> fontsCovering(const QVector<u32> &codePoints) const;
+    //! name records of font's faces, every language
+    QVector<FontName> names(Id font) const;
+    //! fonts having family, full, PostScript, typographic or WWS name equal to name up to nameKey()
+    QVector<Id> fontsNamed(CStringRef name) const;
+    //! fonts any of those names contains text up to nameKey(), sorted
+    QVector<Id> searchNames(CStringRef text) const;
+    //! lowercase letters and digits only, so "Arial-Bold" and "arial bold" are the same
+    static QString nameKey(CStringRef name);
+
+    //! fonts connected with font through shared files, directly or not:
+    //! everything that goes away with it when its files are removed
+    QStringList linkedFonts(Id font) const;
+    int component(Id font) const { return m_component.at(font); }
+
+    struct Memory {
+        qint64 strings {0};
+        qint64 columns {0}; // per font and per file fields
+        qint64 relations {0}; // font <-> file and components
+        qint64 coverage {0};
+        qint64 total() const { return strings + columns + relations + coverage; }
+    };
+    Memory memory() const;
+    //! heap estimate of node based TTFMap + File2FontsMap layout for comparison
+    static qint64 mapMemory(const TTFMap &TTFs, const File2FontsMap &File2Fonts);
+
+    friend QDataStream &operator<<(QDataStream &out, const Catalogue &c);
+    friend QDataStream &operator>>(QDataStream &in,        Catalogue &c);
+
+private:
+    enum Flag : u8 {
+        Latin      = (1<<0),
+        Cyrillic   = (1<<1),
+        Monospaced = (1<<2),
+        Symbolic   = (1<<3),
+        Valid      = (1<<4),
+    };
+
+    StringPool m_strings;
+
+    // fonts, sorted by family
+    QVector<u32> m_family;
+    QVector<u8> m_familyClass;
+    QVector<u8> m_familySubClass;
+    QVector<u8> m_flags;
+    QVector<Panose> m_panose;
+    QVector<u32> m_unicodeRange;  // 4 words per font
+    QVector<u32> m_codePageRange; // 2 words per font
+    QVector<u32> m_faceStart;   // font i faces are [m_faceStart[i] .. m_faceStart[i+1]) of face columns
+    QVector<u32> m_faceStyle;
+    QVector<u16> m_faceWeight;
+    QVector<u8> m_faceWidth;
+    QVector<u16> m_faceSelection;
+    QVector<i32> m_faceItalicAngle;
+    QVector<i16> m_faceInstance;
+    QVector<u32> m_faceCoordStart; // face i coordinates are m_faceCoords[m_faceCoordStart[i] .. m_faceCoordStart[i+1])
+    QVector<i32> m_faceCoords;
+    QVector<u32> m_axisStart;      // axes of font, as faces
+    QVector<u32> m_axisTag;
+    QVector<i32> m_axisMin;
+    QVector<i32> m_axisDef;
+    QVector<i32> m_axisMax;
+    QVector<u32> m_axisName;
+    QVector<u32> m_fileStart;   // the same for files of font
+    QVector<Id> m_files;
+    QVector<Coverage> m_coverage;
+    QVector<u32> m_nameStart;   // name records of font, as faces
+    QVector<u32> m_name;
+    QVector<u8> m_nameId;
+    QVector<u8> m_namePlatform;
+    QVector<u16> m_nameLanguage;
+
+    // name index: nameKey() and font pairs sorted by key string, then font
+    QVector<u32> m_indexKey;
+    QVector<Id> m_indexFont;
+
+    // files, sorted by directory and name
+    QVector<u32> m_dir;
+    QVector<u32> m_fileName;
+    QVector<u32> m_fontStart;   // fonts of file
+    QVector<Id> m_fonts;
+
+    // connected components of file <-> font graph, not stored but built by union-find
+    QVector<Id> m_component;       // per font
+    QVector<u32> m_componentStart; // component i fonts are m_members[m_componentStart[i] .. m_componentStart[i+1])
+    QVector<Id> m_members;
+
+    // script i fonts are bits of m_scriptFonts[i*scriptWords() .. (i+1)*scriptWords()), not stored
+    QVector<u64> m_scriptFonts;
+    int scriptWords() const { return (fontsCount() + 63)/64; }
+
+    void buildComponents();
+    void buildScripts();
+    void buildNameIndex();
+};
+
+} // namespace fonta
+
+#endif // CATALOGUE_H
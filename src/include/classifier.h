@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include <QtWidgets/QApplication>
+#include <QHash>
 
 namespace fonta {
 
@@ -96,6 +97,8 @@ public:
     };
 
     int fontInfo(CStringRef family, SearchType searchType = AdvancedSearch) const;
+    //! fontInfo() for a name that already went through trim()
+    int trimmedFontInfo(CStringRef trimmed, SearchType searchType = AdvancedSearch) const;
     void addFontInfo(CStringRef family, int info);
     void rewriteFontInfo(CStringRef family, int info);
 
@@ -104,11 +107,13 @@ public:
 private:
     QString m_dbPath;
     QMap<FontType::type, QStringList> m_db;
+    QHash<QString, int> m_index; // trimmed name -> types it is listed in
     bool m_changed {false};
 
     bool loadFontType(FontType::type tupe);
     bool storeFontType(FontType::type type);
     void _addFontInfo(CStringRef family, int info);
+    void rebuildIndex();
 
     static int internalNormalizeInfo(int info);
 };
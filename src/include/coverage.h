@@ -0,0 +1,79 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include "types.h"
+#include <QMap>
+#include <QVector>
+
+class QDataStream;
+
+namespace fonta {
+
+/*
+ * Compressed set of Unicode code points, roaring bitmap style: code points are
+ * grouped by high 16 bits, every group is stored as the smallest of sorted array,
+ * runs or 8 KB bitmap. Fonts map a few thousand code points at most and mostly
+ * as contiguous ranges, so typical coverage takes a few hundred bytes.
+ */
+class Coverage
+{
+public:
+    //! collects code points in plain bitmaps, build() compresses them
+    class Builder
+    {
+    public:
+        void add(u32 codePoint) { addRange(codePoint, codePoint); }
+        //! both inclusive
+        void addRange(u32 first, u32 last);
+        void add(const Coverage &coverage);
+        bool isEmpty() const { return m_bitmaps.isEmpty(); }
+
+        Coverage build() const;
+
+    private:
+        QMap<u16, QVector<u64>> m_bitmaps; // 1024 words per group
+    };
+
+    Coverage() = default;
+
+    //! distinct printable code points of text, sorted; spaces and controls aren't rendered
+    static QVector<u32> codePoints(CStringRef text);
+
+    bool isEmpty() const { return m_keys.isEmpty(); }
+    bool contains(u32 codePoint) const;
+    //! codePoints must be sorted, see codePoints()
+    bool containsAll(const QVector<u32> &codePoints) const;
+    int count() const;
+    qint64 bytes() const;
+
+    Coverage united(const Coverage &other) const;
+
+    bool operator==(const Coverage &other) const {
+        return m_keys == other.m_keys && m_kinds == other.m_kinds && m_starts == other.m_starts && m_values == other.m_values;
+    }
+    bool operator!=(const Coverage &other) const { return !(*this == other); }
+
+    friend QDataStream &operator<<(QDataStream &out, const Coverage &c);
+    friend QDataStream &operator>>(QDataStream &in,        Coverage &c);
+
+private:
+    enum Kind : u8 {
+        Array,  // sorted low halves
+        Runs,   // pairs of first low half and length - 1
+        Bitmap, // 4096 words, bit per code point
+    };
+
+    QVector<u16> m_keys;   // high halves, sorted
+    QVector<u8> m_kinds;
+    QVector<u32> m_starts; // group i is m_values[m_starts[i] .. m_starts[i+1])
+    QVector<u16> m_values;
+
+    //! group kinds and sizes, for data which didn't come from Builder
+    bool isValid() const;
+
+    bool groupContains(int group, u16 low) const;
+};
+
+} // namespace fonta
+
+#endif // COVERAGE_H
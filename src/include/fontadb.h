@@ -5,95 +5,17 @@
 #include <QString>
 #include <QMultiHash>
 #include <QSet>
-#include <unordered_map>
-#include "panose.h"
+#include <thread>
+#include "catalogue.h"
 #include "classifier.h"
+#include "scanprogress.h"
+#include "scanreport.h"
 
-namespace std
-{
-    template <>
-    struct hash<QString>
-    {
-        size_t operator()(const QString& s) const
-        {
-            return qHash(s);
-        }
-    };
-}
+class QFileSystemWatcher;
+class QTimer;
 
 namespace fonta {
 
-enum_class (FamilyClass) {
-    NO = 0,
-    OLDSTYLE_SERIF = 1,
-    TRANSITIONAL_SERIF = 2,
-    MODERN_SERIF = 3,
-    CLARENDON_SERIF = 4,
-    SLAB_SERIF = 5,
-    FREEFORM_SERIF = 7,
-    SANS_SERIF = 8,
-    ORNAMENTAL = 9,
-    SCRIPT = 10,
-    SYMBOL = 12,
-
-enum_interface
-
-    static QString toString(type t) {
-        switch(t) {
-            default:
-            case NO:                 return QCoreApplication::translate("fonta", "No Info");            break;
-            case OLDSTYLE_SERIF:     return QCoreApplication::translate("fonta", "Oldstyle Serif");     break;
-            case TRANSITIONAL_SERIF: return QCoreApplication::translate("fonta", "Transitional Serif"); break;
-            case MODERN_SERIF:       return QCoreApplication::translate("fonta", "Modern Serif");       break;
-            case CLARENDON_SERIF:    return QCoreApplication::translate("fonta", "Clarendon Serif");    break;
-            case SLAB_SERIF:         return QCoreApplication::translate("fonta", "Slab Serif");         break;
-            case FREEFORM_SERIF:     return QCoreApplication::translate("fonta", "Freeform Serif");     break;
-            case SANS_SERIF:         return QCoreApplication::translate("fonta", "Sans Serif");         break;
-            case ORNAMENTAL:         return QCoreApplication::translate("fonta", "Decorative");         break;
-            case SCRIPT:             return QCoreApplication::translate("fonta", "Script");             break;
-            case SYMBOL:             return QCoreApplication::translate("fonta", "Symbolic");           break;
-        }
-    }
-
-    static bool noInfo(type t) { return t == NO || t == 6 || t == 11 || t == 13 || t == 14; }
-    static bool isSerif(type t) { return (t >= OLDSTYLE_SERIF && t <= SLAB_SERIF) || (t == FREEFORM_SERIF); }
-    static bool isSans(type t) { return t == SANS_SERIF; }
-};
-
-struct TTF {
-    FamilyClass::type familyClass;
-    int familySubClass;
-    bool latin;
-    bool cyrillic;
-    Panose panose;
-    bool valid;
-
-    // these fields are needed for resolving and control font dependencies while removing font from PC
-    // when we delete file we should remove all related files
-    // also user should be awared of related fonts which can be removed/reduced while removing particular font
-    QSet<QString> files;       // files where this font is defined
-    QSet<QString> linkedFonts; // fonts located in the same files with this font
-
-    TTF()
-        : familyClass(FamilyClass::NO)
-        , familySubClass(0)
-        , latin(false)
-        , cyrillic(false)
-        , panose(0)
-        , valid(false)
-    {}
-
-    TTF(const TTF &other) = delete;
-    TTF &operator= (const TTF &) = delete;
-
-    TTF(TTF &&other) = default;
-    TTF &operator= (TTF &&) = default;
-
-    bool isValid() const { return valid; }
-    bool isNull() const { return !valid; }
-    static const TTF null;
-};
-
 struct QtFontInfo {
     bool cyrillic;
     bool monospaced;
@@ -101,21 +23,85 @@ struct QtFontInfo {
 };
 
 struct FullFontInfo {
-    const TTF *fontaTFF;
+    FontTraits traits;
+    QStringList files;
+    QStringList linkedFonts;
     QtFontInfo qtInfo;
     bool TTFExists;
 };
 
-class TTFMap : public std::unordered_map<QString, TTF>
-{
-public:
-    bool contains(CStringRef key) const {
-        auto res = find(key);
-        return res != end();
-    }
+//! bit per DB predicate, see DB::predicates(); 64-bit underlying type keeps high bits on every compiler
+enum_class (Predicate) : u64 {
+    Serif           = (1<<0),
+    SansSerif       = (1<<1),
+    Monospaced      = (1<<2),
+    Script          = (1<<3),
+    Decorative      = (1<<4),
+    Symbolic        = (1<<5),
+    OldStyle        = (1<<6),
+    Transitional    = (1<<7),
+    Modern          = (1<<8),
+    Slab            = (1<<9),
+    CoveSerif       = (1<<10),
+    SquareSerif     = (1<<11),
+    BoneSerif       = (1<<12),
+    AsymmetricSerif = (1<<13),
+    TriangleSerif   = (1<<14),
+    Grotesque       = (1<<15),
+    Geometric       = (1<<16),
+    Humanist        = (1<<17),
+    NormalSans      = (1<<18),
+    RoundedSans     = (1<<19),
+    FlarredSans     = (1<<20),
+    Cyrillic        = (1<<21),
+    Greek           = (1<<22),
+    Armenian        = (1<<23),
+    Hebrew          = (1<<24),
+    Arabic          = (1<<25),
+    Devanagari      = (1<<26),
+    Thai            = (1<<27),
+    Georgian        = (1<<28),
+    Chinese         = (1<<29),
+    Japanese        = (1<<30),
+    Korean          = (1ull<<31),
+    Light           = (1ull<<32),
+    Bold            = (1ull<<33),
+    Condensed       = (1ull<<34),
+    Expanded        = (1ull<<35),
+    Italic          = (1ull<<36),
+    Variable        = (1ull<<37),
+
+enum_interface
+};
+
+//! difference between two catalogue snapshots, families are in DB::familyLess() order
+struct CatalogueDelta {
+    QStringList added;
+    QStringList removed;
+    QStringList changed;           // in both snapshots, some predicates flipped
+    QVector<u64> changedPredicates; // Predicate bits flipped, per changed family
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+};
+
+struct FileStamp {
+    qint64 size {0};
+    qint64 modified {0}; // ms since epoch
+
+    bool operator==(const FileStamp &other) const { return size == other.size && modified == other.modified; }
+    bool operator!=(const FileStamp &other) const { return !(*this == other); }
 };
 
-using File2FontsMap = QHash<QString, QSet<QString>>;
+using FileStamps = QHash<QString, FileStamp>;
+
+//! how family names coming from outside (QFontDatabase, settings, UI) were found in catalogue
+struct FamilyLookups {
+    int exact {0};      // catalogue family as is
+    int reconciled {0}; // by other name record, without foundry or trailing style words
+    int missed {0};
+
+    double hitRate() const;
+};
 
 class DB : public QObject
 {
@@ -128,23 +114,51 @@ private:
     static DB *mInstance;
 
 private slots:
-    void updateProgress();
+    void applyRescan(void *result);
+    void onDirectoryChanged(const QString &dir);
+    void rescanDirty();
 
 signals:
-    void emitProgress(int i);
     void loadFinished(int i = 0);
+    //! catalogue changed after loadFinished(): rescan or uninstall
+    void catalogueChanged(const fonta::CatalogueDelta &delta);
 
 public:
     static DB *instance();
     ~DB();
 
+    //! loads last catalogue snapshot and validates it in background;
+    //! loadFinished() is emitted before return if there was a snapshot, after the first scan otherwise
     void load();
-
-    QStringList families() const;
-    QStringList styles(CStringRef family) const { return QtDB->styles(family); }
-    QFont font(CStringRef family, CStringRef style, int pointSize) const { return QtDB->font(family, style, pointSize); }
+    bool isLoaded() const { return m_loaded; }
+    //! rereads new and changed files of dirs (every font dir if empty) in background,
+    //! no-op while previous rescan runs
+    void rescan(const QStringList &dirs = QStringList());
+    //! catalogue of given files only: no system dirs, no cache (tools and benchmarks)
+    void loadFiles(const QStringList &files);
+
+    //! answered from parsed catalogue, QFontDatabase is not needed until rendering
+    QStringList families() const { return m_families; }
+    //! order of families(): case insensitive, ties broken by case
+    static bool familyLess(CStringRef a, CStringRef b);
+    //! installed family spelled as alias up to case, spaces and dashes, or having it as
+    //! any other family-like name (localized, typographic, full, PostScript); null if there is none
+    QString resolveFamily(CStringRef alias) const;
+    //! first of aliases which is installed
+    QString resolveFamily(const QStringList &aliases) const;
+    //! installed families any name of which contains text up to case, spaces and dashes
+    QStringList searchFamilies(CStringRef text) const;
+    QStringList styles(CStringRef family) const;
+    //! faces of family as scanned, empty for unknown family
+    QVector<FontFace> faces(CStringRef family) const;
+    //! made from face's weight, width and slant; QFontDatabase is asked only for faces catalogue doesn't know
+    QFont font(CStringRef family, CStringRef style, int pointSize) const;
     QStringList linkedFonts(CStringRef family) const;
     QStringList fontFiles(CStringRef family) const;
+    //! code points of family's cmaps, empty for unknown family and fonts without Unicode cmap
+    const Coverage &coverage(CStringRef family) const;
+    //! installed families mapping every printable character of text, in families() order
+    QStringList familiesRendering(CStringRef text) const;
 
     void uninstall(CStringRef family);
     QStringList uninstalled() const;
@@ -179,61 +193,112 @@ public:
 
     bool isNonCyrillic(CStringRef family) const;
     bool isCyrillic(CStringRef family) const;
+
+    //! OS/2 ranges of family tell script is supported, answered by catalogue's bitset index
+    bool supports(CStringRef family, Script::type script) const;
+    bool isGreek(CStringRef family) const { return supports(family, Script::Greek); }
+    bool isArmenian(CStringRef family) const { return supports(family, Script::Armenian); }
+    bool isHebrew(CStringRef family) const { return supports(family, Script::Hebrew); }
+    bool isArabic(CStringRef family) const { return supports(family, Script::Arabic); }
+    bool isDevanagari(CStringRef family) const { return supports(family, Script::Devanagari); }
+    bool isThai(CStringRef family) const { return supports(family, Script::Thai); }
+    bool isGeorgian(CStringRef family) const { return supports(family, Script::Georgian); }
+    bool isChinese(CStringRef family) const { return supports(family, Script::Chinese); }
+    bool isJapanese(CStringRef family) const { return supports(family, Script::Japanese); }
+    bool isKorean(CStringRef family) const { return supports(family, Script::Korean); }
+
+    //! catalogue family the name (e.g. Qt's "Family [Foundry]" or "Family Bold") belongs to, null if none
+    QString catalogueFamily(CStringRef family) const;
+    //! counted by every family lookup since start
+    FamilyLookups familyLookups() const { return m_lookups; }
+    //! lookups hit rate and QFontDatabase families catalogue doesn't know, for diagnostics
+    QString lookupReport() const;
+
+    //! some face of family has usWeightClass (usWidthClass) in [min, max], answered by catalogue's face columns
+    bool hasWeight(CStringRef family, int min, int max) const;
+    bool hasWidth(CStringRef family, int min, int max) const;
+    bool isLight(CStringRef family) const { return hasWeight(family, 1, 300); }
+    bool isBold(CStringRef family) const { return hasWeight(family, 700, 1000); }
+    bool isCondensed(CStringRef family) const { return hasWidth(family, 1, 4); }
+    bool isExpanded(CStringRef family) const { return hasWidth(family, 6, 9); }
+    bool isItalic(CStringRef family) const;
+
+    //! fvar axes of family, parsed once per file and cached with catalogue
+    QVector<FontAxis> axes(CStringRef family) const;
+    bool isVariable(CStringRef family) const;
+    //! family has axis tag ("wght", "opsz", ...) reaching some value of [min, max], e.g. wght >= 700 is (700, 1000)
+    bool hasAxis(CStringRef family, CStringRef tag, double min, double max) const;
+
+    //! Predicate bits of every is*() which holds for family
+    u64 predicates(CStringRef family) const;
     //bool isNotLatinOrCyrillic(CStringRef family) const;
 
-    const TTF &getTTF(CStringRef family) const;
+    //! default (null) traits for unknown family
+    FontTraits traits(CStringRef family) const;
+    //! compares parsed data with QFontDatabase, debug only
     FullFontInfo getFullFontInfo(CStringRef family) const;
 
-    QFontDatabase& getQtDB() { return *QtDB; }
+    //! created on first call, GUI thread only
+    QFontDatabase& getQtDB() { return qtDatabase(); }
+
+    //! per-file results of scans made by this process, empty when catalogue came from cache; GUI thread only
+    const ScanReport &scanReport() const { return m_scanReport; }
+    //! could be sampled from GUI thread while load() scans
+    const ScanProgress &scanProgress() const { return m_scanProgress; }
+    const Catalogue &catalogue() const { return m_catalogue; }
 
 private:
-    QFontDatabase *QtDB = nullptr;
+    mutable QFontDatabase *QtDB = nullptr; // see qtDatabase()
     Classifier classifier;
-    TTFMap TTFs;
-    File2FontsMap File2Fonts;
+    Catalogue m_catalogue;
+    ScanReport m_scanReport;
+    ScanProgress m_scanProgress;
+    FileStamps m_fileStamps; // files catalogue was built from
+    std::thread m_loader;
+    QFileSystemWatcher *m_watcher = nullptr; // every font dir and subdir, created by first rescan
+    QTimer *m_debounce = nullptr;
+    QStringList m_dirtyDirs; // changed since last rescan, waiting for debounce
+    bool m_loaded {false};
+    bool m_seeded {false}; // catalogue holds fontconfig data until first scan
+
+    struct Rescan;
 
     friend QDataStream &operator<<(QDataStream &out, const DB &db);
     friend QDataStream &operator>>(QDataStream &in,        DB &db);
 
-    int loadedFiles = 0;
-    int filesCount = 0;
-    int progress = 0;
-
+    // built once per catalogue snapshot
+    QStringList m_families;            // installed and not uninstalled
+    QHash<QString, QString> m_aliases; // Catalogue::nameKey() -> installed family
+    QHash<QString, int> m_fontInfo;    // installed family -> Classifier info
+
+    // Qt and other non-catalogue spellings -> fonts, best first; filled on demand, GUI thread only
+    mutable QHash<QString, QVector<Catalogue::Id>> m_reconciled;
+    mutable FamilyLookups m_lookups;
+    mutable FamilyLookups m_qtFamilies; // of QFontDatabase::families()
+    mutable QStringList m_qtUnmatched;
+
+    bool loadCache();
+    void saveCache() const;
+    void scan(const FileStamps &known, const QStringList &toDelete, const QStringList &dirs, Rescan &rescan);
+    void watch(const QStringList &dirs);
     void updateUninstalledFonts();
+    QFontDatabase &qtDatabase() const;
+    QStringList catalogueFamilies() const;
+    void buildIndex(QStringList families);
+    void update(Catalogue catalogue);
+    static CatalogueDelta diff(const QStringList &before, const QStringList &after);
+    int fontInfo(CStringRef family) const;
+    //! exact catalogue family first, reconciled name then
+    Catalogue::Id fontOf(CStringRef family) const;
+    QVector<Catalogue::Id> reconcile(CStringRef family) const;
+    void reconcileQtFamilies() const;
 };
 
-#ifndef FONTA_DETAILED_DEBUG
-class LoadThread : public QObject
-{
-    Q_OBJECT
-
-public:
-    LoadThread(const QStringList &out, int from, int to, TTFMap &TTFs, File2FontsMap &File2Fonts)
-        : out(out)
-        , from(from)
-        , to(to)
-        , TTFs(TTFs)
-        , File2Fonts(File2Fonts)
-    {}
-
-public slots:
-    void load();
-
-signals:
-    void fileLoaded();
-
-private:
-    const QStringList &out;
-    int from;
-    int to;
-    TTFMap &TTFs;
-    File2FontsMap &File2Fonts;
-};
-#endif
-
 inline DB& fontaDB() { return *DB::instance(); }
 inline QFontDatabase& qtDB() { return fontaDB().getQtDB(); }
 
 } // namespace fonta
 
+Q_DECLARE_METATYPE(fonta::CatalogueDelta)
+
 #endif // FONTADB_H
@@ -0,0 +1,29 @@
+#ifndef FONTCONFIGSOURCE_H
+#define FONTCONFIGSOURCE_H
+
+#include "fontadb.h"
+
+namespace fonta {
+
+/*
+ * Catalogue seed from fontconfig's own cache (Linux): family and style names, files, pitch and
+ * coverage of every installed face without opening a single font file.
+ * OS/2 classification (PANOSE, sFamilyClass) is not there, FontReader fills it later.
+ */
+class FontconfigSource
+{
+public:
+    //! false when built without FONTA_FONTCONFIG or switched off by "Fontconfig" setting
+    static bool available();
+
+    //! adds faces of fontconfig's supported font files except of skipped ones
+    static bool read(TTFMap &TTFs, File2FontsMap &File2Fonts, const QStringList &skip = QStringList());
+
+    //! dirs fontconfig takes fonts from (fonts.conf, /usr/local/share/fonts...) with their subdirs;
+    //! empty without FONTA_FONTCONFIG, doesn't depend on "Fontconfig" setting
+    static QStringList fontDirs();
+};
+
+} // namespace fonta
+
+#endif // FONTCONFIGSOURCE_H
@@ -0,0 +1,60 @@
+#ifndef FONTREADER_H
+#define FONTREADER_H
+
+#include "fontadb.h"
+#include "scanprogress.h"
+#include "scanreport.h"
+#include "sfnt.h"
+#include <QFile>
+
+namespace fonta {
+
+/*
+ * Reads name records, OS/2 classification, pitch, cmap coverage and fvar axes of every face in .ttf/.otf/.ttc/.otc/.fon files.
+ * Readers could be run from several threads over the same maps.
+ */
+class FontReader
+{
+public:
+    FontReader(TTFMap &TTFs, File2FontsMap &File2Fonts, ScanReport *report = nullptr);
+    ~FontReader();
+
+    //! returns size of file, 0 if it couldn't be opened
+    qint64 readFile(CStringRef fileName);
+
+    //! font files in dirs and their subdirs, bytes gets their total size, stamps their sizes and mtimes
+    static QStringList fontFiles(const QStringList &dirs, qint64 *bytes = nullptr, FileStamps *stamps = nullptr);
+
+    //! reads files on threads (0 - one per core), progress is updated by every worker
+    static void readFiles(const QStringList &files, TTFMap &TTFs, File2FontsMap &File2Fonts,
+                          int threads = 0, ScanProgress *progress = nullptr, ScanReport *report = nullptr);
+
+private:
+    TTFMap &TTFs;
+    File2FontsMap &File2Fonts;
+
+    ScanReport *report;
+    FileScan scan;
+
+    QFile f;
+    TTFTableRecord tablesMap[TTFTable::count];
+
+    bool readTablesMap(const u8 *const data);
+    void readTTF();
+    void readTTC();
+    void readFON();
+    void readFont();
+    Coverage readCoverage();
+    //! whole table, empty if font has none
+    QByteArray readTable(TTFTable::type type);
+
+    void fail(ScanError::type error);
+
+    template <typename T> inline T read();
+    template <typename T> inline T readRaw();
+    qint64 readData(char *data, qint64 size);
+};
+
+} // namespace fonta
+
+#endif // FONTREADER_H
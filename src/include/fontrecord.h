@@ -0,0 +1,393 @@
+#ifndef FONTRECORD_H
+#define FONTRECORD_H
+
+#include "types.h"
+#include "coverage.h"
+#include "panose.h"
+#include <QCoreApplication>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace std
+{
+    template <>
+    struct hash<QString>
+    {
+        size_t operator()(const QString& s) const
+        {
+            return qHash(s);
+        }
+    };
+}
+
+namespace fonta {
+
+enum_class (FamilyClass) {
+    NO = 0,
+    OLDSTYLE_SERIF = 1,
+    TRANSITIONAL_SERIF = 2,
+    MODERN_SERIF = 3,
+    CLARENDON_SERIF = 4,
+    SLAB_SERIF = 5,
+    FREEFORM_SERIF = 7,
+    SANS_SERIF = 8,
+    ORNAMENTAL = 9,
+    SCRIPT = 10,
+    SYMBOL = 12,
+
+enum_interface
+
+    static QString toString(type t) {
+        switch(t) {
+            default:
+            case NO:                 return QCoreApplication::translate("fonta", "No Info");            break;
+            case OLDSTYLE_SERIF:     return QCoreApplication::translate("fonta", "Oldstyle Serif");     break;
+            case TRANSITIONAL_SERIF: return QCoreApplication::translate("fonta", "Transitional Serif"); break;
+            case MODERN_SERIF:       return QCoreApplication::translate("fonta", "Modern Serif");       break;
+            case CLARENDON_SERIF:    return QCoreApplication::translate("fonta", "Clarendon Serif");    break;
+            case SLAB_SERIF:         return QCoreApplication::translate("fonta", "Slab Serif");         break;
+            case FREEFORM_SERIF:     return QCoreApplication::translate("fonta", "Freeform Serif");     break;
+            case SANS_SERIF:         return QCoreApplication::translate("fonta", "Sans Serif");         break;
+            case ORNAMENTAL:         return QCoreApplication::translate("fonta", "Decorative");         break;
+            case SCRIPT:             return QCoreApplication::translate("fonta", "Script");             break;
+            case SYMBOL:             return QCoreApplication::translate("fonta", "Symbolic");           break;
+        }
+    }
+
+    static bool noInfo(type t) { return t == NO || t == 6 || t == 11 || t == 13 || t == 14; }
+    static bool isSerif(type t) { return (t >= OLDSTYLE_SERIF && t <= SLAB_SERIF) || (t == FREEFORM_SERIF); }
+    static bool isSans(type t) { return t == SANS_SERIF; }
+};
+
+//! writing systems told by OS/2 Unicode and code page ranges
+enum_class (Script) {
+    Latin,
+    Greek,
+    Cyrillic,
+    Armenian,
+    Hebrew,
+    Arabic,
+    Devanagari,
+    Thai,
+    Georgian,
+    Chinese,
+    Japanese,
+    Korean,
+    count
+
+enum_interface
+
+    static QString toString(type t) {
+        switch(t) {
+            default:
+            case Latin:      return QCoreApplication::translate("fonta", "Latin");      break;
+            case Greek:      return QCoreApplication::translate("fonta", "Greek");      break;
+            case Cyrillic:   return QCoreApplication::translate("fonta", "Cyrillic");   break;
+            case Armenian:   return QCoreApplication::translate("fonta", "Armenian");   break;
+            case Hebrew:     return QCoreApplication::translate("fonta", "Hebrew");     break;
+            case Arabic:     return QCoreApplication::translate("fonta", "Arabic");     break;
+            case Devanagari: return QCoreApplication::translate("fonta", "Devanagari"); break;
+            case Thai:       return QCoreApplication::translate("fonta", "Thai");       break;
+            case Georgian:   return QCoreApplication::translate("fonta", "Georgian");   break;
+            case Chinese:    return QCoreApplication::translate("fonta", "Chinese");    break;
+            case Japanese:   return QCoreApplication::translate("fonta", "Japanese");   break;
+            case Korean:     return QCoreApplication::translate("fonta", "Korean");     break;
+        }
+    }
+
+    //! fontconfig language tag of script
+    static const char *lang(type t) {
+        switch(t) {
+            default:
+            case Latin:      return "en";
+            case Greek:      return "el";
+            case Cyrillic:   return "ru";
+            case Armenian:   return "hy";
+            case Hebrew:     return "he";
+            case Arabic:     return "ar";
+            case Devanagari: return "hi";
+            case Thai:       return "th";
+            case Georgian:   return "ka";
+            case Chinese:    return "zh-cn";
+            case Japanese:   return "ja";
+            case Korean:     return "ko";
+        }
+    }
+
+    //! OS/2 ulUnicodeRange bit of script's main block
+    static int unicodeBit(type t) {
+        switch(t) {
+            default:
+            case Latin:      return 0;
+            case Greek:      return 7;
+            case Cyrillic:   return 9;
+            case Armenian:   return 10;
+            case Hebrew:     return 11;
+            case Arabic:     return 13;
+            case Devanagari: return 15;
+            case Thai:       return 24;
+            case Georgian:   return 26;
+            case Chinese:    return 59; // CJK Unified Ideographs
+            case Japanese:   return 49; // Hiragana
+            case Korean:     return 56; // Hangul Syllables
+        }
+    }
+};
+
+//! classification of font family, everything filters look at
+struct FontTraits {
+    FamilyClass::type familyClass;
+    int familySubClass;
+    bool latin;
+    bool cyrillic;
+    bool monospaced; // post.isFixedPitch
+    bool symbolic;   // OS/2 Symbol code page
+    Panose panose;
+    u32 unicodeRange[4];  // OS/2 ulUnicodeRange1..4
+    u32 codePageRange[2]; // OS/2 ulCodePageRange1..2, zero for version 0 tables
+    bool valid;
+
+    FontTraits()
+        : familyClass(FamilyClass::NO)
+        , familySubClass(0)
+        , latin(false)
+        , cyrillic(false)
+        , monospaced(false)
+        , symbolic(false)
+        , panose(0)
+        , unicodeRange{0, 0, 0, 0}
+        , codePageRange{0, 0}
+        , valid(false)
+    {}
+
+    bool isValid() const { return valid; }
+    bool isNull() const { return !valid; }
+
+    bool unicodeBit(int bit) const { return unicodeRange[bit/32] & (1u << (bit%32)); }
+    bool codePageBit(int bit) const { return codePageRange[bit/32] & (1u << (bit%32)); }
+
+    bool supports(Script::type script) const {
+        switch(script) {
+            default:
+            case Script::Latin:      return unicodeBit(0) || unicodeBit(1) || unicodeBit(2) || unicodeBit(3) || codePageBit(0) || codePageBit(1);
+            case Script::Greek:      return unicodeBit(7) || codePageBit(3);
+            case Script::Cyrillic:   return unicodeBit(9) || codePageBit(2);
+            case Script::Armenian:   return unicodeBit(10);
+            case Script::Hebrew:     return unicodeBit(11) || codePageBit(5);
+            case Script::Arabic:     return unicodeBit(13) || codePageBit(6);
+            case Script::Devanagari: return unicodeBit(15);
+            case Script::Thai:       return unicodeBit(24) || codePageBit(16);
+            case Script::Georgian:   return unicodeBit(26);
+            // CJK ideographs bit is set by Japanese and Korean fonts too, so it counts only without their code pages
+            case Script::Chinese:    return codePageBit(18) || codePageBit(20)
+                                         || (unicodeBit(59) && !supports(Script::Japanese) && !supports(Script::Korean));
+            case Script::Japanese:   return unicodeBit(49) || unicodeBit(50) || codePageBit(17);
+            case Script::Korean:     return unicodeBit(56) || codePageBit(19) || codePageBit(21);
+        }
+    }
+
+    bool operator==(const FontTraits &other) const {
+        return familyClass == other.familyClass && familySubClass == other.familySubClass
+            && latin == other.latin && cyrillic == other.cyrillic
+            && monospaced == other.monospaced && symbolic == other.symbolic
+            && valid == other.valid && memcmp(&panose, &other.panose, sizeof(Panose)) == 0
+            && memcmp(unicodeRange, other.unicodeRange, sizeof(unicodeRange)) == 0
+            && memcmp(codePageRange, other.codePageRange, sizeof(codePageRange)) == 0;
+    }
+    bool operator!=(const FontTraits &other) const { return !(*this == other); }
+};
+
+//! decoded name table record
+struct FontName {
+    enum Id : u16 {
+        Family = 1,
+        Subfamily = 2,
+        Full = 4,
+        PostScript = 6,
+        TypographicFamily = 16,
+        TypographicSubfamily = 17,
+        WWSFamily = 21,
+        WWSSubfamily = 22,
+    };
+
+    u16 id;
+    u16 platform; // 0 Unicode, 1 Macintosh, 3 Windows
+    u16 language; // Windows LCID or Macintosh language code
+    QString name;
+
+    //! family-like names identify font, subfamily ones only its faces
+    bool isFamily() const { return id == Family || id == Full || id == PostScript || id == TypographicFamily || id == WWSFamily; }
+
+    bool operator==(const FontName &other) const {
+        return id == other.id && platform == other.platform && language == other.language && name == other.name;
+    }
+    bool operator!=(const FontName &other) const { return !(*this == other); }
+};
+
+//! face of family as its OS/2 and post tables describe it
+struct FontFace {
+    enum Selection : u16 {
+        Italic  = (1<<0),
+        Bold    = (1<<5),
+        Regular = (1<<6),
+        Oblique = (1<<9),
+    };
+
+    QString style;       // subfamily name, english-like; empty for bitmap fonts
+    u16 weight {400};    // usWeightClass, 1..1000
+    u16 width {5};       // usWidthClass, 1 (ultra-condensed) .. 9 (ultra-expanded)
+    u16 selection {0};   // fsSelection
+    i32 italicAngle {0}; // post italicAngle, 16.16 fixed degrees, negative leans right
+    i16 instance {-1};   // fvar named instance this virtual face stands for, -1 for real face
+    QVector<i32> coordinates; // instance's 16.16 fixed value per axis of font
+
+    bool isItalic() const { return (selection & (Italic | Oblique)) || italicAngle != 0; }
+    bool isVirtual() const { return instance >= 0; }
+    double slant() const { return italicAngle / 65536.0; }
+    //! width as QFont::Stretch percentage
+    int stretch() const { return stretch(width); }
+    static int stretch(int widthClass) {
+        static const int percents[] = {50, 62, 75, 87, 100, 112, 125, 150, 200};
+        return percents[qBound(1, widthClass, 9) - 1];
+    }
+    //! the narrowest width class not narrower than stretch percentage (fontconfig width, wdth axis)
+    static u16 widthClass(double percent) {
+        u16 w = 1;
+        while(w < 9 && stretch(w) < percent) {
+            ++w;
+        }
+        return w;
+    }
+
+    bool operator==(const FontFace &other) const {
+        return style == other.style && weight == other.weight && width == other.width
+            && selection == other.selection && italicAngle == other.italicAngle
+            && instance == other.instance && coordinates == other.coordinates;
+    }
+    bool operator!=(const FontFace &other) const { return !(*this == other); }
+};
+
+//! design axis of variable font, fvar values in user space
+struct FontAxis {
+    enum Tag : u32 {
+        Weight      = 0x77676874, // wght
+        Width       = 0x77647468, // wdth, percents
+        Slant       = 0x736C6E74, // slnt, degrees, negative leans right
+        Italic      = 0x6974616C, // ital, 0 or 1
+        OpticalSize = 0x6F70737A, // opsz, points
+    };
+
+    u32 tag;
+    i32 min; // 16.16 fixed
+    i32 def;
+    i32 max;
+    QString name; // STAT or fvar axis name, english-like
+
+    double minimum() const { return min / 65536.0; }
+    double defaultValue() const { return def / 65536.0; }
+    double maximum() const { return max / 65536.0; }
+    //! [lo, hi] has some value of axis
+    bool overlaps(double lo, double hi) const { return maximum() >= lo && minimum() <= hi; }
+
+    //! "wght" -> Weight; tags are four chars, shorter ones are padded with spaces
+    static u32 tagFromString(CStringRef s) {
+        u32 t = 0;
+        for(int i = 0; i<4; ++i) {
+            t = (t << 8) | (i < s.size() ? u8(s.at(i).toLatin1()) : u8(' '));
+        }
+        return t;
+    }
+    static QString tagToString(u32 t) {
+        const char chars[] = {char(t >> 24), char(t >> 16), char(t >> 8), char(t)};
+        return QString::fromLatin1(chars, 4).trimmed();
+    }
+
+    bool operator==(const FontAxis &other) const {
+        return tag == other.tag && min == other.min && def == other.def && max == other.max && name == other.name;
+    }
+    bool operator!=(const FontAxis &other) const { return !(*this == other); }
+};
+
+//! font family as scanner collects it, Catalogue keeps these compacted
+struct TTF : FontTraits {
+    QVector<FontFace> faces; // distinct by style, in scan order; named instances follow their font's real face
+    QVector<FontAxis> axes;  // united over variable faces, empty for static family
+
+    // these fields are needed for resolving and control font dependencies while removing font from PC
+    // when we delete file we should remove all related files
+    // also user should be awared of related fonts which can be removed/reduced while removing particular font
+    QSet<QString> files; // files where this font is defined, Catalogue links fonts sharing them
+    Coverage coverage;   // cmap code points of all faces
+    QVector<FontName> names; // distinct name records of all faces, every language
+
+    //! appends face unless family has its style already
+    void addFace(const FontFace &face) {
+        for(const FontFace &f : std::as_const(faces)) {
+            if(f.style == face.style) {
+                return;
+            }
+        }
+        faces << face;
+    }
+
+    //! new tags are appended, known ones get their ranges widened
+    void addAxes(const QVector<FontAxis> &other) {
+        for(const FontAxis &a : other) {
+            auto it = std::find_if(axes.begin(), axes.end(), [&a](const FontAxis &b) { return b.tag == a.tag; });
+            if(it == axes.end()) {
+                axes << a;
+            } else {
+                it->min = qMin(it->min, a.min);
+                it->max = qMax(it->max, a.max);
+            }
+        }
+    }
+
+    //! subfamily names of faces
+    QStringList styles() const {
+        QStringList list;
+        for(const FontFace &f : faces) {
+            if(!f.style.isEmpty()) {
+                list << f.style;
+            }
+        }
+        return list;
+    }
+
+    //! appends names which aren't there yet
+    void addNames(const QVector<FontName> &other) {
+        for(const FontName &n : other) {
+            if(!names.contains(n)) {
+                names << n;
+            }
+        }
+    }
+
+    TTF() = default;
+
+    TTF(const TTF &other) = delete;
+    TTF &operator= (const TTF &) = delete;
+
+    TTF(TTF &&other) = default;
+    TTF &operator= (TTF &&) = default;
+};
+
+class TTFMap : public std::unordered_map<QString, TTF>
+{
+public:
+    bool contains(CStringRef key) const {
+        auto res = find(key);
+        return res != end();
+    }
+};
+
+using File2FontsMap = QHash<QString, QSet<QString>>;
+
+} // namespace fonta
+
+#endif // FONTRECORD_H
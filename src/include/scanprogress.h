@@ -0,0 +1,60 @@
+#ifndef SCANPROGRESS_H
+#define SCANPROGRESS_H
+
+#include "types.h"
+#include <atomic>
+
+namespace fonta {
+
+/*
+ * Scan progress weighted by file sizes. Every reader thread bumps its own
+ * cache line sized counter, GUI samples the sums by timer whenever it wants.
+ */
+class ScanProgress
+{
+public:
+    ScanProgress() = default;
+    ScanProgress(const ScanProgress &) = delete;
+    ScanProgress &operator=(const ScanProgress &) = delete;
+
+    //! resets counters, totals are known after crawl
+    void start(qint64 totalBytes, int totalFiles);
+    void finish();
+    //! called by reader `worker` after each file
+    void fileRead(int worker, qint64 bytes) {
+        Slot &slot = m_slots[worker % slotsCount];
+        slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        slot.files.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool isStarted() const { return m_started.load(std::memory_order_acquire) >= 0; }
+    bool isFinished() const { return m_finished.load(std::memory_order_acquire); }
+
+    qint64 bytesDone() const;
+    int filesDone() const;
+    qint64 bytesTotal() const { return m_totalBytes.load(std::memory_order_relaxed); }
+    int filesTotal() const { return m_totalFiles.load(std::memory_order_relaxed); }
+
+    //! 0..1 of bytes
+    double fraction() const;
+    //! estimated ms left, -1 while unknown
+    qint64 etaMs() const;
+
+private:
+    static const int slotsCount = 64;
+
+    struct alignas(64) Slot {
+        std::atomic<qint64> bytes {0};
+        std::atomic<int> files {0};
+    };
+
+    Slot m_slots[slotsCount];
+    std::atomic<qint64> m_totalBytes {0};
+    std::atomic<int> m_totalFiles {0};
+    std::atomic<i64> m_started {-1}; // steady clock ns
+    std::atomic<bool> m_finished {false};
+};
+
+} // namespace fonta
+
+#endif // SCANPROGRESS_H
@@ -0,0 +1,94 @@
+#ifndef SCANREPORT_H
+#define SCANREPORT_H
+
+#include "types.h"
+#include <QCoreApplication>
+#include <QJsonObject>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include <mutex>
+
+namespace fonta {
+
+enum_class (ScanError) {
+    None,
+    Open,       // file couldn't be opened
+    Truncated,  // headers point past the end of file
+    NoTables,   // no name or OS/2 table
+    NoName,     // no usable family name record
+    Collection, // broken .ttc/.otc directory
+
+enum_interface
+
+    static QString toString(type t) {
+        switch(t) {
+            default:
+            case None:       return QCoreApplication::translate("fonta", "No error");
+            case Open:       return QCoreApplication::translate("fonta", "Couldn't open");
+            case Truncated:  return QCoreApplication::translate("fonta", "Truncated");
+            case NoTables:   return QCoreApplication::translate("fonta", "No name or OS/2 table");
+            case NoName:     return QCoreApplication::translate("fonta", "No family name");
+            case Collection: return QCoreApplication::translate("fonta", "Broken collection");
+        }
+    }
+
+    static QString key(type t) {
+        switch(t) {
+            default:
+            case None:       return QStringLiteral("none");
+            case Open:       return QStringLiteral("open");
+            case Truncated:  return QStringLiteral("truncated");
+            case NoTables:   return QStringLiteral("noTables");
+            case NoName:     return QStringLiteral("noName");
+            case Collection: return QStringLiteral("collection");
+        }
+    }
+};
+
+struct FileScan {
+    QString file;
+    i64 duration {0};  // ns
+    qint64 bytes {0};  // actually read, not file size
+    int faces {0};
+    ScanError::type error {ScanError::None};
+};
+
+/*
+ * Per-file results of one scan: slowest files, failures by reason, durations histogram.
+ * Files are added from reader threads, everything else is done by the thread owning report.
+ */
+class ScanReport
+{
+public:
+    void clear();
+    void add(FileScan &&scan);
+    void setWallTime(i64 ns) { m_wallTime = ns; }
+    //! takes results of other scan, they replace ones of the same files; removed files are forgotten
+    void merge(ScanReport &&other, const QStringList &removed);
+
+    bool isEmpty() const { return m_files.isEmpty(); }
+    const QVector<FileScan> &files() const { return m_files; }
+
+    int faces() const;
+    qint64 bytes() const;
+    QVector<FileScan> slowest(int count) const;
+    QMap<ScanError::type, QStringList> failures() const;
+
+    //! upper bounds of histogram buckets in ms, last bucket is unbounded
+    static const QVector<int> &histogramBounds();
+    QVector<int> histogram() const;
+
+    QJsonObject toJson(int slowestCount = 20) const;
+    QString toText(int slowestCount = 10) const;
+    bool save(CStringRef fileName) const;
+
+private:
+    mutable std::mutex m_mutex;
+    QVector<FileScan> m_files;
+    i64 m_wallTime {0};
+};
+
+} // namespace fonta
+
+#endif // SCANREPORT_H
@@ -0,0 +1,135 @@
+#ifndef SFNT_H
+#define SFNT_H
+
+#include "types.h"
+#include "panose.h"
+
+namespace fonta {
+
+// Raw sfnt structures as they are stored in font files (big-endian)
+
+#pragma pack(push, 1)
+
+struct TTFOffsetTable {
+    u32 SfntVersion;
+    u16 NumTables;
+    u16 SearchRange;
+    u16 EntrySelector;
+    u16 RangeShift;
+};
+
+struct TTFTableRecord {
+    char TableName[4];
+    u32 CheckSum;
+    u32 Offset;
+    u32 Length;
+};
+
+struct TTFNameHeader {
+    u16 Selector;
+    u16 RecordsCount;
+    u16 StorageOffset;
+};
+
+struct TTFNameRecord {
+    u16 PlatformID;
+    u16 EncodingID;
+    u16 LanguageID;
+    u16 NameID;
+    u16 StringLength;
+    u16 StringOffset; //from start of storage area
+
+    TTFNameRecord() : PlatformID(1), EncodingID(0), LanguageID(0), NameID(1), StringLength(0), StringOffset(0)
+    {}
+};
+
+struct TTFOS2Header {
+    u16 Version;
+    i16 AvgCharWidth;
+    u16 WeightClass;
+    u16 WidthClass;
+    u32 placeholder2;
+    u32 placeholder3;
+    u32 placeholder4;
+    u32 placeholder5;
+    u32 placeholder6;
+    u16 placeholder7;
+
+    i16 FamilyClass;
+    Panose panose;
+    u32 UnicodeRange1;
+    u32 UnicodeRange2;
+    u32 UnicodeRange3;
+    u32 UnicodeRange4;
+    char VendorID[4];
+    u16 Selection;
+    u16 FirstCharIndex;
+    u16 LastCharIndex;
+    i16 TypoAscender;
+    i16 TypoDescender;
+    i16 TypoLineGap;
+    u16 WinAscent;
+    u16 WinDescent;
+    // version 1+
+    u32 CodePageRange1;
+    u32 CodePageRange2;
+};
+
+// OS/2 version 0 ends before code page ranges
+static const u32 TTFOS2HeaderV0Size = sizeof(TTFOS2Header) - 2*sizeof(u32);
+
+struct TTFPostHeader {
+    u32 Version;
+    u32 ItalicAngle;
+    i16 UnderlinePosition;
+    i16 UnderlineThickness;
+    u32 IsFixedPitch;
+};
+
+struct TTFCmapHeader {
+    u16 Version;
+    u16 TablesCount;
+};
+
+struct TTFCmapEncodingRecord {
+    u16 PlatformID;
+    u16 EncodingID;
+    u32 Offset; // from start of cmap
+};
+
+#pragma pack(pop)
+
+namespace TTFTable {
+    enum type {
+        NO = -1,
+        NAME,
+        OS2,
+        POST, // optional
+        CMAP, // optional
+        FVAR, // optional, variable fonts only
+        STAT, // optional
+        count
+    };
+}
+
+template <typename T> inline void swap(T &x);
+
+template <> inline void swap<u16>(u16 &x)
+{
+    x = u16( 0
+             | ((x & 0x00ff) << 8)
+             | ((x & 0xff00) >> 8) );
+}
+
+template <> inline void swap<u32>(u32 &x)
+{
+    x = 0
+        | ((x & 0x000000ff) << 24)
+        | ((x & 0x0000ff00) << 8)
+        | ((x & 0x00ff0000) >> 8)
+        | ((x & 0xff000000) >> 24);
+}
+
+} // namespace fonta
+
+#endif // SFNT_H
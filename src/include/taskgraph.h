@@ -0,0 +1,54 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include "types.h"
+#include <QVector>
+#include <functional>
+#include <initializer_list>
+
+namespace fonta {
+
+/*
+ * One-shot graph of dependent tasks. Independent tasks run concurrently on worker
+ * threads, CallerThread tasks (anything touching GUI objects) run on the thread
+ * calling run(). Every task is traced, the critical path gets its own trace track.
+ */
+class TaskGraph
+{
+public:
+    using Id = int;
+
+    enum Affinity {
+        AnyThread,
+        CallerThread,
+    };
+
+    //! name must be a string literal, deps must be added before
+    Id add(const char *name, std::function<void()> task, std::initializer_list<Id> deps = {}, Affinity affinity = AnyThread);
+
+    //! blocks until every task is done
+    void run();
+
+    //! tasks which gated the last finished one, in execution order
+    QVector<Id> criticalPath() const;
+    i64 started(Id id) const { return m_tasks.at(id).started; }
+    i64 finished(Id id) const { return m_tasks.at(id).finished; }
+    const char *name(Id id) const { return m_tasks.at(id).name; }
+
+private:
+    struct Task {
+        const char *name;
+        std::function<void()> run;
+        QVector<Id> deps;
+        QVector<Id> dependents;
+        Affinity affinity;
+        i64 started {0};
+        i64 finished {0};
+    };
+
+    QVector<Task> m_tasks;
+};
+
+} // namespace fonta
+
+#endif // TASKGRAPH_H
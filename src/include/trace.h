@@ -0,0 +1,76 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "types.h"
+#include <QStringList>
+#include <atomic>
+
+/*
+ * Runtime tracing: scoped spans and counters go to per-thread ring buffers
+ * and are exported as Chrome trace-event JSON (chrome://tracing, Perfetto).
+ *
+ * Disabled tracing costs one relaxed atomic load per span. Enabled by
+ * FONTA_TRACE=<file> environment variable or --trace <file> option,
+ * see trace::setup(). Names and categories must be string literals.
+ */
+
+namespace fonta {
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> enabled;
+void record(char phase, const char *category, const char *name, i64 ts, i64 value);
+}
+
+inline bool enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+
+//! nanoseconds since tracing epoch
+i64 now();
+
+//! span started at `started` (from now()) and ending now, for async work like network replies
+void complete(const char *category, const char *name, i64 started);
+void counter(const char *category, const char *name, i64 value);
+void instant(const char *category, const char *name);
+//! span on its own `id` track instead of thread's one, e.g. critical path over several threads
+void async(const char *category, const char *name, i64 id, i64 started, i64 finished);
+
+//! enables tracing from FONTA_TRACE or --trace/--trace=<file> in arguments, trace is written on exit
+void setup(const QStringList &arguments);
+//! writes everything recorded so far
+bool write(CStringRef fileName);
+//! drops everything recorded so far
+void clear();
+
+class Span
+{
+public:
+    Span(const char *category, const char *name)
+        : m_category(category)
+        , m_name(name)
+        , m_started(enabled() ? now() : -1)
+    {}
+
+    ~Span() {
+        if(m_started >= 0) {
+            complete(m_category, m_name, m_started);
+        }
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_name;
+    i64 m_started;
+};
+
+} // namespace trace
+} // namespace fonta
+
+#define FONTA_TRACE_CONCAT_(a, b) a##b
+#define FONTA_TRACE_CONCAT(a, b) FONTA_TRACE_CONCAT_(a, b)
+#define FONTA_TRACE_SPAN(category, name) fonta::trace::Span FONTA_TRACE_CONCAT(fontaTraceSpan, __LINE__)(category, name)
+
+#endif // TRACE_H
@@ -0,0 +1,22 @@
+QT += core gui testlib
+
+include( ../../../common.pri )
+
+TARGET = tst_catalogue_cache
+DESTDIR = $${BIN_PATH}/
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH *= ../../fontadb/
+
+SOURCES += \
+    tst_cataloguecache.cpp
+
+build_all:!build_pass {
+    CONFIG -= build_all
+    CONFIG += release
+}
+
+LIBS += -lfontadb$${LIB_SUFFIX}
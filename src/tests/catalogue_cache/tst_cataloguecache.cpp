@@ -0,0 +1,121 @@
+#include <QtTest>
+
+#include "catalogue.h"
+#include "fontrecord.h"
+#include "serialization.h"
+
+using namespace fonta;
+
+/*
+ * Catalogue cache is read without bounds checks afterwards,
+ * so every damaged column must fail the stream instead.
+ */
+class tst_CatalogueCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void shortColumn_data();
+    void shortColumn();
+};
+
+static Catalogue makeCatalogue()
+{
+    TTFMap TTFs;
+    const QStringList families = {QStringLiteral("Alpha Sans"), QStringLiteral("Beta Serif")};
+    for(CStringRef family : families) {
+        TTF &ttf = TTFs[family];
+        ttf.valid = true;
+        ttf.files << QString(QStringLiteral("/fonts/") + family + QStringLiteral(".ttf"));
+
+        FontFace face;
+        face.style = QStringLiteral("Regular");
+        ttf.addFace(face);
+    }
+
+    return Catalogue(TTFs);
+}
+
+static QByteArray write(const Catalogue &c)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+    out << c;
+    return bytes;
+}
+
+// the same cache with the last value of one per-font traits column dropped
+static QByteArray shortened(const QByteArray &bytes, CStringRef column)
+{
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+
+    StringPool strings;
+    QVector<u32> family;
+    QVector<u8> familyClass;
+    QVector<u8> familySubClass;
+    QVector<u8> flags;
+    QVector<Panose> panose;
+    in >> strings >> family >> familyClass >> familySubClass >> flags >> panose;
+    const QByteArray rest = bytes.mid(static_cast<int>(in.device()->pos()));
+
+    if(column == QLatin1String("familyClass")) {
+        familyClass.removeLast();
+    } else if(column == QLatin1String("familySubClass")) {
+        familySubClass.removeLast();
+    } else if(column == QLatin1String("flags")) {
+        flags.removeLast();
+    } else if(column == QLatin1String("panose")) {
+        panose.removeLast();
+    }
+
+    QByteArray result;
+    QDataStream out(&result, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+    out << strings << family << familyClass << familySubClass << flags << panose;
+    out.writeRawData(rest.constData(), rest.size());
+    return result;
+}
+
+void tst_CatalogueCache::roundTrip()
+{
+    const Catalogue written = makeCatalogue();
+
+    QDataStream in(write(written));
+    in.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+
+    Catalogue read;
+    in >> read;
+
+    QCOMPARE(in.status(), QDataStream::Ok);
+    QCOMPARE(read.fontsCount(), written.fontsCount());
+}
+
+void tst_CatalogueCache::shortColumn_data()
+{
+    QTest::addColumn<QString>("column");
+
+    QTest::newRow("familyClass") << QStringLiteral("familyClass");
+    QTest::newRow("familySubClass") << QStringLiteral("familySubClass");
+    QTest::newRow("flags") << QStringLiteral("flags");
+    QTest::newRow("panose") << QStringLiteral("panose");
+}
+
+void tst_CatalogueCache::shortColumn()
+{
+    QFETCH(QString, column);
+
+    QDataStream in(shortened(write(makeCatalogue()), column));
+    in.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+
+    Catalogue read;
+    in >> read;
+
+    QCOMPARE(in.status(), QDataStream::ReadCorruptData);
+}
+
+QTEST_APPLESS_MAIN(tst_CatalogueCache)
+
+#include "tst_cataloguecache.moc"
@@ -0,0 +1,19 @@
+QT += core testlib
+QT -= gui
+
+include( ../../../common.pri )
+
+TARGET = tst_font_traits
+DESTDIR = $${BIN_PATH}/
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += \
+    tst_fonttraits.cpp
+
+build_all:!build_pass {
+    CONFIG -= build_all
+    CONFIG += release
+}
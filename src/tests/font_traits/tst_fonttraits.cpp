@@ -0,0 +1,63 @@
+#include <QtTest>
+
+#include "fontrecord.h"
+
+using namespace fonta;
+
+/*
+ * Script filters as OS/2 ranges of real fonts drive them.
+ */
+class tst_FontTraits : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void japaneseOnly();
+    void chinese();
+    void panCJK();
+};
+
+static FontTraits traits(u32 unicode1, u32 unicode2, u32 unicode3, u32 codePage1)
+{
+    FontTraits t;
+    t.unicodeRange[0] = unicode1;
+    t.unicodeRange[1] = unicode2;
+    t.unicodeRange[2] = unicode3;
+    t.codePageRange[0] = codePage1;
+    t.valid = true;
+    return t;
+}
+
+void tst_FontTraits::japaneseOnly()
+{
+    // Latin, kana, CJK ideographs (bit 59), no Hangul; code pages Latin and Shift-JIS (17) only
+    const FontTraits jp = traits(0xE00002FF, 0x6AC7FDFB, 0x00000012, 0x0002009F);
+
+    QVERIFY(jp.supports(Script::Japanese));
+    QVERIFY(jp.unicodeBit(59));
+    QVERIFY(!jp.supports(Script::Chinese));
+    QVERIFY(!jp.supports(Script::Korean));
+}
+
+void tst_FontTraits::chinese()
+{
+    // GB2312 (18) code page
+    QVERIFY(traits(0x00000003, 0x08000000, 0, 0x00040001).supports(Script::Chinese));
+
+    // version 0 table: ideographs without Japanese or Korean ranges
+    QVERIFY(traits(0x00000003, 0x08000000, 0, 0).supports(Script::Chinese));
+}
+
+void tst_FontTraits::panCJK()
+{
+    // every CJK code page: Shift-JIS, GB2312, Wansung, Big5, Johab
+    const FontTraits cjk = traits(0xE00002FF, 0x7BDFFCFF, 0x00000016, 0x003E0001);
+
+    QVERIFY(cjk.supports(Script::Chinese));
+    QVERIFY(cjk.supports(Script::Japanese));
+    QVERIFY(cjk.supports(Script::Korean));
+}
+
+QTEST_APPLESS_MAIN(tst_FontTraits)
+
+#include "tst_fonttraits.moc"
@@ -0,0 +1,23 @@
+QT += core
+QT -= gui
+
+include( ../../../common.pri )
+
+TARGET = font_synth
+DESTDIR = $${BIN_PATH}/
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+    fontsynth.cpp
+
+HEADERS += \
+    fontsynth.h
+
+build_all:!build_pass {
+    CONFIG -= build_all
+    CONFIG += release
+}
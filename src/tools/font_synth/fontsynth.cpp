@@ -0,0 +1,562 @@
+#include "fontsynth.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+
+namespace fonta {
+
+// SynthRandom
+
+u64 SynthRandom::next()
+{
+    u64 z = (m_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int SynthRandom::range(int from, int to)
+{
+    return from + static_cast<int>(next() % static_cast<u64>(to - from + 1));
+}
+
+bool SynthRandom::chance(double p)
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0) < p;
+}
+
+// sfnt assembling
+
+namespace {
+
+struct Table {
+    QByteArray tag;
+    QByteArray data;
+};
+
+struct Style {
+    const char *name;
+    int weight;
+    bool bold;
+    bool italic;
+};
+
+const QVector<Style> styles = {
+    { "Regular",     400, false, false },
+    { "Bold",        700, true,  false },
+    { "Italic",      400, false, true  },
+    { "Bold Italic", 700, true,  true  },
+    { "Light",       300, false, false },
+    { "Medium",      500, false, false },
+    { "Black",       900, false, false },
+    { "Thin",        100, false, false },
+};
+
+const QVector<QString> syllables = {
+    "ar", "bel", "cor", "dax", "el", "fi", "gar", "hel", "io", "jun", "kor", "lum", "mer",
+    "nov", "or", "pax", "quin", "ros", "sol", "tur", "ul", "ver", "wen", "xan", "yor", "zel",
+};
+
+const QVector<int> familyClasses = { 0, 1, 2, 3, 4, 5, 7, 8, 8, 8, 9, 10, 12 };
+
+u32 checksum(const QByteArray &data)
+{
+    u32 sum = 0;
+    const int n = (data.size() + 3) / 4;
+    for(int i = 0; i<n; ++i) {
+        u32 word = 0;
+        for(int j = 0; j<4; ++j) {
+            const int k = i*4 + j;
+            word = (word << 8) | (k < data.size() ? static_cast<u8>(data[k]) : 0);
+        }
+        sum += word;
+    }
+    return sum;
+}
+
+void pad4(QByteArray &data)
+{
+    while(data.size() % 4) {
+        data.append('\0');
+    }
+}
+
+QByteArray utf16be(CStringRef s)
+{
+    QByteArray bytes;
+    for(const QChar &c : s) {
+        bytes.append(static_cast<char>(c.unicode() >> 8));
+        bytes.append(static_cast<char>(c.unicode() & 0xFF));
+    }
+    return bytes;
+}
+
+QString postScriptName(const SynthFace &face)
+{
+    QString name = face.family + '-' + face.style;
+    name.remove(' ');
+    return name;
+}
+
+QByteArray headTable(const SynthFace &face)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << u32(0x00010000) << u32(0x00010000);
+    out << u32(0);                 // checkSumAdjustment, patched later
+    out << u32(0x5F0F3CF5);
+    out << u16(0x000B) << u16(1000);
+    out << i64(3534364800ll) << i64(3534364800ll); // 2016-01-01, fixed for reproducibility
+    out << i16(0) << i16(-200) << i16(500) << i16(800);
+    out << u16((face.bold ? 1 : 0) | (face.italic ? 2 : 0));
+    out << u16(8) << i16(2) << i16(0) << i16(0);
+
+    return data;
+}
+
+QByteArray hheaTable()
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << u32(0x00010000);
+    out << i16(800) << i16(-200) << i16(0);
+    out << u16(500) << i16(0) << i16(0) << i16(500);
+    out << i16(1) << i16(0) << i16(0);
+    out << i16(0) << i16(0) << i16(0) << i16(0);
+    out << i16(0) << u16(1);
+
+    return data;
+}
+
+QByteArray maxpTable()
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << u32(0x00010000) << u16(1);
+    const u16 limits[13] = { 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0 };
+    for(u16 v : limits) {
+        out << v;
+    }
+
+    return data;
+}
+
+QByteArray hmtxTable()
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << u16(500) << i16(0);
+    return data;
+}
+
+QByteArray locaTable()
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << u16(0) << u16(0); // .notdef without outline
+    return data;
+}
+
+QByteArray postTable()
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << u32(0x00030000) << i32(0) << i16(-100) << i16(50);
+    out << u32(0) << u32(0) << u32(0) << u32(0) << u32(0);
+    return data;
+}
+
+QByteArray cmapTable()
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << u16(0) << u16(1);
+    out << u16(3) << u16(1) << u32(12);
+
+    // format 4 with the only terminating segment
+    out << u16(4) << u16(24) << u16(0);
+    out << u16(2) << u16(2) << u16(0) << u16(0);
+    out << u16(0xFFFF) << u16(0) << u16(0xFFFF) << i16(1) << u16(0);
+
+    return data;
+}
+
+QByteArray nameTable(const SynthFace &face)
+{
+    struct Record {
+        u16 platform, encoding, language, id;
+        QByteArray string;
+    };
+
+    QVector<Record> records;
+
+    const QString full = face.style == QLatin1String("Regular") ? face.family : QString(face.family + ' ' + face.style);
+    const QString ps = postScriptName(face);
+
+    // Macintosh Roman, names are ASCII
+    records.push_back({1, 0, 0, 1, face.family.toLatin1()});
+    records.push_back({1, 0, 0, 2, face.style.toLatin1()});
+    records.push_back({1, 0, 0, 4, full.toLatin1()});
+    records.push_back({1, 0, 0, 6, ps.toLatin1()});
+
+    // Windows Unicode BMP, English
+    records.push_back({3, 1, 0x0409, 1, utf16be(face.family)});
+    records.push_back({3, 1, 0x0409, 2, utf16be(face.style)});
+    records.push_back({3, 1, 0x0409, 4, utf16be(full)});
+    records.push_back({3, 1, 0x0409, 6, utf16be(ps)});
+    if(!face.typoFamily.isEmpty()) {
+        records.push_back({3, 1, 0x0409, 16, utf16be(face.typoFamily)});
+        records.push_back({3, 1, 0x0409, 17, utf16be(face.typoStyle)});
+    }
+
+    // Windows Unicode BMP, Russian
+    if(!face.localizedFamily.isEmpty()) {
+        records.push_back({3, 1, 0x0419, 1, utf16be(face.localizedFamily)});
+    }
+
+    std::stable_sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+        if(a.platform != b.platform) return a.platform < b.platform;
+        if(a.encoding != b.encoding) return a.encoding < b.encoding;
+        if(a.language != b.language) return a.language < b.language;
+        return a.id < b.id;
+    });
+
+    QByteArray storage;
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << u16(0) << u16(records.size()) << u16(6 + 12*records.size());
+    for(const Record &r : std::as_const(records)) {
+        out << r.platform << r.encoding << r.language << r.id;
+        out << u16(r.string.size()) << u16(storage.size());
+        storage += r.string;
+    }
+    out.writeRawData(storage.constData(), storage.size());
+
+    return data;
+}
+
+QByteArray os2Table(const SynthFace &face)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    out << u16(4);                              // version
+    out << i16(500) << u16(face.weight) << u16(5) << u16(0);
+    out << i16(650) << i16(700) << i16(0) << i16(140);   // subscript
+    out << i16(650) << i16(700) << i16(0) << i16(480);   // superscript
+    out << i16(50) << i16(250);                          // strikeout
+    out << i16((face.familyClass << 8) | face.familySubClass);
+    out.writeRawData(reinterpret_cast<const char *>(face.panose), 10);
+    for(u32 range : face.unicodeRange) {
+        out << range;
+    }
+    out.writeRawData("SYNT", 4);
+    u16 fsSelection = 0;
+    if(face.italic) fsSelection |= 0x01;
+    if(face.bold)   fsSelection |= 0x20;
+    if(!face.italic && !face.bold) fsSelection |= 0x40; // REGULAR
+    out << fsSelection;
+    out << u16(0x20) << u16(0xFFFF);
+    out << i16(800) << i16(-200) << i16(0) << u16(800) << u16(200);
+    out << face.codePageRange[0] << face.codePageRange[1];
+    out << i16(500) << i16(700) << u16(0) << u16(0x20) << u16(1);
+
+    return data;
+}
+
+QVector<Table> faceTables(const SynthFace &face)
+{
+    QVector<Table> tables = {
+        { "OS/2", os2Table(face) },
+        { "cmap", cmapTable() },
+        { "glyf", QByteArray() },
+        { "head", headTable(face) },
+        { "hhea", hheaTable() },
+        { "hmtx", hmtxTable() },
+        { "loca", locaTable() },
+        { "maxp", maxpTable() },
+        { "name", nameTable(face) },
+        { "post", postTable() },
+    };
+
+    std::sort(tables.begin(), tables.end(), [](const Table &a, const Table &b) {
+        return a.tag < b.tag;
+    });
+
+    return tables;
+}
+
+//! offset table, directory and tables; offsets are counted from base
+QByteArray sfnt(const SynthFace &face, u32 base)
+{
+    QVector<Table> tables = faceTables(face);
+    const u16 numTables = tables.size();
+
+    u16 entrySelector = 0;
+    while((1 << (entrySelector+1)) <= numTables) {
+        ++entrySelector;
+    }
+    const u16 searchRange = (1 << entrySelector) * 16;
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out << u32(0x00010000) << numTables << searchRange << entrySelector << u16(numTables*16 - searchRange);
+
+    QByteArray body;
+    int headOffset = -1;
+    u32 offset = base + 12 + numTables*16;
+
+    for(const Table &t : std::as_const(tables)) {
+        out.writeRawData(t.tag.constData(), 4);
+        out << checksum(t.data) << offset << u32(t.data.size());
+
+        if(t.tag == "head") {
+            headOffset = body.size();
+        }
+
+        body += t.data;
+        pad4(body);
+        offset = base + 12 + numTables*16 + body.size();
+    }
+
+    QByteArray font = header + body;
+
+    // checkSumAdjustment over the whole font
+    const u32 adjustment = 0xB1B0AFBA - checksum(font);
+    const int at = 12 + numTables*16 + headOffset + 8;
+    for(int i = 0; i<4; ++i) {
+        font[at + i] = static_cast<char>(adjustment >> (24 - 8*i));
+    }
+
+    return font;
+}
+
+} // namespace
+
+QByteArray FontSynth::buildTTF(const SynthFace &face)
+{
+    return sfnt(face, 0);
+}
+
+QByteArray FontSynth::buildTTC(const QVector<SynthFace> &faces)
+{
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.writeRawData("ttcf", 4);
+    out << u32(0x00010000) << u32(faces.size());
+
+    u32 base = 12 + 4*faces.size();
+    QByteArray body;
+    for(const SynthFace &face : faces) {
+        out << base;
+        QByteArray font = sfnt(face, base);
+        pad4(font);
+        body += font;
+        base += font.size();
+    }
+
+    return header + body;
+}
+
+// FontSynth
+
+FontSynth::FontSynth(const SynthOptions &options)
+    : m_options(options)
+    , m_random(options.seed)
+{
+}
+
+QString FontSynth::familyName(QSet<QString> &used, int familyClass)
+{
+    static const QVector<QString> sansSuffixes = { "Sans", "Grotesk", "Gothic", "" };
+    static const QVector<QString> serifSuffixes = { "Serif", "Antiqua", "Text", "" };
+    static const QVector<QString> scriptSuffixes = { "Script", "Hand", "Brush" };
+    static const QVector<QString> otherSuffixes = { "Display", "Deco", "Symbols", "" };
+
+    QString name;
+    const int n = m_random.range(2, 3);
+    for(int i = 0; i<n; ++i) {
+        name += m_random.pick(syllables);
+    }
+    name[0] = name[0].toUpper();
+
+    QString suffix;
+    if(familyClass == 8) {
+        suffix = m_random.pick(sansSuffixes);
+    } else if(familyClass >= 1 && familyClass <= 7) {
+        suffix = m_random.pick(serifSuffixes);
+    } else if(familyClass == 10) {
+        suffix = m_random.pick(scriptSuffixes);
+    } else {
+        suffix = m_random.pick(otherSuffixes);
+    }
+
+    if(!suffix.isEmpty()) {
+        name += ' ' + suffix;
+    }
+
+    const QString base = name;
+    for(int i = 2; used.contains(name); ++i) {
+        name = base + ' ' + QString::number(i);
+    }
+    used.insert(name);
+
+    return name;
+}
+
+void FontSynth::classify(SynthFace &face)
+{
+    face.familyClass = m_random.pick(familyClasses);
+    face.familySubClass = face.familyClass ? m_random.range(0, 4) : 0;
+
+    u8 *p = face.panose;
+    std::fill(p, p+10, 0);
+
+    switch(face.familyClass) {
+        case 8:  p[0] = 2; p[1] = m_random.range(11, 15); break; // sans
+        case 10: p[0] = 3; break;                                 // script
+        case 9:  p[0] = 4; break;                                 // ornamental
+        case 12: p[0] = 5; break;                                 // symbol
+        case 0:  p[0] = m_random.range(0, 2); break;              // no info
+        default: p[0] = 2; p[1] = m_random.range(2, 10); break;   // serifs
+    }
+    if(p[0] == 2) {
+        for(int i = 2; i<10; ++i) {
+            p[i] = m_random.range(2, 8);
+        }
+        p[3] = m_random.chance(0.05) ? 9 : m_random.range(2, 6); // rare monospaced
+    }
+
+    std::fill(face.unicodeRange, face.unicodeRange+4, 0);
+    std::fill(face.codePageRange, face.codePageRange+2, 0);
+
+    if(face.familyClass == 12) {
+        face.codePageRange[0] = 1u << 31; // symbol character set
+        return;
+    }
+
+    face.unicodeRange[0] |= 1u << 0; // Basic Latin
+    face.codePageRange[0] |= 1u << 0;
+    if(m_random.chance(0.8)) {
+        face.unicodeRange[0] |= 1u << 1; // Latin-1 Supplement
+    }
+    if(m_random.chance(0.3)) {
+        face.unicodeRange[0] |= 1u << 2; // Latin Extended-A
+        face.codePageRange[0] |= 1u << 1;
+    }
+    if(m_random.chance(0.1)) {
+        face.unicodeRange[0] |= 1u << 7; // Greek
+        face.codePageRange[0] |= 1u << 3;
+    }
+    if(m_random.chance(m_options.cyrillic)) {
+        face.unicodeRange[0] |= 1u << 9; // Cyrillic
+        face.codePageRange[0] |= 1u << 2;
+    }
+}
+
+QVector<SynthFile> FontSynth::plan()
+{
+    QVector<SynthFile> files;
+    QSet<QString> usedNames;
+
+    int faces = 0;
+    while(faces < m_options.faces) {
+        SynthFace proto;
+        classify(proto);
+
+        const QString family = familyName(usedNames, proto.familyClass);
+        if(m_random.chance(m_options.localized)) {
+            proto.localizedFamily = QStringLiteral("Синт ") + family;
+        }
+
+        const int count = qMin(m_random.range(1, qBound(1, m_options.maxStyles, styles.size())), m_options.faces - faces);
+        const bool collection = count > 1 && m_random.chance(m_options.ttcRatio);
+
+        QVector<SynthFace> familyFaces;
+        for(int i = 0; i<count; ++i) {
+            const Style &style = styles.at(i);
+            SynthFace face = proto;
+            face.weight = style.weight;
+            face.bold = style.bold;
+            face.italic = style.italic;
+
+            // styles beyond RIBBI get their own legacy family, as real fonts do
+            if(i < 4) {
+                face.family = family;
+                face.style = QLatin1String(style.name);
+            } else {
+                face.family = family + ' ' + QLatin1String(style.name);
+                face.style = QStringLiteral("Regular");
+                face.typoFamily = family;
+                face.typoStyle = QLatin1String(style.name);
+            }
+
+            familyFaces << face;
+        }
+        faces += count;
+
+        QString fileBase = family;
+        fileBase.remove(' ');
+
+        if(collection) {
+            SynthFile file;
+            file.path = subdir(files.size()) + fileBase + QStringLiteral(".ttc");
+            file.faces = familyFaces;
+            files << file;
+        } else {
+            for(const SynthFace &face : std::as_const(familyFaces)) {
+                SynthFile file;
+                file.path = subdir(files.size()) + postScriptName(face) + QStringLiteral(".ttf");
+                file.faces << face;
+                files << file;
+            }
+        }
+    }
+
+    return files;
+}
+
+QString FontSynth::subdir(int fileIndex) const
+{
+    QString path;
+
+    int n = fileIndex;
+    for(int level = 0; level<m_options.depth && m_options.dirs > 1; ++level) {
+        path += QStringLiteral("d%1/").arg(n % m_options.dirs, 3, 10, QChar('0'));
+        n /= m_options.dirs;
+    }
+
+    return path;
+}
+
+QVector<SynthFile> FontSynth::generate(CStringRef dir)
+{
+    QVector<SynthFile> files = plan();
+
+    QDir root(dir);
+    for(SynthFile &file : files) {
+        const QString path = root.filePath(file.path);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        QFile f(path);
+        if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning("Couldn't write %s", qPrintable(path));
+            continue;
+        }
+
+        f.write(file.faces.size() > 1 ? buildTTC(file.faces) : buildTTF(file.faces.first()));
+        file.path = path;
+    }
+
+    return files;
+}
+
+} // namespace fonta
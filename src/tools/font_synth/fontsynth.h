@@ -0,0 +1,88 @@
+#ifndef FONTSYNTH_H
+#define FONTSYNTH_H
+
+#include "types.h"
+#include <QByteArray>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+namespace fonta {
+
+//! Small deterministic generator (splitmix64), independent from platform rand()
+class SynthRandom
+{
+public:
+    explicit SynthRandom(u64 seed) : m_state(seed) {}
+
+    u64 next();
+    int range(int from, int to); // [from, to]
+    bool chance(double p);
+
+    template <typename T> const T &pick(const QVector<T> &v) { return v.at(range(0, v.size()-1)); }
+
+private:
+    u64 m_state;
+};
+
+struct SynthOptions {
+    u64 seed {1};
+    int faces {1000};        // faces to generate in total
+    int maxStyles {4};       // faces per family: 1..maxStyles
+    double ttcRatio {0.1};   // families packed into one .ttc
+    double cyrillic {0.3};   // faces with Cyrillic unicode range
+    double localized {0.1};  // families with russian name records
+    int dirs {1};            // subdirectories per level
+    int depth {1};           // levels of subdirectories, 0 for flat layout
+};
+
+struct SynthFace {
+    QString family;          // name id 1
+    QString style;           // name id 2
+    QString typoFamily;      // name id 16, empty for RIBBI styles
+    QString typoStyle;       // name id 17
+    QString localizedFamily; // russian name id 1, may be empty
+    int weight {400};
+    bool bold {false};
+    bool italic {false};
+    int familyClass {0};     // OS/2 sFamilyClass class id
+    int familySubClass {0};
+    u8 panose[10];
+    u32 unicodeRange[4];
+    u32 codePageRange[2];
+};
+
+struct SynthFile {
+    QString path;
+    QVector<SynthFace> faces;
+};
+
+/*
+ * Writes minimal but valid TrueType fonts: a single empty .notdef glyph and
+ * every required table (cmap, glyf, head, hhea, hmtx, loca, maxp, name, OS/2, post).
+ * Same options always produce byte-identical files.
+ */
+class FontSynth
+{
+public:
+    explicit FontSynth(const SynthOptions &options);
+
+    //! plans and writes corpus into dir, returns what was written
+    QVector<SynthFile> generate(CStringRef dir);
+
+    static QByteArray buildTTF(const SynthFace &face);
+    static QByteArray buildTTC(const QVector<SynthFace> &faces);
+
+private:
+    SynthOptions m_options;
+    SynthRandom m_random;
+
+    QVector<SynthFile> plan();
+    QString familyName(QSet<QString> &used, int familyClass);
+    void classify(SynthFace &face);
+    QString subdir(int fileIndex) const;
+};
+
+} // namespace fonta
+
+#endif // FONTSYNTH_H
@@ -0,0 +1,99 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include "fontsynth.h"
+
+/*
+ * Writes synthetic font corpus for scale testing:
+ *
+ *   font_synth --faces 20000 --seed 7 --ttc 0.2 --dirs 16 --depth 2 --manifest corpus.jsonl out/
+ *
+ * The same arguments always give byte-identical corpus.
+ */
+
+using namespace fonta;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const SynthOptions defaults;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Generates deterministic synthetic .ttf/.ttc corpus."));
+    parser.addHelpOption();
+    QCommandLineOption facesOption(QStringLiteral("faces"), QStringLiteral("Faces in total."), QStringLiteral("count"), QString::number(defaults.faces));
+    QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Random seed."), QStringLiteral("seed"), QString::number(defaults.seed));
+    QCommandLineOption stylesOption(QStringLiteral("styles"), QStringLiteral("Max faces per family (1-8)."), QStringLiteral("count"), QString::number(defaults.maxStyles));
+    QCommandLineOption ttcOption(QStringLiteral("ttc"), QStringLiteral("Share of families packed into .ttc."), QStringLiteral("ratio"), QString::number(defaults.ttcRatio));
+    QCommandLineOption cyrillicOption(QStringLiteral("cyrillic"), QStringLiteral("Share of faces with Cyrillic range."), QStringLiteral("ratio"), QString::number(defaults.cyrillic));
+    QCommandLineOption localizedOption(QStringLiteral("localized"), QStringLiteral("Share of families with russian names."), QStringLiteral("ratio"), QString::number(defaults.localized));
+    QCommandLineOption dirsOption(QStringLiteral("dirs"), QStringLiteral("Subdirectories per level."), QStringLiteral("count"), QString::number(defaults.dirs));
+    QCommandLineOption depthOption(QStringLiteral("depth"), QStringLiteral("Levels of subdirectories."), QStringLiteral("count"), QString::number(defaults.depth));
+    QCommandLineOption manifestOption(QStringLiteral("manifest"), QStringLiteral("Write JSON Lines list of files and faces."), QStringLiteral("file"));
+    parser.addOptions({facesOption, seedOption, stylesOption, ttcOption, cyrillicOption, localizedOption, dirsOption, depthOption, manifestOption});
+    parser.addPositionalArgument(QStringLiteral("dir"), QStringLiteral("Output dir."));
+    parser.process(a);
+
+    if(parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    SynthOptions options;
+    options.faces = parser.value(facesOption).toInt();
+    options.seed = parser.value(seedOption).toULongLong();
+    options.maxStyles = parser.value(stylesOption).toInt();
+    options.ttcRatio = parser.value(ttcOption).toDouble();
+    options.cyrillic = parser.value(cyrillicOption).toDouble();
+    options.localized = parser.value(localizedOption).toDouble();
+    options.dirs = parser.value(dirsOption).toInt();
+    options.depth = parser.value(depthOption).toInt();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    FontSynth synth(options);
+    const QVector<SynthFile> files = synth.generate(parser.positionalArguments().first());
+
+    if(parser.isSet(manifestOption)) {
+        QFile manifest(parser.value(manifestOption));
+        if(!manifest.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Couldn't write %s", qPrintable(manifest.fileName()));
+            return 1;
+        }
+
+        for(const SynthFile &file : files) {
+            QJsonArray faces;
+            for(const SynthFace &face : file.faces) {
+                QJsonObject f;
+                f[QStringLiteral("family")] = face.family;
+                f[QStringLiteral("style")] = face.style;
+                f[QStringLiteral("familyClass")] = face.familyClass;
+                f[QStringLiteral("cyrillic")] = !!(face.unicodeRange[0] & (1u << 9));
+                faces.append(f);
+            }
+
+            QJsonObject o;
+            o[QStringLiteral("path")] = file.path;
+            o[QStringLiteral("faces")] = faces;
+            manifest.write(QJsonDocument(o).toJson(QJsonDocument::Compact));
+            manifest.write("\n");
+        }
+    }
+
+    int faces = 0;
+    for(const SynthFile &file : files) {
+        faces += file.faces.size();
+    }
+
+    QTextStream err(stderr);
+    err << files.size() << " files, " << faces << " faces written in " << timer.elapsed() << " ms" << endl;
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+QT += core gui
+
+include( ../../../common.pri )
+
+TARGET = fonta_bench
+DESTDIR = $${BIN_PATH}/
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += \
+    ../font_synth \
+    ../../fontadb
+
+SOURCES += \
+    main.cpp \
+    ../font_synth/fontsynth.cpp
+
+HEADERS += \
+    ../font_synth/fontsynth.h
+
+RESOURCES += \
+    ../../fonta/resources/known_fonts.qrc
+
+build_all:!build_pass {
+    CONFIG -= build_all
+    CONFIG += release
+}
+
+LIBS += -lfontadb$${LIB_SUFFIX}
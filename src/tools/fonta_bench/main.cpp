@@ -0,0 +1,402 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <thread>
+
+#include "fontadb.h"
+#include "fontreader.h"
+#include "serialization.h"
+#include "fontsynth.h"
+
+/*
+ * Benchmarks every fontadb stage over synthetic corpora of growing size:
+ *
+ *   fonta_bench [--sizes 1000,10000,50000] [--repeat 5] [--seed 1] [--label v0.5] [--output bench.json] [dirs...]
+ *
+ * Extra dirs with real fonts are measured for parse throughput per format as well.
+ * Every stage is run `repeat` times, median and minimum are reported.
+ * Memory of catalogue is compared with node based maps it is built from.
+ */
+
+using namespace fonta;
+
+namespace {
+
+struct Timing {
+    qint64 median;
+    qint64 min;
+};
+
+template <typename F>
+Timing measure(int repeat, F &&f)
+{
+    QVector<qint64> ns;
+    ns.reserve(repeat);
+
+    QElapsedTimer timer;
+    for(int i = 0; i<repeat; ++i) {
+        timer.start();
+        f();
+        ns << timer.nsecsElapsed();
+    }
+
+    std::sort(ns.begin(), ns.end());
+    return {ns.at(ns.size()/2), ns.first()};
+}
+
+QJsonObject stage(const Timing &t, int items, qint64 bytes = 0)
+{
+    QJsonObject o;
+    o[QStringLiteral("medianMs")] = t.median / 1e6;
+    o[QStringLiteral("minMs")] = t.min / 1e6;
+    o[QStringLiteral("items")] = items;
+    if(t.median > 0) {
+        o[QStringLiteral("itemsPerSec")] = qRound64(items / (t.median / 1e9));
+        if(bytes > 0) {
+            o[QStringLiteral("mbPerSec")] = bytes / (1024.0*1024.0) / (t.median / 1e9);
+        }
+    }
+    return o;
+}
+
+qint64 totalSize(const QStringList &files)
+{
+    qint64 bytes = 0;
+    for(CStringRef file : files) {
+        bytes += QFileInfo(file).size();
+    }
+    return bytes;
+}
+
+QMap<QString, QStringList> byFormat(const QStringList &files)
+{
+    QMap<QString, QStringList> formats;
+    for(CStringRef file : files) {
+        formats[QFileInfo(file).suffix().toLower()] << file;
+    }
+    return formats;
+}
+
+QJsonObject parseStages(const QStringList &files, int repeat)
+{
+    QJsonObject stages;
+
+    cauto formats = byFormat(files);
+    for(auto it = formats.cbegin(); it != formats.cend(); ++it) {
+        cauto list = it.value();
+        const Timing t = measure(repeat, [&list]{
+            TTFMap TTFs;
+            File2FontsMap File2Fonts;
+            FontReader::readFiles(list, TTFs, File2Fonts, 1);
+        });
+        stages[QStringLiteral("parse.") + it.key()] = stage(t, list.size(), totalSize(list));
+    }
+
+    const Timing t = measure(repeat, [&files]{
+        TTFMap TTFs;
+        File2FontsMap File2Fonts;
+        FontReader::readFiles(files, TTFs, File2Fonts);
+    });
+    stages[QStringLiteral("parse.threaded")] = stage(t, files.size(), totalSize(files));
+
+    return stages;
+}
+
+using Predicate = bool (DB::*)(CStringRef) const;
+
+const QVector<QPair<QString, Predicate>> &predicates()
+{
+    static const QVector<QPair<QString, Predicate>> list = {
+        {QStringLiteral("isSerif"),           &DB::isSerif},
+        {QStringLiteral("isSansSerif"),       &DB::isSansSerif},
+        {QStringLiteral("isMonospaced"),      &DB::isMonospaced},
+        {QStringLiteral("isScript"),          &DB::isScript},
+        {QStringLiteral("isDecorative"),      &DB::isDecorative},
+        {QStringLiteral("isSymbolic"),        &DB::isSymbolic},
+        {QStringLiteral("isOldStyle"),        &DB::isOldStyle},
+        {QStringLiteral("isTransitional"),    &DB::isTransitional},
+        {QStringLiteral("isModern"),          &DB::isModern},
+        {QStringLiteral("isSlab"),            &DB::isSlab},
+        {QStringLiteral("isCoveSerif"),       &DB::isCoveSerif},
+        {QStringLiteral("isSquareSerif"),     &DB::isSquareSerif},
+        {QStringLiteral("isBoneSerif"),       &DB::isBoneSerif},
+        {QStringLiteral("isAsymmetricSerif"), &DB::isAsymmetricSerif},
+        {QStringLiteral("isTriangleSerif"),   &DB::isTriangleSerif},
+        {QStringLiteral("isGrotesque"),       &DB::isGrotesque},
+        {QStringLiteral("isGeometric"),       &DB::isGeometric},
+        {QStringLiteral("isHumanist"),        &DB::isHumanist},
+        {QStringLiteral("isNormalSans"),      &DB::isNormalSans},
+        {QStringLiteral("isRoundedSans"),     &DB::isRoundedSans},
+        {QStringLiteral("isFlarredSans"),     &DB::isFlarredSans},
+        {QStringLiteral("isCyrillic"),        &DB::isCyrillic},
+        {QStringLiteral("isGreek"),           &DB::isGreek},
+        {QStringLiteral("isArabic"),          &DB::isArabic},
+        {QStringLiteral("isChinese"),         &DB::isChinese},
+        {QStringLiteral("isBold"),            &DB::isBold},
+        {QStringLiteral("isCondensed"),       &DB::isCondensed},
+        {QStringLiteral("isVariable"),        &DB::isVariable},
+    };
+    return list;
+}
+
+// same walk as FilterWizard::accept() for "serif or sans of any kind, cyrillic only"
+int wizardFilter(const DB &db)
+{
+    int matched = 0;
+    for(CStringRef f : db.families()) {
+        if(!db.isCyrillic(f)) { continue; }
+
+        if(db.isOldStyle(f) || db.isTransitional(f) || db.isModern(f) || db.isSlab(f)) {
+            ++matched;
+            continue;
+        }
+
+        if(db.isGrotesque(f) || db.isGeometric(f) || db.isHumanist(f)) {
+            ++matched;
+        }
+    }
+    return matched;
+}
+
+QJsonObject corpusStages(const QStringList &files, int repeat, CStringRef dir)
+{
+    QJsonObject stages = parseStages(files, repeat);
+
+    TTFMap TTFs;
+    File2FontsMap File2Fonts;
+    FontReader::readFiles(files, TTFs, File2Fonts);
+    const int fonts = static_cast<int>(TTFs.size());
+
+    // catalogue, linked fonts components included
+    stages[QStringLiteral("catalogue.build")] = stage(measure(repeat, [&]{
+        Catalogue built(TTFs);
+        Q_UNUSED(built);
+    }), fonts);
+
+    const Catalogue catalogue(TTFs);
+
+    // cache
+    const QString cacheFile = dir + QStringLiteral("/cache.dat");
+    stages[QStringLiteral("cache.save")] = stage(measure(repeat, [&]{
+        QFile file(cacheFile);
+        file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+        stream << catalogue;
+    }), fonts, 0);
+
+    const qint64 cacheBytes = QFileInfo(cacheFile).size();
+    stages[QStringLiteral("cache.load")] = stage(measure(repeat, [&]{
+        QFile file(cacheFile);
+        file.open(QIODevice::ReadOnly);
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_DefaultCompiledVersion);
+        Catalogue loaded;
+        stream >> loaded;
+    }), fonts, cacheBytes);
+
+    // catalogue used by the rest
+    DB &db = fontaDB();
+    db.loadFiles(files);
+    const QStringList families = db.families();
+
+    // classifier
+    Classifier classifier;
+    classifier.load(QStringLiteral(":/known_fonts"));
+
+    stages[QStringLiteral("classifier.trim")] = stage(measure(repeat, [&]{
+        int length = 0;
+        for(CStringRef f : families) {
+            length += trim(f).length();
+        }
+        Q_UNUSED(length);
+    }), families.size());
+
+    stages[QStringLiteral("classifier.fontInfo")] = stage(measure(repeat, [&]{
+        int any = 0;
+        for(CStringRef f : families) {
+            any |= classifier.fontInfo(f);
+        }
+        Q_UNUSED(any);
+    }), families.size());
+
+    // predicates
+    for(cauto predicate : predicates()) {
+        const Predicate is = predicate.second;
+        stages[QStringLiteral("db.") + predicate.first] = stage(measure(repeat, [&]{
+            int matched = 0;
+            for(CStringRef f : families) {
+                matched += (db.*is)(f);
+            }
+            Q_UNUSED(matched);
+        }), families.size());
+    }
+
+    // filter
+    stages[QStringLiteral("filter.wizard")] = stage(measure(repeat, [&]{
+        wizardFilter(db);
+    }), families.size());
+
+    // the same string as typing in sample field would ask for
+    stages[QStringLiteral("db.familiesRendering")] = stage(measure(repeat, [&]{
+        const int found = db.familiesRendering(QStringLiteral("Quick brown fox")).size();
+        Q_UNUSED(found);
+    }), families.size());
+
+    stages[QStringLiteral("db.searchFamilies")] = stage(measure(repeat, [&]{
+        const int found = db.searchFamilies(QStringLiteral("sans")).size();
+        Q_UNUSED(found);
+    }), families.size());
+
+    // what changing current font in the list asks for
+    stages[QStringLiteral("db.styles")] = stage(measure(repeat, [&]{
+        int styles = 0;
+        for(CStringRef f : families) {
+            styles += db.styles(f).size();
+        }
+        Q_UNUSED(styles);
+    }), families.size());
+
+    stages[QStringLiteral("db.linkedFonts")] = stage(measure(repeat, [&]{
+        int linked = 0;
+        for(CStringRef f : families) {
+            linked += db.linkedFonts(f).size();
+        }
+        Q_UNUSED(linked);
+    }), families.size());
+
+    return stages;
+}
+
+// catalogue layout against node based maps it is built from
+QJsonObject memoryReport(const QStringList &files)
+{
+    TTFMap TTFs;
+    File2FontsMap File2Fonts;
+    FontReader::readFiles(files, TTFs, File2Fonts);
+
+    const Catalogue::Memory m = Catalogue(TTFs).memory();
+    const qint64 maps = Catalogue::mapMemory(TTFs, File2Fonts);
+
+    QJsonObject o;
+    o[QStringLiteral("mapsBytes")] = maps;
+    o[QStringLiteral("catalogueBytes")] = m.total();
+    o[QStringLiteral("catalogueStrings")] = m.strings;
+    o[QStringLiteral("catalogueColumns")] = m.columns;
+    o[QStringLiteral("catalogueRelations")] = m.relations;
+    o[QStringLiteral("catalogueCoverage")] = m.coverage;
+    if(m.total() > 0) {
+        o[QStringLiteral("ratio")] = maps / static_cast<double>(m.total());
+    }
+    return o;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // DB answers everything from parsed data, no gui application needed
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmarks fontadb stages, writes JSON results."));
+    parser.addHelpOption();
+    QCommandLineOption sizesOption(QStringLiteral("sizes"), QStringLiteral("Comma separated synthetic corpus sizes in faces."), QStringLiteral("list"), QStringLiteral("1000,10000,50000"));
+    QCommandLineOption repeatOption(QStringLiteral("repeat"), QStringLiteral("Runs per stage."), QStringLiteral("count"), QStringLiteral("5"));
+    QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Corpus seed."), QStringLiteral("seed"), QStringLiteral("1"));
+    QCommandLineOption labelOption(QStringLiteral("label"), QStringLiteral("Free form run label, e.g. version."), QStringLiteral("label"));
+    QCommandLineOption outputOption({QStringLiteral("o"), QStringLiteral("output")}, QStringLiteral("Output file, stdout by default."), QStringLiteral("file"));
+    parser.addOptions({sizesOption, repeatOption, seedOption, labelOption, outputOption});
+    parser.addPositionalArgument(QStringLiteral("dirs"), QStringLiteral("Real font dirs to benchmark too."), QStringLiteral("[dirs...]"));
+    parser.process(a);
+
+    const int repeat = qMax(1, parser.value(repeatOption).toInt());
+    QTextStream err(stderr);
+
+    QTemporaryDir tmp;
+    if(!tmp.isValid()) {
+        qCritical("Couldn't create temporary dir");
+        return 1;
+    }
+
+    QJsonArray corpora;
+
+    const QStringList sizes = parser.value(sizesOption).split(',', QString::SkipEmptyParts);
+    for(CStringRef size : sizes) {
+        SynthOptions options;
+        options.seed = parser.value(seedOption).toULongLong();
+        options.faces = size.toInt();
+        options.dirs = 16;
+
+        const QString dir = tmp.path() + QStringLiteral("/synth_") + size;
+        err << "corpus " << size << " faces..." << endl;
+        const QVector<SynthFile> synth = FontSynth(options).generate(dir);
+
+        QStringList files;
+        files.reserve(synth.size());
+        for(const SynthFile &file : synth) {
+            files << file.path;
+        }
+
+        QJsonObject corpus;
+        corpus[QStringLiteral("name")] = QStringLiteral("synth");
+        corpus[QStringLiteral("faces")] = options.faces;
+        corpus[QStringLiteral("files")] = files.size();
+        corpus[QStringLiteral("bytes")] = totalSize(files);
+        corpus[QStringLiteral("stages")] = corpusStages(files, repeat, dir);
+        corpus[QStringLiteral("memory")] = memoryReport(files);
+        corpora.append(corpus);
+    }
+
+    for(CStringRef dir : parser.positionalArguments()) {
+        const QStringList files = FontReader::fontFiles({dir});
+        err << "dir " << dir << ", " << files.size() << " files..." << endl;
+
+        QJsonObject corpus;
+        corpus[QStringLiteral("name")] = dir;
+        corpus[QStringLiteral("files")] = files.size();
+        corpus[QStringLiteral("bytes")] = totalSize(files);
+        corpus[QStringLiteral("stages")] = parseStages(files, repeat);
+        corpus[QStringLiteral("memory")] = memoryReport(files);
+        corpora.append(corpus);
+    }
+
+    QJsonObject env;
+    env[QStringLiteral("qt")] = QString::fromLatin1(qVersion());
+    env[QStringLiteral("os")] = QSysInfo::prettyProductName();
+    env[QStringLiteral("cpu")] = QSysInfo::currentCpuArchitecture();
+    env[QStringLiteral("threads")] = static_cast<int>(std::thread::hardware_concurrency());
+
+    QJsonObject root;
+    root[QStringLiteral("label")] = parser.value(labelOption);
+    root[QStringLiteral("date")] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root[QStringLiteral("repeat")] = repeat;
+    root[QStringLiteral("seed")] = parser.value(seedOption);
+    root[QStringLiteral("env")] = env;
+    root[QStringLiteral("corpora")] = corpora;
+
+    QFile output;
+    if(parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Couldn't open %s", qPrintable(output.fileName()));
+            return 1;
+        }
+    } else {
+        output.open(stdout, QIODevice::WriteOnly);
+    }
+    output.write(QJsonDocument(root).toJson());
+
+    return 0;
+}
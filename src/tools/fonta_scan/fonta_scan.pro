@@ -0,0 +1,23 @@
+QT += core gui widgets
+
+include( ../../../common.pri )
+
+TARGET = fonta_scan
+DESTDIR = $${BIN_PATH}/
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp
+
+RESOURCES += \
+    ../../fonta/resources/known_fonts.qrc
+
+build_all:!build_pass {
+    CONFIG -= build_all
+    CONFIG += release
+}
+
+LIBS += -lfontadb$${LIB_SUFFIX}
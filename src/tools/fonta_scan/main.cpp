@@ -0,0 +1,313 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+
+#include "fontreader.h"
+#include "classifier.h"
+#include "trace.h"
+
+/*
+ * Headless catalogue of font dirs:
+ *
+ *   fonta_scan [--format jsonl|csv] [--output file] [--threads N] [--no-classify] [--renders text] [--report file] [--trace file] [dirs...]
+ *
+ * Without dirs system font locations are scanned. One record per family is written
+ * (name records of every language go to jsonl only),
+ * only families whose cmaps map every character of text with --renders,
+ * scan timing goes to stderr, per-file durations and failures go to --report JSON.
+ */
+
+using namespace fonta;
+
+static QStringList sorted(const QSet<QString> &set)
+{
+    QStringList list = set.toList();
+    list.sort();
+    return list;
+}
+
+static QStringList typeNames(int info)
+{
+    QStringList names;
+    for(cauto type : FontType::enumerate()) {
+        if(info & type) {
+            names << FontType::fileName(type).section('.', 0, 0);
+        }
+    }
+    return names;
+}
+
+static QStringList scriptNames(const FontTraits &traits)
+{
+    QStringList names;
+    for(int script = 0; script<Script::count; ++script) {
+        if(traits.supports(static_cast<Script::type>(script))) {
+            names << Script::toString(static_cast<Script::type>(script));
+        }
+    }
+    return names;
+}
+
+static QJsonArray nameRecords(const QVector<FontName> &names)
+{
+    QJsonArray array;
+    for(const FontName &n : names) {
+        QJsonObject o;
+        o[QStringLiteral("id")] = n.id;
+        o[QStringLiteral("platform")] = n.platform;
+        o[QStringLiteral("language")] = n.language;
+        o[QStringLiteral("name")] = n.name;
+        array << o;
+    }
+    return array;
+}
+
+static QJsonArray faceRecords(const QVector<FontFace> &faces)
+{
+    QJsonArray array;
+    for(const FontFace &f : faces) {
+        QJsonObject o;
+        o[QStringLiteral("style")] = f.style;
+        o[QStringLiteral("weight")] = f.weight;
+        o[QStringLiteral("width")] = f.width;
+        o[QStringLiteral("selection")] = f.selection;
+        o[QStringLiteral("italicAngle")] = f.slant();
+        if(f.isVirtual()) {
+            o[QStringLiteral("instance")] = f.instance;
+        }
+        array << o;
+    }
+    return array;
+}
+
+static QJsonArray axisRecords(const QVector<FontAxis> &axes)
+{
+    QJsonArray array;
+    for(const FontAxis &a : axes) {
+        QJsonObject o;
+        o[QStringLiteral("tag")] = FontAxis::tagToString(a.tag);
+        o[QStringLiteral("name")] = a.name;
+        o[QStringLiteral("min")] = a.minimum();
+        o[QStringLiteral("default")] = a.defaultValue();
+        o[QStringLiteral("max")] = a.maximum();
+        array << o;
+    }
+    return array;
+}
+
+// "wght 100..900;wdth 75..100"
+static QString axisRanges(const QVector<FontAxis> &axes)
+{
+    QStringList ranges;
+    for(const FontAxis &a : axes) {
+        ranges << QStringLiteral("%1 %2..%3").arg(FontAxis::tagToString(a.tag)).arg(a.minimum()).arg(a.maximum());
+    }
+    return ranges.join(';');
+}
+
+// weight range of faces, "400" or "300-700"
+static QString weights(const QVector<FontFace> &faces)
+{
+    if(faces.isEmpty()) {
+        return QString();
+    }
+
+    int min = 1000;
+    int max = 0;
+    for(const FontFace &f : faces) {
+        min = qMin<int>(min, f.weight);
+        max = qMax<int>(max, f.weight);
+    }
+    return min == max ? QString::number(min) : QStringLiteral("%1-%2").arg(min).arg(max);
+}
+
+static QString csvField(CStringRef s)
+{
+    if(!s.contains(',') && !s.contains('"') && !s.contains('\n')) {
+        return s;
+    }
+
+    QString quoted = s;
+    quoted.replace('"', QStringLiteral("\"\""));
+    return '"' + quoted + '"';
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Scans font dirs and prints classified catalogue."));
+    parser.addHelpOption();
+    QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("jsonl or csv."), QStringLiteral("format"), QStringLiteral("jsonl"));
+    QCommandLineOption outputOption({QStringLiteral("o"), QStringLiteral("output")}, QStringLiteral("Output file, stdout by default."), QStringLiteral("file"));
+    QCommandLineOption threadsOption({QStringLiteral("j"), QStringLiteral("threads")}, QStringLiteral("Reader threads, one per core by default."), QStringLiteral("count"), QStringLiteral("0"));
+    QCommandLineOption noClassifyOption(QStringLiteral("no-classify"), QStringLiteral("Skip known fonts classification."));
+    QCommandLineOption rendersOption(QStringLiteral("renders"), QStringLiteral("Only families able to render text."), QStringLiteral("text"));
+    QCommandLineOption reportOption(QStringLiteral("report"), QStringLiteral("Write per-file scan report JSON to file."), QStringLiteral("file"));
+    QCommandLineOption traceOption(QStringLiteral("trace"), QStringLiteral("Write Chrome trace to file."), QStringLiteral("file"));
+    parser.addOptions({formatOption, outputOption, threadsOption, noClassifyOption, rendersOption, reportOption, traceOption});
+    parser.addPositionalArgument(QStringLiteral("dirs"), QStringLiteral("Dirs to scan, system font dirs by default."), QStringLiteral("[dirs...]"));
+    parser.process(a);
+    trace::setup(a.arguments());
+
+    const QString format = parser.value(formatOption);
+    if(format != QLatin1String("jsonl") && format != QLatin1String("csv")) {
+        qCritical("Unknown format: %s", qPrintable(format));
+        return 1;
+    }
+
+    QStringList dirs = parser.positionalArguments();
+    if(dirs.isEmpty()) {
+        dirs = QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
+    }
+
+    QFile output;
+    if(parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        if(!output.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical("Couldn't open %s", qPrintable(output.fileName()));
+            return 1;
+        }
+    } else {
+        output.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+
+    QTextStream out(&output);
+    out.setCodec("UTF-8");
+    QTextStream err(stderr);
+
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer timer;
+
+    // enumerate
+    timer.start();
+    qint64 bytes = 0;
+    const QStringList files = FontReader::fontFiles(dirs, &bytes);
+    const qint64 enumerateMs = timer.elapsed();
+
+    // parse
+    TTFMap TTFs;
+    File2FontsMap File2Fonts;
+    ScanReport report;
+    timer.start();
+    FontReader::readFiles(files, TTFs, File2Fonts, parser.value(threadsOption).toInt(), nullptr, &report);
+    const qint64 parseNs = timer.nsecsElapsed();
+    report.setWallTime(parseNs);
+
+    // link
+    timer.start();
+    const Catalogue catalogue(TTFs);
+    const qint64 linkMs = timer.elapsed();
+
+    // classify
+    QStringList families;
+    families.reserve(static_cast<int>(TTFs.size()));
+    if(parser.isSet(rendersOption)) {
+        for(Catalogue::Id font : catalogue.fontsCovering(Coverage::codePoints(parser.value(rendersOption)))) {
+            families << catalogue.family(font);
+        }
+    } else {
+        for(cauto pair : TTFs) {
+            families << pair.first;
+        }
+    }
+    families.sort();
+
+    QHash<QString, int> infos;
+    qint64 classifyMs = 0;
+    if(!parser.isSet(noClassifyOption)) {
+        timer.start();
+        Classifier classifier;
+        if(!classifier.load(QStringLiteral(":/known_fonts"))) {
+            err << "Couldn't load known fonts, classification skipped" << endl;
+        } else {
+            for(CStringRef family : std::as_const(families)) {
+                infos[family] = classifier.fontInfo(family);
+            }
+        }
+        classifyMs = timer.elapsed();
+    }
+
+    // write
+    if(format == QLatin1String("csv")) {
+        out << "family,files,linked,familyClass,familySubClass,panose,latin,cyrillic,scripts,codePoints,faces,weights,axes,types\n";
+    }
+
+    for(CStringRef family : std::as_const(families)) {
+        const TTF &ttf = TTFs.at(family);
+        const int info = infos.value(family);
+        const QStringList linked = catalogue.linkedFonts(catalogue.font(family));
+
+        if(format == QLatin1String("jsonl")) {
+            QJsonObject o;
+            o[QStringLiteral("family")] = family;
+            o[QStringLiteral("files")] = QJsonArray::fromStringList(sorted(ttf.files));
+            o[QStringLiteral("linked")] = QJsonArray::fromStringList(linked);
+            o[QStringLiteral("familyClass")] = static_cast<int>(ttf.familyClass);
+            o[QStringLiteral("familySubClass")] = ttf.familySubClass;
+            o[QStringLiteral("panose")] = ttf.panose.getNumberAsString();
+            o[QStringLiteral("latin")] = ttf.latin;
+            o[QStringLiteral("cyrillic")] = ttf.cyrillic;
+            o[QStringLiteral("names")] = nameRecords(ttf.names);
+            o[QStringLiteral("scripts")] = QJsonArray::fromStringList(scriptNames(ttf));
+            o[QStringLiteral("codePoints")] = ttf.coverage.count();
+            o[QStringLiteral("faces")] = faceRecords(ttf.faces);
+            o[QStringLiteral("axes")] = axisRecords(ttf.axes);
+            o[QStringLiteral("types")] = QJsonArray::fromStringList(typeNames(info));
+            out << QJsonDocument(o).toJson(QJsonDocument::Compact) << '\n';
+        } else {
+            out << csvField(family) << ','
+                << csvField(sorted(ttf.files).join(';')) << ','
+                << csvField(linked.join(';')) << ','
+                << static_cast<int>(ttf.familyClass) << ','
+                << ttf.familySubClass << ','
+                << ttf.panose.getNumberAsString() << ','
+                << ttf.latin << ','
+                << ttf.cyrillic << ','
+                << csvField(scriptNames(ttf).join(';')) << ','
+                << ttf.coverage.count() << ','
+                << ttf.faces.size() << ','
+                << weights(ttf.faces) << ','
+                << csvField(axisRanges(ttf.axes)) << ','
+                << typeNames(info).join(';') << '\n';
+        }
+    }
+    out.flush();
+
+    const double parseSec = parseNs / 1e9;
+    err << "files:     " << files.size() << " (" << bytes / (1024*1024) << " MB)" << endl;
+    err << "fonts:     " << TTFs.size() << endl;
+    err << "enumerate: " << enumerateMs << " ms" << endl;
+    err << "parse:     " << parseNs / 1000000 << " ms";
+    if(parseSec > 0) {
+        err << " (" << qRound(files.size() / parseSec) << " files/s, "
+            << QString::number(bytes / (1024.0*1024.0) / parseSec, 'f', 1) << " MB/s)";
+    }
+    err << endl;
+    err << "link:      " << linkMs << " ms" << endl;
+    err << "classify:  " << classifyMs << " ms" << endl;
+    err << "total:     " << total.elapsed() << " ms" << endl;
+
+    int failed = 0;
+    cauto failures = report.failures();
+    for(cauto list : failures) {
+        failed += list.size();
+    }
+    err << "failed:    " << failed << endl;
+
+    if(parser.isSet(reportOption) && !report.save(parser.value(reportOption))) {
+        qCritical("Couldn't write %s", qPrintable(parser.value(reportOption)));
+        return 1;
+    }
+
+    return 0;
+}
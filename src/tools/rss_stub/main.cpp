@@ -0,0 +1,157 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <memory>
+
+/*
+ * Loopback stand-in for news feeds used by Fonta's RssTextProvider:
+ *
+ *   rss_stub --port 8088 --chunk 256 --delay 50
+ *   FONTA_RSS_ENG=http://127.0.0.1:8088/eng.xml FONTA_RSS_RUS=http://127.0.0.1:8088/rus.xml fonta
+ *
+ * Feeds carry ETag and Last-Modified, conditional requests are answered with 304.
+ * Bodies are sent in small delayed chunks to exercise incremental parsing.
+ */
+
+using CStringRef = const QString&;
+
+static QTextStream out(stdout);
+
+static QByteArray feed(CStringRef tag, CStringRef prefix, int count)
+{
+    QByteArray xml;
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<rss version=\"2.0\"><channel><title>rss_stub</title>\n";
+
+    for(int i = 0; i<count; ++i) {
+        const QString text = prefix.arg(i+1);
+        xml += "<item><guid>" + QByteArray::number(i) + "</guid>";
+        xml += "<" + tag.toUtf8() + "><![CDATA[" + text.toUtf8() + "]]></" + tag.toUtf8() + ">";
+        xml += "</item>\n";
+    }
+
+    xml += "</channel></rss>\n";
+    return xml;
+}
+
+struct Document {
+    QByteArray body;
+    QByteArray etag;
+};
+
+static QHash<QByteArray, Document> documents;
+static const QByteArray lastModified("Mon, 02 Jan 2017 10:00:00 GMT");
+
+static void send(QTcpSocket *socket, QByteArray data, int chunk, int delay)
+{
+    if(chunk <= 0 || data.size() <= chunk) {
+        socket->write(data);
+        socket->disconnectFromHost();
+        return;
+    }
+
+    socket->write(data.left(chunk));
+    data.remove(0, chunk);
+
+    QTimer::singleShot(delay, socket, [socket, data, chunk, delay]{
+        send(socket, data, chunk, delay);
+    });
+}
+
+static void respond(QTcpSocket *socket, const QByteArray &request, int chunk, int delay)
+{
+    const QList<QByteArray> lines = request.split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    const QByteArray path = requestLine.value(1);
+
+    QHash<QByteArray, QByteArray> headers;
+    for(int i = 1; i<lines.size(); ++i) {
+        const int colon = lines[i].indexOf(':');
+        if(colon > 0) {
+            headers[lines[i].left(colon).trimmed().toLower()] = lines[i].mid(colon+1).trimmed();
+        }
+    }
+
+    QByteArray status;
+    QByteArray body;
+
+    auto it = documents.constFind(path);
+    if(requestLine.value(0) != "GET" || it == documents.constEnd()) {
+        status = "404 Not Found";
+    } else if(headers.value("if-none-match") == it->etag
+              || (!headers.contains("if-none-match") && headers.value("if-modified-since") == lastModified)) {
+        status = "304 Not Modified";
+    } else {
+        status = "200 OK";
+        body = it->body;
+    }
+
+    out << requestLine.value(0) << ' ' << path << " -> " << status << endl;
+
+    QByteArray reply = "HTTP/1.1 " + status + "\r\n";
+    if(it != documents.constEnd()) {
+        reply += "ETag: " + it->etag + "\r\n";
+        reply += "Last-Modified: " + lastModified + "\r\n";
+    }
+    reply += "Content-Type: application/rss+xml; charset=utf-8\r\n";
+    reply += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    reply += "Connection: close\r\n\r\n";
+    reply += body;
+
+    send(socket, reply, chunk, delay);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Serves fake news feeds on loopback."));
+    parser.addHelpOption();
+    QCommandLineOption portOption(QStringLiteral("port"), QStringLiteral("Port to listen on."), QStringLiteral("port"), QStringLiteral("8088"));
+    QCommandLineOption chunkOption(QStringLiteral("chunk"), QStringLiteral("Bytes per write, 0 to send at once."), QStringLiteral("bytes"), QStringLiteral("256"));
+    QCommandLineOption delayOption(QStringLiteral("delay"), QStringLiteral("Milliseconds between writes."), QStringLiteral("ms"), QStringLiteral("50"));
+    QCommandLineOption itemsOption(QStringLiteral("items"), QStringLiteral("Items per feed."), QStringLiteral("count"), QStringLiteral("30"));
+    parser.addOptions({portOption, chunkOption, delayOption, itemsOption});
+    parser.process(a);
+
+    const int chunk = parser.value(chunkOption).toInt();
+    const int delay = parser.value(delayOption).toInt();
+    const int items = parser.value(itemsOption).toInt();
+
+    documents["/eng.xml"].body = feed(QStringLiteral("description"), QStringLiteral("Stub news number %1 was delivered from the local loopback server."), items);
+    documents["/rus.xml"].body = feed(QStringLiteral("title"), QStringLiteral("Новость номер %1 доставлена с локального тестового сервера."), items);
+    for(Document &d : documents) {
+        d.etag = '"' + QCryptographicHash::hash(d.body, QCryptographicHash::Md5).toHex() + '"';
+    }
+
+    QTcpServer server;
+    if(!server.listen(QHostAddress::LocalHost, parser.value(portOption).toUShort())) {
+        out << "Couldn't listen: " << server.errorString() << endl;
+        return 1;
+    }
+
+    QObject::connect(&server, &QTcpServer::newConnection, [&server, chunk, delay]{
+        while(QTcpSocket *socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            std::shared_ptr<QByteArray> request = std::make_shared<QByteArray>();
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, request, chunk, delay]{
+                *request += socket->readAll();
+                if(request->contains("\r\n\r\n")) {
+                    respond(socket, *request, chunk, delay);
+                    request->clear();
+                }
+            });
+        }
+    });
+
+    const QString base = QStringLiteral("http://127.0.0.1:%1").arg(server.serverPort());
+    out << "FONTA_RSS_ENG=" << base << "/eng.xml" << endl;
+    out << "FONTA_RSS_RUS=" << base << "/rus.xml" << endl;
+
+    return a.exec();
+}
@@ -0,0 +1,19 @@
+QT += core network
+QT -= gui
+
+include( ../../../common.pri )
+
+TARGET = rss_stub
+DESTDIR = $${BIN_PATH}/
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp
+
+build_all:!build_pass {
+    CONFIG -= build_all
+    CONFIG += release
+}
@@ -4,4 +4,8 @@ SUBDIRS += \
     fonts_cleaner \
     fonta_classifier \
     cogwheel_gen \
-    installer
+    installer \
+    rss_stub \
+    fonta_scan \
+    font_synth \
+    fonta_bench